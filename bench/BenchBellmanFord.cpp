@@ -0,0 +1,201 @@
+// BenchBellmanFord.cpp
+//
+// Compares the dense Bellman-Ford in SampleBellmanFord against the former
+// hash-map implementation on negative graphs shaped like the ones main.cpp
+// builds: a garage, pickups and dropoffs, with profit arcs from pickups to
+// dropoffs, plus the pooled variant and SPFA.
+// Usage: bench_bellman_ford [--threads=N] [vertexCount...]
+#include "graph/SampleNegativeGraph.h"
+#include "algorithm/SampleBellmanFord.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <random>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include <cstdlib>
+
+// The previous implementation: dist and parent keyed by vertex pointer.
+// It gets the same early exit as the dense version so the comparison only
+// measures the storage layout.
+static std::vector<SampleVertex*> hashMapBellmanFord(SampleNegativeGraph* graph) {
+    std::vector<SampleVertex*> vertices;
+    for (const auto& pair : graph->getAllVertices()) {
+        vertices.push_back(pair.second);
+    }
+    int n = vertices.size();
+    SampleVertex* source = vertices[0];
+
+    std::unordered_map<SampleVertex*, double> dist;
+    std::unordered_map<SampleVertex*, SampleVertex*> parent;
+    for (SampleVertex* v : vertices) {
+        dist[v] = std::numeric_limits<double>::max();
+        parent[v] = nullptr;
+    }
+    dist[source] = 0.0;
+
+    for (int i = 0; i < n - 1; i++) {
+        bool changed = false;
+        for (SampleVertex* u : vertices) {
+            for (SampleEdge* edge : graph->getOutgoing(u->getId())) {
+                SampleVertex* v = edge->getVertexT();
+                double weight = edge->getWeight();
+                if (dist[u] != std::numeric_limits<double>::max() && dist[u] + weight < dist[v]) {
+                    dist[v] = dist[u] + weight;
+                    parent[v] = u;
+                    changed = true;
+                }
+            }
+        }
+        if (!changed) break;
+    }
+
+    for (SampleVertex* u : vertices) {
+        for (SampleEdge* edge : graph->getOutgoing(u->getId())) {
+            SampleVertex* v = edge->getVertexT();
+            if (dist[u] != std::numeric_limits<double>::max() && dist[u] + edge->getWeight() < dist[v]) {
+                parent[v] = u;
+                // Walk back n steps to land on the cycle, then collect it
+                SampleVertex* current = v;
+                for (int j = 0; j < n && current != nullptr; j++) {
+                    current = parent[current];
+                }
+                std::vector<SampleVertex*> cycle;
+                SampleVertex* at = current;
+                do {
+                    cycle.push_back(at);
+                    at = parent[at];
+                } while (at != current && at != nullptr);
+                std::reverse(cycle.begin(), cycle.end());
+                return cycle;
+            }
+        }
+    }
+    return std::vector<SampleVertex*>();
+}
+
+// Garage, pickups and dropoffs. Arc weights are reduced costs
+// base + potential[u] - potential[v], so many arcs are negative but no cycle
+// is; plantCycle closes one negative pickup-dropoff-pickup cycle. The
+// vertices go into places, which must outlive the returned overlay.
+static void addPlace(SamplePositiveGraph* places, const std::string& name, SampleVertexType type) {
+    places->createVertex(name)->setVertexType(type);
+}
+
+static SampleNegativeGraph* buildGraph(SamplePositiveGraph* places, uint32_t vertexCount, bool plantCycle, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> base(1.0, 20.0);
+    std::uniform_real_distribution<double> potential(0.0, 60.0);
+
+    SampleNegativeGraph* graph = new SampleNegativeGraph(places);
+    uint32_t pairs = (vertexCount - 1) / 2;
+    std::vector<std::string> names;
+    std::vector<double> pot;
+    names.push_back("G");
+    pot.push_back(0.0);
+    addPlace(places, "G", SampleVertexType::Garage);
+    for (uint32_t i = 0; i < pairs; i++) {
+        names.push_back("P" + std::to_string(i));
+        pot.push_back(potential(rng));
+        addPlace(places, names.back(), SampleVertexType::Pickup);
+    }
+    for (uint32_t i = 0; i < pairs; i++) {
+        names.push_back("D" + std::to_string(i));
+        pot.push_back(potential(rng));
+        addPlace(places, names.back(), SampleVertexType::Dropoff);
+    }
+
+    auto addArc = [&](uint32_t u, uint32_t v) {
+        graph->addEdge(names[u], names[v], base(rng) + pot[u] - pot[v]);
+    };
+    std::uniform_int_distribution<uint32_t> pickDropoff(1 + pairs, 2 * pairs);
+    std::uniform_int_distribution<uint32_t> pickPickup(1, pairs);
+    for (uint32_t i = 1; i <= pairs; i++) {
+        addArc(0, i);                 // garage -> pickup
+        addArc(i, i + pairs);         // pickup -> its own dropoff
+        addArc(i + pairs, 0);         // dropoff -> garage
+        for (int k = 0; k < 3; k++) {
+            addArc(i, pickDropoff(rng));      // pickup -> other dropoffs
+            addArc(i + pairs, pickPickup(rng)); // dropoff -> next pickup
+        }
+    }
+    if (plantCycle) {
+        uint32_t p = 1 + pairs / 2;
+        graph->addEdge(names[p], names[p + pairs], -5.0);
+        graph->addEdge(names[p + pairs], names[p], 1.0);
+    }
+    return graph;
+}
+
+static const uint32_t MAX_CYCLE_VERTICES = 20001;
+
+template <typename Fn>
+static double medianMillis(int repetitions, Fn fn, size_t& cycleLength) {
+    std::vector<double> samples;
+    for (int i = 0; i < repetitions; i++) {
+        auto start = std::chrono::steady_clock::now();
+        cycleLength = fn().size();
+        auto end = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<uint32_t> sizes;
+    unsigned threads = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 10, "--threads=") == 0) {
+            threads = static_cast<unsigned>(std::strtoul(arg.c_str() + 10, nullptr, 10));
+        } else {
+            sizes.push_back(static_cast<uint32_t>(std::strtoul(argv[i], nullptr, 10)));
+        }
+    }
+    if (sizes.empty()) {
+        sizes = {10001, 50001, 200001};
+    }
+
+    SampleThreadPool pool(threads);
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "parallel runs use " << pool.getThreadCount() << " threads" << std::endl;
+    std::cout << "vertices   arcs      cycle  hash-map ms  dense ms  speedup  parallel ms  spfa ms" << std::endl;
+    for (uint32_t size : sizes) {
+        for (int planted = 0; planted < 2; planted++) {
+            // With a cycle the classic passes never converge and all n-1 of
+            // them run, which takes minutes for the hash-map version
+            if (planted && size > MAX_CYCLE_VERTICES) continue;
+            SamplePositiveGraph places;
+            SampleNegativeGraph* graph = buildGraph(&places, size, planted != 0, 42);
+            const SampleCSRGraph* csr = graph->freeze();
+            SampleBellmanFord bellmanFord(graph);
+            size_t hashCycle = 0, denseCycle = 0, parallelCycle = 0, spfaCycle = 0;
+            int repetitions = planted ? 1 : 3;
+
+            double hashMs = medianMillis(repetitions, [&]() { return hashMapBellmanFord(graph); }, hashCycle);
+            double denseMs = medianMillis(repetitions, [&]() { return bellmanFord.findNegativeCycle(); }, denseCycle);
+            double parallelMs = medianMillis(repetitions, [&]() { return bellmanFord.findNegativeCycle(&pool); }, parallelCycle);
+            double spfaMs = medianMillis(repetitions, [&]() { return bellmanFord.findNegativeCycleSPFA(); }, spfaCycle);
+            if ((hashCycle == 0) != (denseCycle == 0) || (denseCycle == 0) != (parallelCycle == 0) ||
+                (denseCycle == 0) != (spfaCycle == 0)) {
+                std::cerr << "Mismatch: implementations disagree on a negative cycle" << std::endl;
+                return 1;
+            }
+
+            std::cout << std::setw(9) << csr->getVertexCount() << "  "
+                      << std::setw(8) << csr->getArcCount() << "  "
+                      << std::setw(5) << (denseCycle ? "yes" : "no") << "  "
+                      << std::setw(11) << hashMs << "  "
+                      << std::setw(8) << denseMs << "  "
+                      << std::setw(6) << hashMs / denseMs << "x  "
+                      << std::setw(11) << parallelMs << "  "
+                      << std::setw(7) << spfaMs << std::endl;
+            delete graph;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,175 @@
+// BenchMultiSource.cpp
+//
+// Compares the lane kernels of SampleMultiSourceDijkstra against one scalar
+// Dijkstra per source on pickup x dropoff tables like the one
+// createNegativeGraph builds, over road-like grid graphs, for a few layouts
+// of the pickups and dropoffs (the kernels pay off when the pickups are close
+// together compared to the distances to the dropoffs). Every kernel's table
+// is checked against the scalar one.
+// Usage: bench_multi_source [--threads=N] [--sources=N] [vertexCount...]
+#include "graph/SamplePositiveGraph.h"
+#include "algorithm/SampleDijkstra.h"
+#include "algorithm/SampleQueryContext.h"
+#include "algorithm/SampleMultiSourceDijkstra.h"
+#include "algorithm/SampleDistanceMatrix.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+
+// A side x side street grid with jittered block lengths, a few missing
+// streets and some diagonal shortcuts, so sources close together share
+// most of their search space as on a real map
+static SamplePositiveGraph* buildGrid(uint32_t vertexCount, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> length(1.0, 3.0);
+    std::uniform_int_distribution<int> percent(0, 99);
+    uint32_t side = 1;
+    while ((side + 1) * (side + 1) <= vertexCount) side++;
+
+    SamplePositiveGraph* graph = new SamplePositiveGraph();
+    graph->reserve(side * side, 2 * side * side);
+    for (uint32_t i = 0; i < side * side; i++) {
+        graph->createVertex("V" + std::to_string(i));
+    }
+    for (uint32_t row = 0; row < side; row++) {
+        for (uint32_t col = 0; col < side; col++) {
+            uint32_t id = row * side + col;
+            if (col + 1 < side && percent(rng) >= 5) graph->addEdge(id, id + 1, length(rng));
+            if (row + 1 < side && percent(rng) >= 5) graph->addEdge(id, id + side, length(rng));
+            if (col + 1 < side && row + 1 < side && percent(rng) < 10) graph->addEdge(id, id + side + 1, 1.5 * length(rng));
+        }
+    }
+    return graph;
+}
+
+template <typename Fn>
+static double medianMillis(int repetitions, Fn fn) {
+    std::vector<double> samples;
+    for (int i = 0; i < repetitions; i++) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto end = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+// One pickup x dropoff table with the pickups inside a square of
+// pickupArea x pickupArea vertices in the corner of the map and the
+// dropoffs inside one of dropoffArea; false if a kernel disagrees with the
+// scalar search
+static bool benchDistrict(const SampleCSRGraph* csr, uint32_t side, uint32_t pickupArea, uint32_t dropoffArea,
+                          uint32_t sourceCount,
+                          const std::vector<SampleLaneKernel>& kernels, SampleThreadPool& pool) {
+    uint32_t n = csr->getVertexCount();
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<uint32_t> inPickupArea(0, std::max<uint32_t>(pickupArea, 1) - 1);
+    std::uniform_int_distribution<uint32_t> inDropoffArea(0, std::max<uint32_t>(dropoffArea, 1) - 1);
+    std::vector<uint32_t> pickups, dropoffs;
+    for (uint32_t i = 0; i < sourceCount; i++) {
+        pickups.push_back(inPickupArea(rng) * side + inPickupArea(rng));
+        dropoffs.push_back(inDropoffArea(rng) * side + inDropoffArea(rng));
+    }
+    std::vector<char> isTarget(n, 0);
+    uint32_t targetCount = 0;
+    for (uint32_t target : dropoffs) {
+        if (!isTarget[target]) {
+            isTarget[target] = 1;
+            targetCount++;
+        }
+    }
+
+    // Baseline: one scalar one-to-many Dijkstra per pickup
+    std::vector<double> expected(pickups.size() * dropoffs.size());
+    SampleQueryContext context(n);
+    double scalarMs = medianMillis(3, [&]() {
+        for (size_t row = 0; row < pickups.size(); row++) {
+            SampleDijkstra::runOneToMany(csr, pickups[row], isTarget, targetCount, context);
+            for (size_t column = 0; column < dropoffs.size(); column++) {
+                expected[row * dropoffs.size() + column] = context.getDistance(dropoffs[column]);
+            }
+        }
+    });
+
+    for (SampleLaneKernel kernel : kernels) {
+        SampleDistanceMatrix single(pickups, dropoffs);
+        SampleDistanceMatrix parallel(pickups, dropoffs);
+        single.setKernel(kernel);
+        parallel.setKernel(kernel);
+        double lanesMs = medianMillis(3, [&]() { single.compute(csr); });
+        double parallelMs = medianMillis(3, [&]() { parallel.compute(csr, &pool); });
+        for (size_t row = 0; row < pickups.size(); row++) {
+            for (size_t column = 0; column < dropoffs.size(); column++) {
+                double want = expected[row * dropoffs.size() + column];
+                if (single.getDistance(row, column) != want || parallel.getDistance(row, column) != want) {
+                    std::cerr << "Mismatch: " << SampleMultiSourceDijkstra::getKernelName(kernel)
+                              << " kernel disagrees with the scalar search" << std::endl;
+                    return false;
+                }
+            }
+        }
+
+        std::cout << std::setw(9) << n << "  "
+                  << std::setw(8) << csr->getArcCount() << "  "
+                  << std::setw(7) << pickupArea << "  "
+                  << std::setw(8) << dropoffArea << "  "
+                  << std::setw(6) << SampleMultiSourceDijkstra::getKernelName(kernel) << "  "
+                  << std::setw(5) << SampleMultiSourceDijkstra::getLaneCount(kernel) << "  "
+                  << std::setw(13) << scalarMs << "  "
+                  << std::setw(8) << lanesMs << "  "
+                  << std::setw(6) << scalarMs / lanesMs << "x  "
+                  << std::setw(11) << parallelMs << std::endl;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<uint32_t> sizes;
+    unsigned threads = 0;
+    uint32_t sourceCount = 64;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 10, "--threads=") == 0) {
+            threads = static_cast<unsigned>(std::strtoul(arg.c_str() + 10, nullptr, 10));
+        } else if (arg.compare(0, 10, "--sources=") == 0) {
+            sourceCount = static_cast<uint32_t>(std::strtoul(arg.c_str() + 10, nullptr, 10));
+        } else {
+            sizes.push_back(static_cast<uint32_t>(std::strtoul(argv[i], nullptr, 10)));
+        }
+    }
+    if (sizes.empty()) {
+        sizes = {10000, 100000};
+    }
+
+    std::vector<SampleLaneKernel> kernels;
+    for (SampleLaneKernel kernel : {SampleLaneKernel::Scalar, SampleLaneKernel::Avx2, SampleLaneKernel::Avx512}) {
+        if (SampleMultiSourceDijkstra::isSupported(kernel)) kernels.push_back(kernel);
+    }
+
+    SampleThreadPool pool(threads);
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << sourceCount << " pickups x " << sourceCount << " dropoffs; parallel runs use "
+              << pool.getThreadCount() << " threads" << std::endl;
+    std::cout << "vertices   arcs      pickups  dropoffs  kernel  lanes  per-source ms  lanes ms  speedup  parallel ms" << std::endl;
+    for (uint32_t size : sizes) {
+        SamplePositiveGraph* graph = buildGrid(size, 42);
+        const SampleCSRGraph* csr = graph->freeze();
+        uint32_t side = static_cast<uint32_t>(std::sqrt(static_cast<double>(csr->getVertexCount())));
+        // Orders packed in a small district, spread over a wide one, and
+        // picked up in a small district for delivery all over the map
+        if (!benchDistrict(csr, side, side / 32, side / 32, sourceCount, kernels, pool) ||
+            !benchDistrict(csr, side, side / 4, side / 4, sourceCount, kernels, pool) ||
+            !benchDistrict(csr, side, side / 32, side, sourceCount, kernels, pool)) {
+            return 1;
+        }
+        delete graph;
+    }
+    return 0;
+}
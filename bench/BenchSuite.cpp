@@ -0,0 +1,382 @@
+// BenchSuite.cpp
+//
+// Scaling benchmark of the planning pipeline on synthetic maps, from 1k to
+// 1M vertices (those up to --max when given). For every size a map is
+// generated, written as CSV files and then timed stage by stage: CSV load,
+// createNegativeGraph, a full single-source Dijkstra, point-to-point
+// Dijkstra and A* (with the mean vertices each settles per query), the
+// contraction hierarchy build and its queries on maps of up to
+// CH_MAX_VERTICES vertices, Bellman-Ford negative cycle detection, the best
+// profit per distance cycle (the arc distances and Howard's ratio cycle,
+// step 6 of main), the end-to-end pipeline (load, profit graph, cycle,
+// shortest legs of the cycle through the garage), and fleet planning for one
+// truck and for 50 (the distance matrix computed beforehand, so both time
+// partitioning, the parallel route solving and rebalancing; they should come
+// out close). On maps of up to KARP_MAX_VERTICES vertices the minimum mean
+// cycle of the profit graph is also checked against Karp's algorithm, and A*
+// and hierarchy distances are checked against Dijkstra's on every map that
+// has them; a mismatch fails the run. Each stage repeats until it has
+// MIN_SAMPLES samples and TIME_BUDGET_MS of run time (or MAX_SAMPLES
+// samples). The report is JSON on stdout, progress on stderr.
+// Usage: bench_suite [--layout=grid|geometric] [--seed=N] [--orders=N]
+//                    [--threads=N] [--dir=DIR] [--max=N] [vertexCount...]
+#include "graph/SampleGraphGenerator.h"
+#include "graph/SampleCSVLoader.h"
+#include "graph/SampleNegativeGraph.h"
+#include "algorithm/SampleDijkstra.h"
+#include "algorithm/SampleAStar.h"
+#include "algorithm/SampleContractionHierarchy.h"
+#include "algorithm/SampleQueryContext.h"
+#include "algorithm/SampleBellmanFord.h"
+#include "algorithm/SampleCycleRatio.h"
+#include "algorithm/SampleDeliveryPlanner.h"
+#include "algorithm/SampleFleetPlanner.h"
+#include "util/SampleThreadPool.h"
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+static const size_t MIN_SAMPLES = 5;
+static const size_t MAX_SAMPLES = 1000;
+static const double TIME_BUDGET_MS = 1000.0;
+static const uint32_t KARP_MAX_VERTICES = 2000; // Karp keeps an (n + 1) x n table
+static const uint32_t CH_MAX_VERTICES = 20000;  // preprocessing grows faster than the map
+
+struct Stage {
+    std::string name;
+    uint32_t vertices;
+    uint32_t arcs;
+    std::vector<double> samples; // ms, sorted
+    double settled; // mean vertices settled per search, 0 if not counted
+
+    Stage(const std::string& name, uint32_t vertices, uint32_t arcs, const std::vector<double>& samples,
+          double settled = 0.0)
+        : name(name), vertices(vertices), arcs(arcs), samples(samples), settled(settled) {}
+};
+
+// Runs fn until the sampling rule is met; setup runs before every sample
+// and is not timed
+static std::vector<double> sample(const std::function<void()>& setup, const std::function<void()>& fn) {
+    std::vector<double> samples;
+    double total = 0.0;
+    while (samples.size() < MAX_SAMPLES && (samples.size() < MIN_SAMPLES || total < TIME_BUDGET_MS)) {
+        setup();
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto end = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        total += samples.back();
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples;
+}
+
+// Nearest-rank percentile of sorted samples
+static double percentile(const std::vector<double>& sorted, double p) {
+    size_t rank = static_cast<size_t>(p * sorted.size() + 0.999999);
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+static void printJSON(std::ostream& out, const std::string& layout, unsigned seed, unsigned threads,
+                      const std::vector<Stage>& stages) {
+    out << std::fixed << std::setprecision(4);
+    out << "{\n  \"layout\": \"" << layout << "\",\n  \"seed\": " << seed
+        << ",\n  \"threads\": " << threads << ",\n  \"results\": [";
+    for (size_t i = 0; i < stages.size(); i++) {
+        const Stage& stage = stages[i];
+        double mean = 0.0;
+        for (double ms : stage.samples) mean += ms;
+        mean /= stage.samples.size();
+        out << (i == 0 ? "\n" : ",\n")
+            << "    {\"benchmark\": \"" << stage.name << "\", \"vertices\": " << stage.vertices
+            << ", \"arcs\": " << stage.arcs << ", \"samples\": " << stage.samples.size();
+        if (stage.settled > 0) {
+            out << ", \"settled\": " << stage.settled;
+        }
+        out
+            << ", \"median_ms\": " << percentile(stage.samples, 0.5)
+            << ", \"p99_ms\": " << percentile(stage.samples, 0.99)
+            << ", \"mean_ms\": " << mean
+            << ", \"ops_per_second\": " << (mean > 0.0 ? 1000.0 / mean : 0.0) << "}";
+    }
+    out << "\n  ]\n}" << std::endl;
+}
+
+// Sum of the shortest legs garage -> cycle[0] -> ... -> cycle.back() -> garage
+static double cycleDistance(SampleDijkstra& dijkstra, SampleVertex* garage, const std::vector<SampleVertex*>& cycle) {
+    if (cycle.empty()) return 0.0;
+    std::vector<uint32_t> path;
+    double total = dijkstra.findLeg(garage->getId(), cycle[0]->getId(), path);
+    for (size_t i = 0; i + 1 < cycle.size(); i++) {
+        total += dijkstra.findLeg(cycle[i]->getId(), cycle[i + 1]->getId(), path);
+    }
+    return total + dijkstra.findLeg(cycle.back()->getId(), garage->getId(), path);
+}
+
+// Howard's minimum mean cycle against Karp's reference; throws if they differ
+static void checkMinimumMean(const SampleCSRGraph* graph) {
+    SampleCycleRatio cycleRatio(graph);
+    SampleCycleRatio::RatioCycle howard = cycleRatio.findMinimumMeanCycle();
+    SampleCycleRatio::RatioCycle karp = cycleRatio.findMinimumMeanCycleKarp();
+    if (howard.vertices.empty() != karp.vertices.empty() ||
+        std::fabs(howard.ratio - karp.ratio) > 1e-9 * std::max(1.0, std::fabs(karp.ratio))) {
+        std::ostringstream message;
+        message << "minimum mean cycle mismatch: Howard " << howard.ratio << ", Karp " << karp.ratio;
+        throw std::runtime_error(message.str());
+    }
+    std::cerr << "Minimum mean cycle " << howard.ratio << " matches Karp" << std::endl;
+}
+
+static const uint32_t CHECKED_PAIRS = 200;
+
+static uint32_t countSettled(const SampleQueryContext& context) {
+    uint32_t settled = 0;
+    for (uint32_t v : context.getTouched()) {
+        settled += context.isSettled(v);
+    }
+    return settled;
+}
+
+// A* against point-to-point Dijkstra on the same random pairs; throws if a
+// distance differs. Returns the mean settled vertices of each.
+static std::pair<double, double> checkAStar(const SampleCSRGraph* graph, const SampleAStar& aStar,
+                                            std::mt19937& rng, SampleQueryContext& context) {
+    std::uniform_int_distribution<uint32_t> anyVertex(0, graph->getVertexCount() - 1);
+    double dijkstraSettled = 0.0, aStarSettled = 0.0;
+    for (uint32_t i = 0; i < CHECKED_PAIRS; i++) {
+        uint32_t source = anyVertex(rng);
+        uint32_t target = anyVertex(rng);
+        double expected = SampleDijkstra::runPointToPoint(graph, source, target, context);
+        dijkstraSettled += countSettled(context);
+        double distance = aStar.findShortestPath(source, target, context);
+        aStarSettled += countSettled(context);
+        if (distance != expected && std::fabs(distance - expected) > 1e-9 * std::max(1.0, expected)) {
+            std::ostringstream message;
+            message << "A* distance mismatch from " << source << " to " << target << ": "
+                    << distance << ", Dijkstra " << expected;
+            throw std::runtime_error(message.str());
+        }
+    }
+    std::cerr << "A* matches Dijkstra on " << CHECKED_PAIRS << " pairs"
+              << (aStar.isHeuristicEnabled() ? "" : " (heuristic off)") << std::endl;
+    return std::make_pair(dijkstraSettled / CHECKED_PAIRS, aStarSettled / CHECKED_PAIRS);
+}
+
+// Hierarchy queries against point-to-point Dijkstra on random pairs; throws
+// if a distance differs. Returns the mean vertices settled by both sides.
+static double checkHierarchy(const SampleCSRGraph* graph, const SampleContractionHierarchy& hierarchy,
+                             std::mt19937& rng, SampleQueryContext& context, SampleQueryContext& backward) {
+    std::uniform_int_distribution<uint32_t> anyVertex(0, graph->getVertexCount() - 1);
+    double settled = 0.0;
+    for (uint32_t i = 0; i < CHECKED_PAIRS; i++) {
+        uint32_t source = anyVertex(rng);
+        uint32_t target = anyVertex(rng);
+        double expected = SampleDijkstra::runPointToPoint(graph, source, target, context);
+        double distance = hierarchy.findShortestPath(source, target, context, backward);
+        settled += countSettled(context) + countSettled(backward);
+        if (distance != expected && std::fabs(distance - expected) > 1e-9 * std::max(1.0, expected)) {
+            std::ostringstream message;
+            message << "hierarchy distance mismatch from " << source << " to " << target << ": "
+                    << distance << ", Dijkstra " << expected;
+            throw std::runtime_error(message.str());
+        }
+    }
+    std::cerr << "Contraction hierarchy matches Dijkstra on " << CHECKED_PAIRS << " pairs" << std::endl;
+    return settled / CHECKED_PAIRS;
+}
+
+int main(int argc, char* argv[]) {
+    SampleGraphGenerator::Options options;
+    std::vector<uint32_t> sizes;
+    uint32_t orders = 100; // pickups, and as many dropoffs, per map
+    unsigned threads = 0;
+    uint32_t maxSize = 0; // of the default sizes; 0 runs them all
+    const char* tmp = std::getenv("TMPDIR");
+    std::string directory = tmp != nullptr ? tmp : "/tmp";
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 9, "--layout=") == 0 && SampleGraphGenerator::parseLayout(arg.substr(9), options.layout)) {
+        } else if (arg.compare(0, 7, "--seed=") == 0) {
+            options.seed = static_cast<unsigned>(std::strtoul(arg.c_str() + 7, nullptr, 10));
+        } else if (arg.compare(0, 9, "--orders=") == 0) {
+            orders = static_cast<uint32_t>(std::strtoul(arg.c_str() + 9, nullptr, 10));
+        } else if (arg.compare(0, 10, "--threads=") == 0) {
+            threads = static_cast<unsigned>(std::strtoul(arg.c_str() + 10, nullptr, 10));
+        } else if (arg.compare(0, 6, "--dir=") == 0) {
+            directory = arg.substr(6);
+        } else if (arg.compare(0, 6, "--max=") == 0) {
+            maxSize = static_cast<uint32_t>(std::strtoul(arg.c_str() + 6, nullptr, 10));
+        } else if (arg.compare(0, 2, "--") != 0) {
+            sizes.push_back(static_cast<uint32_t>(std::strtoul(argv[i], nullptr, 10)));
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--layout=grid|geometric] [--seed=N] [--orders=N]"
+                      << " [--threads=N] [--dir=DIR] [--max=N] [vertexCount...]" << std::endl;
+            return 1;
+        }
+    }
+    if (sizes.empty()) {
+        for (uint32_t size : {1000u, 10000u, 100000u, 1000000u}) {
+            if (maxSize == 0 || size <= maxSize) sizes.push_back(size);
+        }
+    }
+
+    SampleThreadPool pool(threads);
+    std::vector<Stage> stages;
+    try {
+        for (uint32_t size : sizes) {
+            // The order count stays fixed so the profit graph (pickups x
+            // dropoffs arcs) does not grow with the square of the map
+            options.vertexCount = size;
+            options.pickupShare = std::min(0.05, static_cast<double>(orders) / size);
+            options.dropoffShare = options.pickupShare;
+            std::ostringstream prefix;
+            prefix << directory << "/bench_suite_" << size;
+            std::string verticesFile = prefix.str() + "_vertices.csv";
+            std::string distancesFile = prefix.str() + "_distances.csv";
+
+            std::cerr << "Generating " << size << " vertex map..." << std::endl;
+            SamplePositiveGraph* generated = SampleGraphGenerator::generate(options);
+            SampleGraphGenerator::writeCSV(generated, verticesFile, distancesFile);
+            delete generated;
+
+            std::cerr << "Timing " << size << " vertices..." << std::endl;
+            SamplePositiveGraph* positiveGraph = nullptr;
+            std::vector<SamplePositiveGraph*> loaded;
+            auto dropLoaded = [&]() {
+                for (SamplePositiveGraph* graph : loaded) delete graph;
+                loaded.clear();
+            };
+            std::vector<double> loadSamples = sample(dropLoaded, [&]() {
+                loaded.push_back(SampleCSVLoader::loadPositiveGraph(verticesFile, distancesFile));
+            });
+            positiveGraph = loaded.back();
+            loaded.pop_back();
+            dropLoaded();
+            const SampleCSRGraph* csr = positiveGraph->freeze();
+            uint32_t n = csr->getVertexCount();
+            uint32_t arcs = csr->getArcCount();
+            Stage load = { "csv_load", n, arcs, loadSamples };
+            stages.push_back(load);
+
+            std::vector<SampleNegativeGraph*> built;
+            auto dropBuilt = [&]() {
+                for (SampleNegativeGraph* graph : built) delete graph;
+                built.clear();
+            };
+            Stage negative = { "negative_graph", n, arcs, sample(dropBuilt, [&]() {
+                built.push_back(SampleDeliveryPlanner::createNegativeGraph(positiveGraph, nullptr, &pool));
+            }) };
+            stages.push_back(negative);
+            dropBuilt();
+
+            std::mt19937 rng(options.seed);
+            std::uniform_int_distribution<uint32_t> anyVertex(0, n - 1);
+            SampleQueryContext context(n);
+            uint32_t source = 0, target = 0;
+            auto pickPair = [&]() {
+                source = anyVertex(rng);
+                target = anyVertex(rng);
+            };
+            Stage singleSource = { "dijkstra_single_source", n, arcs, sample(pickPair, [&]() {
+                SampleDijkstra::runDijkstra(csr, source, context);
+            }) };
+            stages.push_back(singleSource);
+            Stage pointToPoint = { "dijkstra_point_to_point", n, arcs, sample(pickPair, [&]() {
+                SampleDijkstra::runPointToPoint(csr, source, target, context);
+            }) };
+            SampleAStar aStar(csr, 0);
+            Stage aStarStage = { "a_star_point_to_point", n, arcs, sample(pickPair, [&]() {
+                aStar.findShortestPath(source, target, context);
+            }) };
+            std::pair<double, double> settled = checkAStar(csr, aStar, rng, context);
+            pointToPoint.settled = settled.first;
+            aStarStage.settled = settled.second;
+            stages.push_back(pointToPoint);
+            stages.push_back(aStarStage);
+
+            if (n <= CH_MAX_VERTICES && csr->isUndirected()) {
+                // Every sample builds afresh; the last hierarchy built is queried
+                std::unique_ptr<SampleContractionHierarchy> hierarchy;
+                Stage build = { "ch_build", n, arcs, sample([&]() { hierarchy.reset(); }, [&]() {
+                    hierarchy.reset(new SampleContractionHierarchy(csr));
+                }) };
+                stages.push_back(build);
+                SampleQueryContext backward(n);
+                Stage query = { "ch_point_to_point", n, arcs, sample(pickPair, [&]() {
+                    hierarchy->findShortestPath(source, target, context, backward);
+                }) };
+                query.settled = checkHierarchy(csr, *hierarchy, rng, context, backward);
+                stages.push_back(query);
+            }
+
+            SampleNegativeGraph* negativeGraph = SampleDeliveryPlanner::createNegativeGraph(positiveGraph, nullptr, &pool);
+            SampleBellmanFord bellmanFord(negativeGraph);
+            Stage cycle = { "negative_cycle", n, arcs, sample([]() {}, [&]() {
+                bellmanFord.findNegativeCycle();
+            }) };
+            stages.push_back(cycle);
+            if (n <= KARP_MAX_VERTICES) {
+                checkMinimumMean(negativeGraph->freeze());
+            }
+            // Step 6 of main: arc distances on the roads, then Howard's ratio cycle
+            Stage ratio = { "ratio_cycle", n, arcs, sample([]() {}, [&]() {
+                SampleCycleRatio cycleRatio(negativeGraph->freeze());
+                cycleRatio.findMinimumRatioCycle(SampleDeliveryPlanner::arcDistances(csr, negativeGraph->freeze(), &pool));
+            }) };
+            stages.push_back(ratio);
+            delete negativeGraph;
+            delete positiveGraph;
+
+            // Load, profit graph, SPFA cycle and the driven legs, as main() does
+            Stage endToEnd = { "end_to_end", n, arcs, sample([]() {}, [&]() {
+                SamplePositiveGraph* graph = SampleCSVLoader::loadPositiveGraph(verticesFile, distancesFile);
+                SampleNegativeGraph* profit = SampleDeliveryPlanner::createNegativeGraph(graph, nullptr, &pool);
+                SampleBellmanFord planner(profit);
+                std::vector<SampleVertex*> route = planner.findNegativeCycleSPFA();
+                SampleVertex* garage = graph->getVertexByName("Garage");
+                if (garage != nullptr) {
+                    SampleDijkstra dijkstra(graph);
+                    cycleDistance(dijkstra, garage, route);
+                }
+                delete profit;
+                delete graph;
+            }) };
+            stages.push_back(endToEnd);
+
+            // Fleet planning over every order; the first plan computes the
+            // distance matrix, which the timed ones reuse
+            SamplePositiveGraph* fleetGraph = SampleCSVLoader::loadPositiveGraph(verticesFile, distancesFile);
+            SampleFleetPlanner fleet(fleetGraph->freeze(), SampleDeliveryPlanner::findGarages(fleetGraph),
+                                     SampleDeliveryPlanner::createOrders(fleetGraph, &pool));
+            SampleFleetPlanner::Options fleetOptions;
+            fleet.plan(fleetOptions, &pool);
+            for (uint32_t trucks : {1u, 50u}) {
+                fleetOptions.truckCount = trucks;
+                Stage fleetStage = { trucks == 1 ? "fleet_1_truck" : "fleet_50_trucks", n, arcs,
+                                     sample([]() {}, [&]() { fleet.plan(fleetOptions, &pool); }) };
+                stages.push_back(fleetStage);
+            }
+            delete fleetGraph;
+
+            std::remove(verticesFile.c_str());
+            std::remove(distancesFile.c_str());
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    printJSON(std::cout, SampleGraphGenerator::layoutName(options.layout), options.seed, pool.getThreadCount(), stages);
+    return 0;
+}
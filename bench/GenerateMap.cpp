@@ -0,0 +1,58 @@
+// GenerateMap.cpp
+//
+// Writes a synthetic map as vertices.csv and distances.csv for the loader.
+// Usage: generate_map [--layout=grid|geometric] [--vertices=N] [--pickups=SHARE]
+//                     [--dropoffs=SHARE] [--garages=SHARE] [--spacing=KM] [--seed=N] [DIR]
+// DIR defaults to data, so the result replaces the files delivery_optimizer reads.
+#include "graph/SampleGraphGenerator.h"
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+int main(int argc, char* argv[]) {
+    SampleGraphGenerator::Options options;
+    std::string directory = "data";
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        size_t equals = arg.find('=');
+        std::string name = arg.substr(0, equals);
+        std::string value = equals != std::string::npos ? arg.substr(equals + 1) : "";
+        if (name == "--layout" && SampleGraphGenerator::parseLayout(value, options.layout)) {
+        } else if (name == "--vertices") {
+            options.vertexCount = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (name == "--pickups") {
+            options.pickupShare = std::atof(value.c_str());
+        } else if (name == "--dropoffs") {
+            options.dropoffShare = std::atof(value.c_str());
+        } else if (name == "--garages") {
+            options.garageShare = std::atof(value.c_str());
+        } else if (name == "--spacing") {
+            options.spacingKm = std::atof(value.c_str());
+        } else if (name == "--seed") {
+            options.seed = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (arg.compare(0, 2, "--") != 0) {
+            directory = arg;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--layout=grid|geometric] [--vertices=N] [--pickups=SHARE]"
+                      << " [--dropoffs=SHARE] [--garages=SHARE] [--spacing=KM] [--seed=N] [DIR]" << std::endl;
+            return 1;
+        }
+    }
+    if (options.vertexCount == 0) {
+        std::cerr << "--vertices must be positive" << std::endl;
+        return 1;
+    }
+
+    try {
+        SamplePositiveGraph* graph = SampleGraphGenerator::generate(options);
+        SampleGraphGenerator::writeCSV(graph, directory + "/vertices.csv", directory + "/distances.csv");
+        std::cout << "Wrote " << SampleGraphGenerator::layoutName(options.layout) << " map with "
+                  << graph->getVertexList().size() << " vertices and " << graph->freeze()->getArcCount() / 2
+                  << " roads to " << directory << std::endl;
+        delete graph;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,58 @@
+// SampleAStar.h
+#ifndef SAMPLE_A_STAR_H
+#define SAMPLE_A_STAR_H
+
+#include <vector>
+#include <cstdint>
+#include "graph/SampleCSRGraph.h"
+#include "algorithm/SampleQueryContext.h"
+
+// A* point-to-point search on a frozen snapshot, steered by the great-circle
+// (haversine) distance between the vertex coordinates scaled by a minimum
+// cost per km. The heuristic is only used when every arc costs at least
+// costPerKm times the great-circle length of the arc; that makes it
+// consistent (and so admissible), otherwise it is switched off and the
+// search behaves exactly like Dijkstra. A costPerKm of 0 takes the largest
+// admissible one, computeMaxCostPerKm.
+class SampleAStar {
+private:
+    const SampleCSRGraph* graph;
+    std::vector<double> latitude;  // radians, indexed by vertex id
+    std::vector<double> longitude; // radians
+    std::vector<double> cosLatitude;
+    double costPerKm;
+    bool heuristicEnabled;
+
+    void setCoordinates(const std::vector<double>& latitudes, const std::vector<double>& longitudes);
+
+public:
+    static const double EARTH_RADIUS_KM;
+
+    // Coordinates from the graph's vertex objects
+    SampleAStar(const SampleCSRGraph* graph, double costPerKm);
+    // Coordinates in degrees by vertex id, for graphs without vertex objects
+    // such as a mapped snapshot
+    SampleAStar(const SampleCSRGraph* graph, const std::vector<double>& latitudes,
+                const std::vector<double>& longitudes, double costPerKm);
+
+    bool isHeuristicEnabled() const { return heuristicEnabled; }
+    double getCostPerKm() const { return costPerKm; }
+
+    // Lower bound on the cost from u to target
+    double estimate(uint32_t u, uint32_t target) const;
+
+    // Runs the query in the caller's context (one context per thread) and
+    // returns the distance, max() if unreachable. The path is
+    // context.getPath(target).
+    double findShortestPath(uint32_t source, uint32_t target, SampleQueryContext& context) const;
+
+    // Great-circle distance in km between two points given in degrees
+    static double haversineKm(double lat1, double lon1, double lat2, double lon2);
+
+    // Largest cost per km for which the heuristic stays admissible on graph,
+    // max() if no arc has a length in km
+    static double computeMaxCostPerKm(const SampleCSRGraph* graph);
+    static double computeMaxCostPerKm(const SampleCSRGraph* graph, const std::vector<double>& latitudes,
+                                      const std::vector<double>& longitudes);
+};
+#endif
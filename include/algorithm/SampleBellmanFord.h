@@ -3,21 +3,80 @@
 #define SAMPLE_BELLMAN_FORD_H
 
 #include "graph/SampleNegativeGraph.h"
+#include "graph/SampleCSRGraph.h"
+#include "util/SampleThreadPool.h"
 #include <vector>
-#include <unordered_map>
-#include <unordered_set>
+#include <cstdint>
 
 class SampleBellmanFord {
+public:
+    static const uint32_t NO_PARENT = 0xFFFFFFFFu;
+    
+    // One arc of the flat edge list the relaxation passes sweep over
+    struct Edge {
+        uint32_t from;
+        uint32_t to;
+        double weight;
+    };
+    
+    // A simple cycle through a given vertex, listed from that vertex on,
+    // with the sum of its arc weights (negative = profitable)
+    struct RankedCycle {
+        std::vector<SampleVertex*> vertices;
+        double weight;
+    };
+
 private:
     SampleNegativeGraph* graph;
+    const SampleCSRGraph* csrGraph;
+    
+    const SampleCSRGraph* getSnapshot();
+    uint32_t getSource(const SampleCSRGraph* csr) const;
+    std::vector<SampleVertex*> findNegativeCycleParallel(const SampleCSRGraph* csr, SampleThreadPool* pool);
     
     std::vector<SampleVertex*> reconstructCycle(
-        SampleVertex* cycleVertex,
-        const std::unordered_map<SampleVertex*, SampleVertex*>& parent);
+        const SampleCSRGraph* csr,
+        uint32_t cycleVertex,
+        const std::vector<uint32_t>& parent);
+    
+    std::vector<SampleVertex*> findParentCycle(
+        const SampleCSRGraph* csr,
+        const std::vector<uint32_t>& parent);
 
 public:
     SampleBellmanFord(SampleNegativeGraph* graph);
-    std::vector<SampleVertex*> findNegativeCycle();
+    SampleBellmanFord(const SampleCSRGraph* csrGraph); // runs directly on a frozen snapshot
+    
+    // Classic Bellman-Ford from a single source over dense vertex ids:
+    // distances and parents live in flat arrays and each pass sweeps a flat
+    // (from, to, weight) edge list. Passes stop early once nothing changes.
+    //
+    // With a pool the arcs are grouped by target vertex and split into
+    // chunks, so each distance is only written by the worker running its
+    // chunk; the end of each pool run is the barrier between rounds. A cycle
+    // that closes in the parent graph ends the search early. The verdict is
+    // the same as without a pool, the cycle returned may differ when there
+    // are several.
+    std::vector<SampleVertex*> findNegativeCycle(SampleThreadPool* pool = nullptr);
+    
+    // Arcs of a snapshot as a flat edge list, in vertex id order
+    static std::vector<Edge> buildEdgeList(const SampleCSRGraph* csr);
+    
+    // Queue-based Bellman-Ford (SPFA) with Tarjan's subtree disassembly.
+    // Starts from a virtual source joined to every vertex, so any negative
+    // cycle in the graph is found. Stops as soon as the queue runs dry, and
+    // returns a cycle the moment one closes in the parent graph.
+    std::vector<SampleVertex*> findNegativeCycleSPFA();
+    
+    // The k most profitable simple cycles through `through` with at most
+    // maxArcs arcs, most profitable first. Best-first search over partial
+    // paths keyed by cost plus the cheapest walk back to `through` within the
+    // remaining arcs, so cycles come out in exact profit order; ties keep the
+    // order they were found in, which only depends on the vertex ids. With
+    // disjoint set, no two cycles share a vertex other than `through`.
+    // Stops early after maxLabels partial paths and returns what it has.
+    std::vector<RankedCycle> findTopCycles(SampleVertex* through, size_t k, uint32_t maxArcs = 8,
+                                           bool disjoint = false, size_t maxLabels = 1 << 20);
 };
 
 #endif // SAMPLE_BELLMAN_FORD_H
\ No newline at end of file
@@ -0,0 +1,54 @@
+// SampleContractionHierarchy.h
+#ifndef SAMPLE_CONTRACTION_HIERARCHY_H
+#define SAMPLE_CONTRACTION_HIERARCHY_H
+
+#include <vector>
+#include <cstdint>
+#include "graph/SampleCSRGraph.h"
+#include "algorithm/SampleQueryContext.h"
+
+// Contraction hierarchy over an undirected frozen snapshot.
+//
+// Preprocessing contracts the vertices one by one, cheapest first by edge
+// difference (shortcuts added minus arcs removed, plus the number of
+// already contracted neighbours). Contracting v adds a shortcut u-w with
+// middle vertex v whenever u-v-w may be the only shortest u-w path; a
+// bounded witness search proves the other cases. Priorities are estimated
+// with much shorter witness searches, and each search stops once it has
+// settled every neighbour it has to reach.
+//
+// Queries run a bidirectional Dijkstra that only climbs to higher ranked
+// vertices and unpack the shortcuts on the best path through their middle
+// vertices, so distances and paths are those of the original graph.
+class SampleContractionHierarchy {
+private:
+    const SampleCSRGraph* graph;
+    std::vector<uint32_t> rank; // contraction order of each vertex
+    // Upward graph: the arcs of v lead to vertices ranked above v
+    std::vector<uint32_t> upOffsets;
+    std::vector<uint32_t> upTargets;
+    std::vector<double> upWeights;
+    std::vector<uint32_t> upMiddles; // vertex a shortcut bypasses, NO_VERTEX for original edges
+    uint32_t shortcutCount;
+
+    void contract(uint32_t settleLimit);
+    uint32_t findUpArc(uint32_t from, uint32_t to) const;
+    void unpackArc(uint32_t from, uint32_t to, std::vector<uint32_t>& path) const;
+
+public:
+    // Runs the preprocessing; throws std::runtime_error for directed snapshots
+    SampleContractionHierarchy(const SampleCSRGraph* graph, uint32_t witnessSettleLimit = 500);
+
+    const SampleCSRGraph* getGraph() const { return graph; }
+    uint32_t getRank(uint32_t v) const { return rank[v]; }
+    uint32_t getShortcutCount() const { return shortcutCount; }
+    uint32_t getUpArcCount() const { return static_cast<uint32_t>(upTargets.size()); }
+
+    // Shortest source-target distance (max() if unreachable). When path is
+    // given it receives the unpacked vertex ids from source to target.
+    // forward and backward are per-thread contexts.
+    double findShortestPath(uint32_t source, uint32_t target,
+                            SampleQueryContext& forward, SampleQueryContext& backward,
+                            std::vector<uint32_t>* path = nullptr) const;
+};
+#endif
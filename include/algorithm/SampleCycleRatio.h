@@ -0,0 +1,51 @@
+// SampleCycleRatio.h
+#ifndef SAMPLE_CYCLE_RATIO_H
+#define SAMPLE_CYCLE_RATIO_H
+
+#include <vector>
+#include <cstdint>
+#include "graph/SampleCSRGraph.h"
+
+// Minimum cost-to-time ratio cycle of a directed snapshot. Costs are the arc
+// weights and times a second value per arc (travel distance), so on the
+// negative graph the minimum ratio cycle is the one with the most profit per
+// unit of distance. With unit times this is the minimum mean cycle.
+//
+// The solver is Howard's policy iteration: every vertex follows one
+// out-arc, the cycles of that policy give each vertex a ratio and a
+// potential, and arcs that lead to a smaller ratio (or, at equal ratio, a
+// smaller potential) replace the policy arc until nothing improves. It
+// usually stops after a handful of iterations. Karp's O(nm) algorithm is
+// kept as a reference for the minimum mean.
+class SampleCycleRatio {
+public:
+    struct RatioCycle {
+        std::vector<SampleVertex*> vertices; // empty if the graph has no cycle
+        double cost;
+        double time;
+        double ratio; // cost / time
+    };
+
+private:
+    const SampleCSRGraph* graph;
+    uint32_t iterations;
+
+    RatioCycle makeCycle(const std::vector<uint32_t>& vertices, const std::vector<uint32_t>& arcs,
+                         const std::vector<double>& times) const;
+
+public:
+    SampleCycleRatio(const SampleCSRGraph* graph);
+
+    // times holds one positive value per arc, indexed like the snapshot's
+    // arcs; empty means unit times. Throws std::runtime_error otherwise.
+    RatioCycle findMinimumRatioCycle(const std::vector<double>& times);
+    RatioCycle findMinimumMeanCycle() { return findMinimumRatioCycle(std::vector<double>()); }
+
+    // Karp's algorithm; keeps an (n + 1) x n table, meant for checking
+    // Howard on small graphs
+    RatioCycle findMinimumMeanCycleKarp() const;
+
+    // Policy improvement rounds of the last Howard run
+    uint32_t getIterations() const { return iterations; }
+};
+#endif
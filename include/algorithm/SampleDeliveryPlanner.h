@@ -0,0 +1,72 @@
+// SampleDeliveryPlanner.h
+#ifndef SAMPLE_DELIVERY_PLANNER_H
+#define SAMPLE_DELIVERY_PLANNER_H
+
+#include <vector>
+#include <cstdint>
+#include "graph/SamplePositiveGraph.h"
+#include "graph/SampleNegativeGraph.h"
+#include "graph/SampleGraphSnapshot.h"
+#include "graph/SampleCSRGraph.h"
+#include "algorithm/SampleTourOptimizer.h"
+#include "algorithm/SampleFleetPlanner.h"
+#include "util/SampleThreadPool.h"
+
+// Planning steps shared by the command line tool and the benchmarks
+class SampleDeliveryPlanner {
+public:
+    struct ImprovedTour {
+        std::vector<SampleVertex*> initial; // the cycle's stops from the garage on
+        std::vector<SampleVertex*> stops;   // the same, in the improved order
+        SampleTourOptimizer::Result result;
+    };
+
+    // Profit graph over the positive graph's places: pickup -> dropoff arcs
+    // weighted by minus the delivery profit (which grows with the shortest
+    // path distance), small bonuses between pickups, and zero-weight arcs
+    // garage -> pickup and dropoff -> garage. The distances come from
+    // snapshot when it holds the matrix, otherwise from one distance matrix
+    // computed on pool when given.
+    static SampleNegativeGraph* createNegativeGraph(SamplePositiveGraph* positiveGraph,
+                                                    const SampleGraphSnapshot* snapshot = nullptr,
+                                                    SampleThreadPool* pool = nullptr);
+
+    // Better visiting order for a profitable cycle driven from the garage.
+    // The stops are the cycle's places other than the garage, starting after
+    // it when the cycle passes through it; a dropoff stays after the pickup
+    // last visited before it in that order, where its load came from. Legs
+    // are shortest path distances on graph, computed as one distance matrix
+    // (on pool when given).
+    static ImprovedTour improveTour(const SampleCSRGraph* graph, SampleVertex* garage,
+                                    const std::vector<SampleVertex*>& cycle,
+                                    const SampleTourOptimizer::Options& options = SampleTourOptimizer::Options(),
+                                    SampleThreadPool* pool = nullptr);
+
+    // Travel distance of every profit graph arc, indexed like the arcs of
+    // its snapshot, taken from the shortest paths between the same places
+    // (same ids) on roads. Only the places arcs touch are searched: the
+    // distinct arc tails as sources and heads as targets of one distance
+    // matrix, computed on pool when given.
+    static std::vector<double> arcDistances(const SampleCSRGraph* roads, const SampleCSRGraph* arcs,
+                                            SampleThreadPool* pool = nullptr);
+
+    // Profit of carrying a load over distance, as the profit graph pays it
+    static double deliveryProfit(double distance);
+
+    // Weight of a closed cycle of the profit graph (its snapshot): for each
+    // stop and the next, back to the first, the cheapest arc between them,
+    // which is the one the cycle searches relax. Minus the cycle's profit.
+    static double cycleWeight(const SampleCSRGraph* profitGraph, const std::vector<SampleVertex*>& cycle);
+
+    // Every garage of the map, the depots of a fleet
+    static std::vector<uint32_t> findGarages(SamplePositiveGraph* positiveGraph);
+
+    // One order per dropoff, served from the pickup nearest to it by road
+    // and paying deliveryProfit for that distance; dropoffs no pickup
+    // reaches are left out. The distances are one matrix, on pool if given.
+    static std::vector<SampleFleetPlanner::Order> createOrders(SamplePositiveGraph* positiveGraph,
+                                                               SampleThreadPool* pool = nullptr);
+
+    static std::vector<uint32_t> vertexIds(const std::vector<SampleVertex*>& vertices);
+};
+#endif
@@ -3,18 +3,89 @@
 #define SAMPLE_DIJKSTRA_H
 
 #include <vector>
+#include <cstdint>
 #include "graph/SamplePositiveGraph.h"
+#include "graph/SampleCSRGraph.h"
+#include "algorithm/SampleQueryContext.h"
+#include "algorithm/SampleShortestPathCache.h"
 
 class SampleDijkstra {
 private:
     SamplePositiveGraph* positiveGraph;
+    SampleQueryContext context; // reused by the vertex-based API
+    SampleQueryContext backward; // second side of the bidirectional legs
+    SampleShortestPathCache cache; // trees of the vertex-based API, by source
+    std::vector<char> legSource; // by vertex id: started a leg on legVersion
+    unsigned long legVersion;
+    uint64_t bidirectionalLegs;
 
 public:
     SampleDijkstra(SamplePositiveGraph* positiveGraph);
     
     void runDijkstra(SampleVertex* source);
+    void setHeapType(SampleHeapType heapType) {
+        context.setHeapType(heapType);
+        backward.setHeapType(heapType);
+    }
+    
+    // Shortest path tree from source, searched once and then served from the
+    // cache until the graph changes. The reference is valid until the next
+    // call that may search.
+    const SampleShortestPathCache::Tree& getTree(uint32_t source);
+    double getDistance(SampleVertex* source, SampleVertex* target); // max() if unreachable
+    SampleShortestPathCache& getCache() { return cache; }
+    
+    // One leg of a route. The first leg from a source is a bidirectional
+    // search; a source that starts another leg, or whose tree is cached
+    // already, is served from its shortest path tree. Fills path with the
+    // vertex ids from source to target (empty if unreachable) and returns
+    // the distance.
+    double findLeg(uint32_t source, uint32_t target, std::vector<uint32_t>& path);
+    uint64_t getBidirectionalLegs() const { return bidirectionalLegs; }
+    
+    // Re-entrant search on a frozen snapshot. Results go into the context and
+    // neither the graph nor its vertices are modified, so any number of
+    // threads may query one snapshot, each with its own context.
+    static void runDijkstra(const SampleCSRGraph* graph, uint32_t source, SampleQueryContext& context);
+    
+    // Point-to-point search that stops as soon as target is settled, so only
+    // the ball around source up to the target distance is touched. Returns
+    // the distance (max() if unreachable); the path is context.getPath(target).
+    static double runPointToPoint(const SampleCSRGraph* graph, uint32_t source, uint32_t target,
+                                  SampleQueryContext& context);
+    
+    // One-to-many search that stops once all targets are settled. isTarget
+    // is indexed by vertex id and marks targetCount distinct vertices; it is
+    // only read, so threads can share one marker array.
+    static void runOneToMany(const SampleCSRGraph* graph, uint32_t source,
+                             const std::vector<char>& isTarget, uint32_t targetCount,
+                             SampleQueryContext& context);
+    
+    // Search that stops once count of the marked vertices are settled or the
+    // next settled vertex lies beyond radius. The settled marked vertices
+    // within radius are the nearest ones.
+    static void runNearest(const SampleCSRGraph* graph, uint32_t source,
+                           const std::vector<char>& isTarget, uint32_t count, double radius,
+                           SampleQueryContext& context);
+    
+    // Bidirectional point-to-point search that meets in the middle. Fills path
+    // with the vertex ids from source to target (empty if unreachable) and
+    // returns the distance. Directed snapshots fall back to runPointToPoint.
+    static double runBidirectional(const SampleCSRGraph* graph, uint32_t source, uint32_t target,
+                                   SampleQueryContext& forward, SampleQueryContext& backward,
+                                   std::vector<uint32_t>& path);
+    
+    // Same search with the results copied to the caller's arrays (indexed by
+    // vertex id); parent is NO_PARENT for the source and unreachable vertices.
+    static const uint32_t NO_PARENT = SampleQueryContext::NO_VERTEX;
+    static void runDijkstra(const SampleCSRGraph* graph, uint32_t source,
+                            std::vector<double>& distance, std::vector<uint32_t>& parent);
+    static std::vector<uint32_t> getShortestPath(const std::vector<uint32_t>& parent,
+                                                 uint32_t source, uint32_t target);
+    
     std::vector<SampleVertex*> getShortestPath(SampleVertex* target);
-    void printShortestPath(SampleVertex* source, SampleVertex* target);
-    void executeNegativeCycleAndPrintPath(SampleVertex* garage, const std::vector<SampleVertex*>& cycle);
+    double printShortestPath(SampleVertex* source, SampleVertex* target); // returns the leg distance
+    // Prints every leg of garage -> cycle -> garage; returns the route distance
+    double executeNegativeCycleAndPrintPath(SampleVertex* garage, const std::vector<SampleVertex*>& cycle);
 };
 #endif
\ No newline at end of file
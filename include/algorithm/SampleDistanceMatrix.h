@@ -0,0 +1,55 @@
+// SampleDistanceMatrix.h
+#ifndef SAMPLE_DISTANCE_MATRIX_H
+#define SAMPLE_DISTANCE_MATRIX_H
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "graph/SampleCSRGraph.h"
+#include "algorithm/SampleMultiSourceDijkstra.h"
+#include "algorithm/SampleQueryContext.h"
+#include "util/SampleThreadPool.h"
+
+// Shortest-path distances from a set of source vertices to a set of target
+// vertices, computed in one batch. Sources close to each other are grouped
+// into blocks of up to one lane count and searched together by
+// SampleMultiSourceDijkstra in a single traversal; a source with no close
+// neighbour gets a plain one-to-many search. Either way a search stops once
+// every target is final. Blocks can be spread over a thread pool, one
+// search state per worker.
+class SampleDistanceMatrix {
+private:
+    std::vector<uint32_t> sources;
+    std::vector<uint32_t> targets;
+    std::vector<double> distances; // row-major, sources x targets
+    std::unordered_map<uint32_t, size_t> rowOf;
+    std::unordered_map<uint32_t, size_t> columnOf;
+    SampleLaneKernel kernel;
+
+    std::vector<std::vector<size_t> > planBlocks(const SampleCSRGraph* graph, const std::vector<char>& isTarget,
+                                                 uint32_t targetCount, SampleQueryContext& context);
+    void storeRow(size_t row, const SampleQueryContext& context);
+
+public:
+    // Sources within this fraction of the first row's search radius of each
+    // other share a lane block; further apart their searches share too
+    // little for the lanes to pay off
+    static const double LANE_RADIUS;
+
+    SampleDistanceMatrix(const std::vector<uint32_t>& sources, const std::vector<uint32_t>& targets);
+
+    // Lane kernel for compute(), the widest the CPU supports by default
+    SampleLaneKernel getKernel() const { return kernel; }
+    void setKernel(SampleLaneKernel kernel) { this->kernel = kernel; }
+
+    // Fills the table; runs the blocks on pool when one is given
+    void compute(const SampleCSRGraph* graph, SampleThreadPool* pool = nullptr);
+
+    const std::vector<uint32_t>& getSources() const { return sources; }
+    const std::vector<uint32_t>& getTargets() const { return targets; }
+    double getDistance(size_t row, size_t column) const { return distances[row * targets.size() + column]; }
+
+    // Lookup by vertex id, max() if either id is not part of the matrix
+    double getDistanceById(uint32_t source, uint32_t target) const;
+};
+#endif
@@ -0,0 +1,114 @@
+// SampleFleetPlanner.h
+#ifndef SAMPLE_FLEET_PLANNER_H
+#define SAMPLE_FLEET_PLANNER_H
+
+#include <vector>
+#include <cstdint>
+#include "graph/SampleCSRGraph.h"
+#include "algorithm/SampleTourOptimizer.h"
+#include "util/SampleThreadPool.h"
+
+// Routes for a fleet of trucks based at several depots: every truck drives
+// one route from its depot and back, and together the routes carry every
+// order from its pickup to its dropoff.
+//
+// Planning runs in three steps on one distance matrix over the depots and
+// the orders' places:
+//  1. Partition. Trucks are spread over the depots in turn. Each order goes
+//     to the depot that reaches it most cheaply and still has room, orders
+//     with the most to lose from a second choice first. A depot's orders
+//     are then clustered on latitude and longitude (k-means, one cluster
+//     per truck, same capacity rule), so every truck gets a compact area.
+//  2. Solve. Every truck's route is built pickup-before-dropoff and then
+//     improved by SampleTourOptimizer, all routes at once on the thread
+//     pool. The time budget is for the whole fleet: each route gets its
+//     share of budget x workers, so 50 trucks plan in about the time of one.
+//  3. Rebalance. Orders move to the route where inserting them (pickup,
+//     then dropoff, at their cheapest positions) costs less than they save
+//     where they are, possibly at another depot, for a few rounds; the
+//     routes that changed are improved again in parallel.
+class SampleFleetPlanner {
+public:
+    struct Order {
+        uint32_t pickup;  // vertex ids
+        uint32_t dropoff;
+        double profit;    // carried into the route totals, not optimized
+    };
+
+    struct Options {
+        uint32_t truckCount;
+        uint32_t capacity;        // orders per truck; 0 is an even share plus a quarter
+        double budgetSeconds;     // route solving, for the whole fleet
+        uint32_t rebalanceRounds; // 0 skips step 3
+        uint32_t seed;
+        Options() : truckCount(1), capacity(0), budgetSeconds(0.05), rebalanceRounds(3), seed(1) {}
+    };
+
+    struct Route {
+        uint32_t depot;              // vertex id
+        std::vector<uint32_t> orders; // indices into the planner's orders
+        std::vector<uint32_t> stops;  // vertex ids in visiting order, without the depot
+        double distance;             // max() if some leg is unreachable
+        double profit;               // of its orders
+    };
+
+    struct Plan {
+        std::vector<Route> routes;     // one per truck, in truck order; some may be empty
+        std::vector<uint32_t> unserved; // orders no depot with trucks can reach
+        double distance;               // of all routes, max() if some leg is unreachable
+        double profit;                 // of the served orders
+        uint32_t movedOrders;          // by rebalancing
+    };
+
+private:
+    const SampleCSRGraph* graph;
+    std::vector<uint32_t> depots;
+    std::vector<Order> orders;
+
+    // Places: the depots first, then the distinct pickups and dropoffs
+    std::vector<uint32_t> places;
+    std::vector<uint32_t> depotPlace;    // by depot index
+    std::vector<uint32_t> pickupPlace;   // by order
+    std::vector<uint32_t> dropoffPlace;  // by order
+    std::vector<double> realLegs;        // places x places, row-major
+    std::vector<double> legs;            // the same, unreachable legs at a penalty
+
+    // A route while planning, on place indices
+    struct Work {
+        uint32_t depot; // depot index
+        std::vector<uint32_t> orders;
+        std::vector<uint32_t> stops;
+        bool changed;
+    };
+
+    double leg(uint32_t from, uint32_t to) const { return legs[from * places.size() + to]; }
+    double orderCost(uint32_t depot, uint32_t order) const;
+    double routeLength(const Work& route, const std::vector<double>& matrix) const;
+
+    void computeLegs(SampleThreadPool* pool);
+    std::vector<uint32_t> assignDepots(const std::vector<uint32_t>& truckDepots, uint32_t capacity,
+                                       std::vector<uint32_t>& unserved) const;
+    void clusterDepot(const std::vector<uint32_t>& depotOrders, const std::vector<uint32_t>& trucks,
+                      uint32_t capacity, std::vector<Work>& routes) const;
+    void solveRoutes(std::vector<Work>& routes, bool changedOnly, const Options& options, SampleThreadPool* pool) const;
+    void solveRoute(Work& route, double budgetSeconds, uint32_t seed) const;
+    uint32_t rebalance(std::vector<Work>& routes, uint32_t capacity, uint32_t rounds) const;
+
+    double removalGain(const Work& route, uint32_t order) const;
+    double insertionCost(const Work& route, uint32_t order, size_t& pickupAt, size_t& dropoffAt) const;
+    void removeOrder(Work& route, uint32_t order) const;
+    void insertOrder(Work& route, uint32_t order, size_t pickupAt, size_t dropoffAt) const;
+
+public:
+    // depots are vertex ids of graph; throws std::invalid_argument if there
+    // are none or an id is out of range
+    SampleFleetPlanner(const SampleCSRGraph* graph, const std::vector<uint32_t>& depots,
+                       const std::vector<Order>& orders);
+
+    const std::vector<Order>& getOrders() const { return orders; }
+
+    // Plans options.truckCount routes (std::invalid_argument if 0). The
+    // distance matrix and the route solving run on pool when given.
+    Plan plan(const Options& options, SampleThreadPool* pool = nullptr);
+};
+#endif
@@ -0,0 +1,84 @@
+// SampleMultiSourceDijkstra.h
+#ifndef SAMPLE_MULTI_SOURCE_DIJKSTRA_H
+#define SAMPLE_MULTI_SOURCE_DIJKSTRA_H
+
+#include <vector>
+#include <cstdint>
+#include "graph/SampleCSRGraph.h"
+#include "algorithm/SamplePriorityQueue.h"
+
+// Compile-time switch for the vector kernels, override with -DSAMPLE_SIMD=0
+// to always run the scalar lanes
+#ifndef SAMPLE_SIMD
+#define SAMPLE_SIMD 1
+#endif
+
+// How the lanes of a distance row are relaxed
+enum class SampleLaneKernel {
+    Scalar, // plain loop over 4 lanes, any CPU
+    Avx2,   // 4 doubles per row, one 256-bit add/compare/min per arc
+    Avx512  // 8 doubles per row, one 512-bit add/compare/min per arc
+};
+
+// Shortest paths from several sources (lanes) in one traversal of the graph.
+// Every vertex holds one distance per lane in a contiguous row, so relaxing
+// an arc updates all lanes with one vector add, compare and min. Sources
+// near each other settle most vertices in the same order and share those
+// scans. A vertex is queued again whenever any of its lanes improves, keyed
+// by the smallest improved distance; keys stay monotone and the distances
+// are exactly those of one Dijkstra per source.
+//
+// With targets the search stops once no queued key is below the largest
+// target distance in any lane. An instance is one worker's state; give each
+// thread its own.
+class SampleMultiSourceDijkstra {
+public:
+    static const unsigned MAX_LANES = 8;
+
+    // A row that got smaller while scanning one vertex
+    struct Improvement {
+        uint32_t vertex;
+        uint32_t newLanes; // bit per lane that was unreached before
+        double key;        // smallest improved distance
+    };
+
+private:
+    SampleLaneKernel kernel;
+    unsigned laneCount;
+    uint32_t vertexCount;
+    std::vector<double> distance;  // vertexCount rows of laneCount, max() = unreached
+    std::vector<uint32_t> reached; // vertices whose row is not all max()
+    std::vector<char> isReached;
+    std::vector<uint32_t> reachedTargets;
+    std::vector<Improvement> improvements;
+    SampleIndexedDaryHeap<4> queue;
+
+    void resize(uint32_t vertexCount);
+    void clear();
+
+public:
+    // Uses the widest kernel the CPU supports
+    SampleMultiSourceDijkstra(uint32_t vertexCount = 0);
+    // Throws std::invalid_argument if the CPU cannot run kernel
+    SampleMultiSourceDijkstra(uint32_t vertexCount, SampleLaneKernel kernel);
+
+    SampleLaneKernel getKernel() const { return kernel; }
+    // Most sources one run() answers
+    unsigned getLaneCount() const { return laneCount; }
+
+    // Searches from sourceCount (at most getLaneCount()) sources at once.
+    // isTarget marks targetCount distinct vertices; with targetCount 0 every
+    // reachable vertex gets its final distance in every lane.
+    void run(const SampleCSRGraph* graph, const uint32_t* sources, unsigned sourceCount,
+             const std::vector<char>& isTarget, uint32_t targetCount);
+
+    // Distance from the lane-th source to v, max() if not reached
+    double getDistance(unsigned lane, uint32_t v) const { return distance[size_t(v) * laneCount + lane]; }
+
+    // Widest kernel this CPU and build can run
+    static SampleLaneKernel detectKernel();
+    static bool isSupported(SampleLaneKernel kernel);
+    static unsigned getLaneCount(SampleLaneKernel kernel);
+    static const char* getKernelName(SampleLaneKernel kernel);
+};
+#endif
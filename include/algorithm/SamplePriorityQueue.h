@@ -0,0 +1,237 @@
+// SamplePriorityQueue.h
+#ifndef SAMPLE_PRIORITY_QUEUE_H
+#define SAMPLE_PRIORITY_QUEUE_H
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+#include <cstring>
+
+// Priority queues over dense vertex ids for the shortest-path searches.
+// All of them share the same interface:
+//   reset(vertexCount)  empty the queue for a new search
+//   push(vertex, key)   insert the vertex, or lower its key if already queued
+//   pop()               remove and return a vertex with the smallest key
+//   topKey()            smallest key in the queue, without removing it
+//   empty(), size()
+// The lazy queues may return a vertex more than once (once per push); the
+// search skips such stale pops by checking whether the vertex is settled.
+
+enum class SampleHeapType {
+    Binary = 0,  // std::push_heap binary heap with lazy duplicate pushes
+    FourAry = 1, // indexed 4-ary heap with true decrease-key
+    Radix = 2    // radix heap, monotone keys only (non-negative weights)
+};
+
+// Compile-time default heap, override with -DSAMPLE_DEFAULT_HEAP=0|1|2
+#ifndef SAMPLE_DEFAULT_HEAP
+#define SAMPLE_DEFAULT_HEAP 1
+#endif
+
+// Binary heap with duplicate entries, the classic lazy Dijkstra queue
+class SampleBinaryHeap {
+private:
+    typedef std::pair<double, uint32_t> Entry;
+    std::vector<Entry> heap;
+
+public:
+    void reset(uint32_t) { heap.clear(); }
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+
+    void push(uint32_t vertex, double key) {
+        heap.push_back(Entry(key, vertex));
+        std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+    }
+
+    double topKey() const { return heap.front().first; }
+
+    uint32_t pop() {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+        uint32_t vertex = heap.back().second;
+        heap.pop_back();
+        return vertex;
+    }
+};
+
+// Indexed D-ary heap. Every vertex is in the heap at most once and keeps its
+// heap slot in a position array, so push on a queued vertex is a decrease-key.
+template <unsigned D>
+class SampleIndexedDaryHeap {
+private:
+    struct Entry {
+        double key;
+        uint32_t vertex;
+    };
+    static const uint32_t NOT_IN_HEAP = 0xFFFFFFFFu;
+
+    std::vector<Entry> heap;
+    std::vector<uint32_t> position; // vertex -> slot in heap
+
+    void place(uint32_t slot, const Entry& entry) {
+        heap[slot] = entry;
+        position[entry.vertex] = slot;
+    }
+
+    void siftUp(uint32_t slot) {
+        Entry entry = heap[slot];
+        while (slot > 0) {
+            uint32_t parentSlot = (slot - 1) / D;
+            if (heap[parentSlot].key <= entry.key) break;
+            place(slot, heap[parentSlot]);
+            slot = parentSlot;
+        }
+        place(slot, entry);
+    }
+
+    void siftDown(uint32_t slot) {
+        Entry entry = heap[slot];
+        uint32_t count = static_cast<uint32_t>(heap.size());
+        while (true) {
+            uint32_t first = slot * D + 1;
+            if (first >= count) break;
+            uint32_t last = std::min(first + D, count);
+            uint32_t best = first;
+            for (uint32_t child = first + 1; child < last; child++) {
+                if (heap[child].key < heap[best].key) best = child;
+            }
+            if (heap[best].key >= entry.key) break;
+            place(slot, heap[best]);
+            slot = best;
+        }
+        place(slot, entry);
+    }
+
+public:
+    void reset(uint32_t vertexCount) {
+        // Only vertices still queued hold a slot, so clearing is O(size)
+        for (const Entry& entry : heap) {
+            position[entry.vertex] = NOT_IN_HEAP;
+        }
+        heap.clear();
+        if (position.size() != vertexCount) {
+            position.assign(vertexCount, NOT_IN_HEAP);
+        }
+    }
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+    bool contains(uint32_t vertex) const { return position[vertex] != NOT_IN_HEAP; }
+
+    void push(uint32_t vertex, double key) {
+        uint32_t slot = position[vertex];
+        if (slot == NOT_IN_HEAP) {
+            Entry entry = { key, vertex };
+            heap.push_back(entry);
+            siftUp(static_cast<uint32_t>(heap.size() - 1));
+        } else if (key < heap[slot].key) {
+            heap[slot].key = key;
+            siftUp(slot);
+        }
+    }
+
+    double topKey() const { return heap[0].key; }
+
+    uint32_t pop() {
+        uint32_t vertex = heap[0].vertex;
+        position[vertex] = NOT_IN_HEAP;
+        Entry last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap[0] = last;
+            siftDown(0);
+        }
+        return vertex;
+    }
+};
+
+template <unsigned D>
+const uint32_t SampleIndexedDaryHeap<D>::NOT_IN_HEAP;
+
+// Radix heap for monotone searches: every pushed key must be at least the key
+// of the last popped vertex, which holds for Dijkstra with non-negative
+// weights. Non-negative doubles order like their IEEE bit patterns, so the
+// buckets are indexed by the highest bit in which a key differs from the last
+// popped key. Pushes are lazy like SampleBinaryHeap.
+class SampleRadixHeap {
+private:
+    struct Entry {
+        uint64_t key;
+        uint32_t vertex;
+    };
+    std::vector<Entry> buckets[65];
+    uint64_t last;
+    size_t count;
+
+    static uint64_t toBits(double key) {
+        if (key <= 0) return 0; // folds -0.0 into 0
+        uint64_t bits;
+        std::memcpy(&bits, &key, sizeof(bits));
+        return bits;
+    }
+
+    unsigned bucketOf(uint64_t key) const {
+        uint64_t diff = key ^ last;
+        if (diff == 0) return 0;
+#ifdef __GNUC__
+        return 64 - static_cast<unsigned>(__builtin_clzll(diff));
+#else
+        unsigned bucket = 0;
+        while (diff != 0) {
+            diff >>= 1;
+            bucket++;
+        }
+        return bucket;
+#endif
+    }
+
+    // Makes bucket 0 hold the smallest keys: pull the smallest key of the
+    // first non-empty bucket forward and spread that bucket over the lower ones
+    void pull() {
+        if (!buckets[0].empty()) return;
+        unsigned i = 1;
+        while (buckets[i].empty()) i++;
+        uint64_t smallest = buckets[i][0].key;
+        for (const Entry& entry : buckets[i]) {
+            smallest = std::min(smallest, entry.key);
+        }
+        last = smallest;
+        for (const Entry& entry : buckets[i]) {
+            buckets[bucketOf(entry.key)].push_back(entry);
+        }
+        buckets[i].clear();
+    }
+
+public:
+    SampleRadixHeap() : last(0), count(0) {}
+
+    void reset(uint32_t) {
+        for (unsigned i = 0; i < 65; i++) buckets[i].clear();
+        last = 0;
+        count = 0;
+    }
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    void push(uint32_t vertex, double key) {
+        Entry entry = { toBits(key), vertex };
+        buckets[bucketOf(entry.key)].push_back(entry);
+        count++;
+    }
+
+    double topKey() {
+        pull();
+        double key;
+        std::memcpy(&key, &last, sizeof(key));
+        return key;
+    }
+
+    uint32_t pop() {
+        pull();
+        uint32_t vertex = buckets[0].back().vertex;
+        buckets[0].pop_back();
+        count--;
+        return vertex;
+    }
+};
+#endif
@@ -0,0 +1,46 @@
+// SampleQueryBatch.h
+#ifndef SAMPLE_QUERY_BATCH_H
+#define SAMPLE_QUERY_BATCH_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "graph/SampleCSRGraph.h"
+#include "util/SampleThreadPool.h"
+
+// Independent one-to-many shortest path queries, each with its own source
+// and target list, answered together. Submit the jobs, run() them (spread
+// over a thread pool when given one) and read the result table: one row of
+// distances per job, in the order of that job's targets. Unlike
+// SampleDistanceMatrix the target set may differ from job to job.
+class SampleQueryBatch {
+private:
+    struct Job {
+        uint32_t source;
+        std::vector<uint32_t> targets;
+        std::vector<double> distances; // max() for unreachable targets
+        std::vector<std::vector<uint32_t> > paths; // filled when paths were asked for
+    };
+
+    const SampleCSRGraph* graph;
+    std::vector<Job> jobs;
+    bool withPaths;
+
+public:
+    SampleQueryBatch(const SampleCSRGraph* graph, bool withPaths = false);
+
+    // Adds a job and returns its row in the result table
+    size_t submit(uint32_t source, const std::vector<uint32_t>& targets);
+    // Answers every job submitted so far; the graph must stay frozen meanwhile
+    void run(SampleThreadPool* pool = nullptr);
+
+    size_t getJobCount() const { return jobs.size(); }
+    uint32_t getSource(size_t job) const { return jobs[job].source; }
+    const std::vector<uint32_t>& getTargets(size_t job) const { return jobs[job].targets; }
+    const std::vector<double>& getDistances(size_t job) const { return jobs[job].distances; }
+    double getDistance(size_t job, size_t target) const { return jobs[job].distances[target]; }
+    // Vertex ids from the source to the job's target-th target, empty if
+    // unreachable or if the batch was made without paths
+    const std::vector<uint32_t>& getPath(size_t job, size_t target) const;
+};
+#endif
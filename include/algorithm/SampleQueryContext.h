@@ -0,0 +1,94 @@
+// SampleQueryContext.h
+#ifndef SAMPLE_QUERY_CONTEXT_H
+#define SAMPLE_QUERY_CONTEXT_H
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include "algorithm/SamplePriorityQueue.h"
+
+// Per-query search state (distance, parent and settled flag per vertex id).
+// Keeping this outside the graph lets any number of threads query the same
+// frozen graph at once, each with its own context.
+//
+// Entries are generation-stamped: an entry whose stamp differs from the
+// current generation reads as unvisited, so reset() is O(1) and a query only
+// pays for the vertices it actually touches. The context also owns the
+// priority queue, so a query does not allocate once the context is warm.
+class SampleQueryContext {
+private:
+    std::vector<double> distance;
+    std::vector<uint32_t> parent;
+    std::vector<uint32_t> stamp;
+    std::vector<char> settled;
+    std::vector<uint32_t> touched; // vertices touched in this generation
+    uint32_t generation;
+    uint32_t source;
+    
+    // Queues are kept with the context so their storage is reused across queries
+    SampleHeapType heapType;
+    SampleBinaryHeap binaryHeap;
+    SampleIndexedDaryHeap<4> fourAryHeap;
+    SampleRadixHeap radixHeap;
+    
+    static SampleHeapType defaultHeapType;
+
+public:
+    static const uint32_t NO_VERTEX = 0xFFFFFFFFu;
+
+    SampleQueryContext(uint32_t vertexCount = 0);
+
+    // Starts a new query over a graph with vertexCount vertices
+    void reset(uint32_t vertexCount);
+
+    uint32_t getSource() const { return source; }
+    void setSource(uint32_t source) { this->source = source; }
+
+    bool isTouched(uint32_t v) const { return stamp[v] == generation; }
+    double getDistance(uint32_t v) const {
+        return stamp[v] == generation ? distance[v] : std::numeric_limits<double>::max();
+    }
+    uint32_t getParent(uint32_t v) const {
+        return stamp[v] == generation ? parent[v] : NO_VERTEX;
+    }
+    bool isSettled(uint32_t v) const { return stamp[v] == generation && settled[v]; }
+
+    void setDistance(uint32_t v, double d, uint32_t p) {
+        touch(v);
+        distance[v] = d;
+        parent[v] = p;
+    }
+    void setSettled(uint32_t v) {
+        touch(v);
+        settled[v] = 1;
+    }
+
+    const std::vector<uint32_t>& getTouched() const { return touched; }
+
+    // Priority queue used by searches running in this context
+    SampleHeapType getHeapType() const { return heapType; }
+    void setHeapType(SampleHeapType heapType) { this->heapType = heapType; }
+    SampleBinaryHeap& getBinaryHeap() { return binaryHeap; }
+    SampleIndexedDaryHeap<4>& getFourAryHeap() { return fourAryHeap; }
+    SampleRadixHeap& getRadixHeap() { return radixHeap; }
+
+    // Heap type picked up by contexts created afterwards (SAMPLE_DEFAULT_HEAP
+    // at start-up). Set it before starting worker threads.
+    static SampleHeapType getDefaultHeapType() { return defaultHeapType; }
+    static void setDefaultHeapType(SampleHeapType heapType) { defaultHeapType = heapType; }
+
+    // Vertex ids from the source to target, empty if target was not reached
+    std::vector<uint32_t> getPath(uint32_t target) const;
+
+private:
+    void touch(uint32_t v) {
+        if (stamp[v] != generation) {
+            stamp[v] = generation;
+            distance[v] = std::numeric_limits<double>::max();
+            parent[v] = NO_VERTEX;
+            settled[v] = 0;
+            touched.push_back(v);
+        }
+    }
+};
+#endif
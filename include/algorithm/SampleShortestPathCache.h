@@ -0,0 +1,72 @@
+// SampleShortestPathCache.h
+#ifndef SAMPLE_SHORTEST_PATH_CACHE_H
+#define SAMPLE_SHORTEST_PATH_CACHE_H
+
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+#include "algorithm/SampleQueryContext.h"
+
+// Least-recently-used cache of complete shortest path trees, keyed by
+// source vertex id. Each tree holds a distance and a parent per vertex
+// (12 bytes per vertex); trees are evicted once their total size passes
+// the byte budget, but the most recent tree is always kept.
+//
+// The cache is tied to a graph version: validate() drops every tree when
+// the version differs from the one the trees were computed on.
+class SampleShortestPathCache {
+public:
+    static const uint32_t NO_VERTEX = SampleQueryContext::NO_VERTEX;
+    static const size_t DEFAULT_MAX_BYTES = 64 << 20;
+
+    struct Tree {
+        uint32_t source;
+        std::vector<double> distance; // by vertex id, max() if unreachable
+        std::vector<uint32_t> parent; // by vertex id, NO_VERTEX at the source and unreachable vertices
+
+        // Vertex ids from the source to target, empty if unreachable
+        std::vector<uint32_t> getPath(uint32_t target) const;
+    };
+
+private:
+    std::list<Tree> trees; // most recently used first
+    std::unordered_map<uint32_t, std::list<Tree>::iterator> index;
+    size_t maxBytes;
+    size_t bytes;
+    unsigned long version;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t invalidations;
+
+    static size_t treeBytes(uint32_t vertexCount) {
+        return static_cast<size_t>(vertexCount) * (sizeof(double) + sizeof(uint32_t));
+    }
+    void evict();
+
+public:
+    SampleShortestPathCache(size_t maxBytes = DEFAULT_MAX_BYTES);
+
+    // Drops all trees if they were computed on another graph version
+    void validate(unsigned long graphVersion);
+
+    // Tree for source, or nullptr; counts a hit or a miss
+    const Tree* find(uint32_t source);
+    // Whether a tree for source is held, without counting a hit or a miss
+    bool contains(uint32_t source) const { return index.count(source) != 0; }
+    // Stores the tree a full search from the context's source left behind
+    const Tree& insert(const SampleQueryContext& context, uint32_t vertexCount);
+    void clear();
+
+    size_t getMaxBytes() const { return maxBytes; }
+    void setMaxBytes(size_t maxBytes);
+    size_t getSize() const { return trees.size(); }
+    size_t getBytes() const { return bytes; }
+    uint64_t getHits() const { return hits; }
+    uint64_t getMisses() const { return misses; }
+    uint64_t getEvictions() const { return evictions; }
+    uint64_t getInvalidations() const { return invalidations; }
+};
+#endif
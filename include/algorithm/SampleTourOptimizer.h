@@ -0,0 +1,94 @@
+// SampleTourOptimizer.h
+#ifndef SAMPLE_TOUR_OPTIMIZER_H
+#define SAMPLE_TOUR_OPTIMIZER_H
+
+#include <vector>
+#include <deque>
+#include <chrono>
+#include <cstdint>
+
+// Local search over the visiting order of one truck tour from the depot
+// and back. Leg lengths come from a precomputed matrix over the depot
+// (index 0) and the stops (1..n); it may be asymmetric. A stop can name
+// the pickup that has to be visited before it, and no move breaks that.
+//
+// Moves are 2-opt (reverse a stretch of the tour), relocate (move one stop
+// elsewhere) and Or-opt (move a run of up to maxSegment stops, either way
+// round). Prefix sums of the leg lengths along the tour, forwards and
+// backwards, price any of them in O(1), and a suffix minimum of dropoff
+// positions tells in O(1) whether a reversal would put a dropoff before
+// its pickup. Moves are only tried that make a stop adjacent to one of its
+// nearest neighbours, and a stop whose moves gained nothing is not looked
+// at again until a move changes one of its legs (don't-look bits).
+//
+// The search is anytime: after reaching a local optimum it kicks the best
+// tour with random feasible relocations and descends again, keeping the
+// best tour seen, until the wall-clock budget runs out. The tour in hand is
+// always feasible, so stopping at the deadline mid-descent is fine.
+class SampleTourOptimizer {
+public:
+    struct Options {
+        double budgetSeconds;    // wall clock; 0 descends once, without a limit
+        uint32_t neighbourCount; // candidate stops per stop
+        uint32_t maxSegment;     // longest run an Or-opt move takes
+        uint32_t seed;           // of the kicks
+        Options() : budgetSeconds(0.05), neighbourCount(8), maxSegment(3), seed(1) {}
+    };
+
+    struct Result {
+        std::vector<uint32_t> order; // the stops 1..n in visiting order
+        double length;               // max() if some leg is unreachable
+        double initialLength;
+        uint64_t twoOptMoves;
+        uint64_t orOptMoves;
+        uint64_t relocateMoves;
+        uint32_t kicks;
+        bool localOptimum; // false if the budget ran out during the first descent
+        double seconds;
+    };
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    uint32_t stopCount;
+    std::vector<double> realLegs;             // (n + 1) x (n + 1), row-major
+    std::vector<double> legs;                 // the same, unreachable legs at a penalty
+    std::vector<uint32_t> pickupOf;           // by stop, 0 for none
+    std::vector<std::vector<uint32_t> > dropoffsOf;
+    std::vector<std::vector<uint32_t> > neighbours;
+
+    // Search state: tour[0] and tour[n + 1] are the depot
+    std::vector<uint32_t> tour;
+    std::vector<uint32_t> position;    // by stop
+    std::vector<double> forward;       // forward[p]: length of tour[0..p]
+    std::vector<double> backward;      // the same stretch driven backwards
+    std::vector<uint32_t> firstDropoff; // earliest dropoff position of a pickup at p or later
+    std::deque<uint32_t> active;
+    std::vector<char> queued;
+    Result result;
+
+    double leg(uint32_t from, uint32_t to) const { return legs[from * (stopCount + 1) + to]; }
+    double realLength(const std::vector<uint32_t>& order) const;
+    void buildNeighbours(uint32_t count);
+    void refresh();
+    void activate(uint32_t stop);
+
+    bool tryTwoOpt(uint32_t a, uint32_t b);
+    bool canMove(uint32_t first, uint32_t last, uint32_t after, bool reversed) const;
+    double moveGain(uint32_t first, uint32_t last, uint32_t after, bool reversed) const;
+    void applyMove(uint32_t first, uint32_t last, uint32_t after, bool reversed);
+    bool tryMove(uint32_t first, uint32_t last, uint32_t after, bool reversed);
+    bool improveStop(uint32_t a, uint32_t maxSegment);
+    bool descend(uint32_t maxSegment, bool limited, Clock::time_point deadline); // false if out of time
+
+public:
+    // legs holds (stopCount + 1)^2 lengths, max() for unreachable ones;
+    // pickupOf holds one entry per index (the depot's is 0). Throws
+    // std::invalid_argument if the sizes or pickups do not fit.
+    SampleTourOptimizer(uint32_t stopCount, const std::vector<double>& legs, const std::vector<uint32_t>& pickupOf);
+
+    // Improves initial, a permutation of 1..n that visits every pickup
+    // before its dropoffs (std::invalid_argument otherwise)
+    Result optimize(const std::vector<uint32_t>& initial, const Options& options = Options());
+};
+#endif
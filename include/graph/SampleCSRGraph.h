@@ -0,0 +1,64 @@
+// SampleCSRGraph.h
+#ifndef SAMPLE_CSR_GRAPH_H
+#define SAMPLE_CSR_GRAPH_H
+
+#include <vector>
+#include <cstdint>
+#include "SampleVertex.h"
+
+// Read-only compressed sparse row snapshot of a graph.
+// Vertices are addressed by their dense 32-bit id; the arcs leaving vertex u
+// are stored in [offsets[u], offsets[u + 1]) of the target and weight arrays.
+// An undirected edge is stored as two directed arcs, one in each direction.
+//
+// The arrays are either built from a vertex list and owned, or borrowed from
+// memory the caller keeps alive (a mapped snapshot file); a borrowed graph
+// may have no vertex objects, in which case getVertex() returns nullptr.
+class SampleCSRGraph {
+private:
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> targets;
+    std::vector<double> weights;
+    std::vector<SampleVertex*> vertices; // id -> original vertex
+    bool undirected;
+    uint32_t vertexCount;
+    uint32_t arcCount;
+    const uint32_t* offsetData;
+    const uint32_t* targetData;
+    const double* weightData;
+
+    SampleCSRGraph(const SampleCSRGraph&);
+    SampleCSRGraph& operator=(const SampleCSRGraph&);
+
+public:
+    SampleCSRGraph(const std::vector<SampleVertex*>& vertices, bool undirected);
+
+    // Directed graph whose edges are kept apart from the vertices:
+    // outgoing[u] lists the edges leaving vertex u
+    SampleCSRGraph(const std::vector<SampleVertex*>& vertices,
+                   const std::vector<std::vector<SampleEdge*> >& outgoing);
+
+    // Borrowed arrays: offsets has vertexCount + 1 entries, targets and
+    // weights arcCount each
+    SampleCSRGraph(uint32_t vertexCount, uint32_t arcCount, const uint32_t* offsets,
+                   const uint32_t* targets, const double* weights, bool undirected);
+
+    uint32_t getVertexCount() const { return vertexCount; }
+    uint32_t getArcCount() const { return arcCount; }
+    bool isUndirected() const { return undirected; }
+
+    // Arc range of a vertex and per-arc data
+    uint32_t getArcBegin(uint32_t u) const { return offsetData[u]; }
+    uint32_t getArcEnd(uint32_t u) const { return offsetData[u + 1]; }
+    uint32_t getArcTarget(uint32_t arc) const { return targetData[arc]; }
+    double getArcWeight(uint32_t arc) const { return weightData[arc]; }
+
+    // Raw arrays for tight loops
+    const uint32_t* getOffsets() const { return offsetData; }
+    const uint32_t* getTargets() const { return targetData; }
+    const double* getWeights() const { return weightData; }
+
+    SampleVertex* getVertex(uint32_t id) const { return id < vertices.size() ? vertices[id] : nullptr; }
+    const std::vector<SampleVertex*>& getVertices() const { return vertices; }
+};
+#endif
@@ -0,0 +1,21 @@
+// SampleCSVLoader.h
+#ifndef SAMPLE_CSV_LOADER_H
+#define SAMPLE_CSV_LOADER_H
+
+#include <string>
+#include "graph/SamplePositiveGraph.h"
+
+// Loads the positive graph from the two CSV exports:
+//   vertices:  name,latitude,longitude,mapRow,mapCol,type
+//   distances: from,to,distance
+// Both files start with a header line. The files are memory-mapped and
+// scanned in place; a first pass counts the rows so the vertex and edge
+// storage is sized once. Lines may end in CRLF and fields may carry
+// surrounding spaces; blank lines are skipped, as are distance rows naming
+// unknown vertices. Any other malformed line throws std::runtime_error with
+// a "file:line: problem" message.
+class SampleCSVLoader {
+public:
+    static SamplePositiveGraph* loadPositiveGraph(const std::string& verticesFile, const std::string& distancesFile);
+};
+#endif
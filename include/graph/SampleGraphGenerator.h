@@ -0,0 +1,51 @@
+// SampleGraphGenerator.h
+#ifndef SAMPLE_GRAPH_GENERATOR_H
+#define SAMPLE_GRAPH_GENERATOR_H
+
+#include <string>
+#include <cstdint>
+#include "graph/SamplePositiveGraph.h"
+
+// Shape of a synthetic road network
+enum class SampleMapLayout {
+    Grid,     // street grid with jittered intersections, missing blocks and diagonals
+    Geometric // random points joined to every neighbour within a radius
+};
+
+// Synthetic maps for scaling tests. Vertices get latitude and longitude
+// around an origin, a map cell, and a type; edge weights are the road
+// length in km between the endpoints, stretched a little to model detours.
+// The same options and seed always give the same map.
+//
+// Names follow the pipeline's conventions: the first garage is "Garage"
+// (createNegativeGraph looks it up by name), further ones "Garage2", ...;
+// pickups are "P<id>", dropoffs "D<id>" and plain intersections "V<id>".
+// Coordinates are rounded to 6 and weights to 3 decimals, so a map written
+// with writeCSV loads back with exactly the same numbers.
+class SampleGraphGenerator {
+public:
+    struct Options {
+        SampleMapLayout layout;
+        uint32_t vertexCount;
+        double pickupShare;    // fraction of vertices that are pickups
+        double dropoffShare;   // fraction of vertices that are dropoffs
+        double garageShare;    // fraction of vertices that are garages, at least one
+        double spacingKm;      // mean distance between neighbouring intersections
+        double originLatitude; // south-west corner of the map
+        double originLongitude;
+        unsigned seed;
+
+        Options(); // 1000-vertex grid, 2% pickups, 2% dropoffs, one garage
+    };
+
+    static SamplePositiveGraph* generate(const Options& options);
+
+    // Writes graph in the format SampleCSVLoader reads (both with a header
+    // line); throws std::runtime_error if a file cannot be written
+    static void writeCSV(SamplePositiveGraph* graph, const std::string& verticesFile, const std::string& distancesFile);
+
+    // "grid" or "geometric"; false for anything else
+    static bool parseLayout(const std::string& text, SampleMapLayout& layout);
+    static const char* layoutName(SampleMapLayout layout);
+};
+#endif
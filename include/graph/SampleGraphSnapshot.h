@@ -0,0 +1,90 @@
+// SampleGraphSnapshot.h
+#ifndef SAMPLE_GRAPH_SNAPSHOT_H
+#define SAMPLE_GRAPH_SNAPSHOT_H
+
+#include <string>
+#include <cstdint>
+#include "graph/SamplePositiveGraph.h"
+#include "graph/SampleCSRGraph.h"
+#include "util/SampleMappedFile.h"
+#include "util/SampleThreadPool.h"
+
+// Versioned binary image of the positive graph that is used straight from
+// a memory mapping. The file holds, each section 8-byte aligned:
+//   header       magic, format version, counts, section offsets, source
+//                fingerprints and a checksum over everything after it
+//   vertices     coordinates, map cell and the name/type string of each id
+//   strings      vertex names and (deduplicated) types
+//   name slots   open-addressing table name -> id for findVertex
+//   CSR arrays   offsets, targets and weights of the undirected graph
+//   matrix       optional pickup x dropoff shortest distances
+// Opening checks the header and checksum and then only sets pointers, so
+// getGraph() can be queried in milliseconds however large the map is.
+class SampleGraphSnapshot {
+public:
+    static const uint32_t FORMAT_VERSION = 1;
+    static const uint32_t NO_VERTEX = 0xFFFFFFFFu;
+
+    struct Header;
+    struct VertexRecord;
+
+private:
+    SampleMappedFile file;
+    const Header* header;
+    const VertexRecord* vertexRecords;
+    const char* strings;
+    const uint32_t* nameSlots;
+    const uint32_t* matrixIndex; // per vertex: its row or column in the matrix
+    const uint32_t* pickups;
+    const uint32_t* dropoffs;
+    const double* matrix;
+    SampleCSRGraph* graph;
+
+    SampleGraphSnapshot(const SampleGraphSnapshot&);
+    SampleGraphSnapshot& operator=(const SampleGraphSnapshot&);
+
+public:
+    // Maps and validates the file; throws std::runtime_error if it is not a
+    // snapshot, has another format version, or fails the checksum
+    SampleGraphSnapshot(const std::string& path, bool verifyChecksum = true);
+    ~SampleGraphSnapshot();
+
+    uint32_t getVertexCount() const;
+    std::string getName(uint32_t id) const;
+    std::string getType(uint32_t id) const;
+    SampleVertexType getVertexType(uint32_t id) const;
+    double getLatitude(uint32_t id) const;
+    double getLongitude(uint32_t id) const;
+    int getMapRow(uint32_t id) const;
+    int getMapCol(uint32_t id) const;
+    uint32_t findVertex(const std::string& name) const; // NO_VERTEX if unknown
+
+    // Undirected CSR view over the mapped arrays; it has no vertex objects
+    const SampleCSRGraph* getGraph() const { return graph; }
+
+    bool hasMatrix() const;
+    uint32_t getPickupCount() const;
+    uint32_t getDropoffCount() const;
+    const uint32_t* getPickups() const { return pickups; }
+    const uint32_t* getDropoffs() const { return dropoffs; }
+    // Stored distance between a pickup and a dropoff by vertex id, max() if
+    // there is no matrix or the ids are not a pickup and a dropoff
+    double getMatrixDistance(uint32_t pickupId, uint32_t dropoffId) const;
+
+    // True if either CSV file differs from the one the snapshot was built
+    // from. Size and modification time are compared first; only when the
+    // time moved is the file hashed against the stored checksum. Missing
+    // files count as unchanged.
+    bool isStale(const std::string& verticesFile, const std::string& distancesFile) const;
+
+    // Rebuilds the object graph (same vertex ids) for code that needs it
+    SamplePositiveGraph* toPositiveGraph() const;
+
+    // Converter: writes graph to path (through a temporary file and a
+    // rename), stamped with the CSV files it came from. withMatrix stores
+    // the pickup x dropoff distances, computed on pool when given.
+    static void write(const std::string& path, SamplePositiveGraph* graph,
+                      const std::string& verticesFile, const std::string& distancesFile,
+                      bool withMatrix, SampleThreadPool* pool = nullptr);
+};
+#endif
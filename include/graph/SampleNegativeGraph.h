@@ -4,20 +4,55 @@
 
 #include <unordered_map>
 #include <string>
+#include <vector>
 #include "SampleVertex.h"
 #include "SampleEdge.h"
+#include "SampleCSRGraph.h"
+#include "SamplePositiveGraph.h"
+#include "util/SampleArena.h"
+
+// Directed profit graph laid over the vertices of a SamplePositiveGraph.
+// It has no vertices of its own: vertex ids, names and every vertex
+// lookup are those of the base graph, and only the edges are stored here,
+// apart from the vertices' (positive) neighbour lists. The base graph must
+// outlive the overlay; vertices added to it later join the overlay too.
 class SampleNegativeGraph {
 private:
-    std::unordered_map<std::string, SampleVertex*> vertices;
+    SamplePositiveGraph* base; // not owned
+    SampleArena arena; // the edges
+    std::vector<std::vector<SampleEdge*> > outgoing; // by vertex id
+    std::vector<SampleEdge*> noEdges;
+    unsigned long version; // bumped on every modification
+    SampleCSRGraph* frozen; // cached snapshot, rebuilt when stale
+    unsigned long frozenVersion;
+
+    SampleNegativeGraph(const SampleNegativeGraph&);
+    SampleNegativeGraph& operator=(const SampleNegativeGraph&);
 
 public:
-    SampleNegativeGraph();
+    static const uint32_t NO_VERTEX = SamplePositiveGraph::NO_VERTEX;
+
+    SampleNegativeGraph(SamplePositiveGraph* base);
     ~SampleNegativeGraph();
     
-    void addVertex(SampleVertex* vertex);
+    void addEdge(uint32_t fromId, uint32_t toId, double weight);
+    // By name; does nothing if either vertex is missing
     void addEdge(const std::string& fromName, const std::string& toName, double weight);
+    // Edges of the overlay leaving a vertex
+    const std::vector<SampleEdge*>& getOutgoing(uint32_t id) const {
+        return id < outgoing.size() ? outgoing[id] : noEdges;
+    }
+    
+    SamplePositiveGraph* getBase() const { return base; }
+    const std::unordered_map<std::string, SampleVertex*>& getAllVertices() const { return base->getAllVertices(); }
+    const std::vector<SampleVertex*>& getVertexList() const { return base->getVertexList(); }
+    SampleVertex* getVertexByName(const std::string& name) const { return base->getVertexByName(name); }
+    SampleVertex* getVertex(uint32_t id) const { return base->getVertex(id); }
+    uint32_t findVertexId(const std::string& name) const { return base->findVertexId(name); }
+    unsigned long getVersion() const { return version; }
     
-    const std::unordered_map<std::string, SampleVertex*>& getAllVertices() const { return vertices; }
-    SampleVertex* getVertexByName(const std::string& name) const;
+    // Directed CSR snapshot, owned by the graph and rebuilt after changes
+    // here or new vertices in the base graph
+    const SampleCSRGraph* freeze();
 };
-#endif
\ No newline at end of file
+#endif
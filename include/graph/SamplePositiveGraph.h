@@ -4,21 +4,53 @@
 
 #include <unordered_map>
 #include <string>
+#include <vector>
 #include "SampleVertex.h"
 #include "SampleEdge.h"
+#include "SampleCSRGraph.h"
+#include "util/SampleNameTable.h"
+#include "util/SampleArena.h"
 
 class SamplePositiveGraph {
 private:
-    std::unordered_map<std::string, SampleVertex*> vertices;
+    std::unordered_map<std::string, SampleVertex*> vertices; // iteration view for getAllVertices
+    std::vector<SampleVertex*> vertexList; // indexed by vertex id
+    SampleNameTable names; // name -> vertex id, the ids match vertexList
+    SampleArena arena; // every edge, and the vertices made by createVertex
+    std::vector<bool> inArena; // by vertex id: allocated in the arena, not with new
+    unsigned long version; // bumped on every modification
+    SampleCSRGraph* frozen; // cached snapshot, rebuilt when stale
+    unsigned long frozenVersion;
+
+    void insertVertex(SampleVertex* vertex, bool allocatedInArena);
 
 public:
+    static const uint32_t NO_VERTEX = SampleNameTable::NO_NAME;
+
     SamplePositiveGraph();
     ~SamplePositiveGraph();
     
+    // Takes ownership of a vertex allocated with new
     void addVertex(SampleVertex* vertex);
+    // Allocates the vertex in the graph's arena and adds it
+    SampleVertex* createVertex(const std::string& name);
+    // Room for vertexCount vertices and edgeCount edges, e.g. before a bulk load
+    void reserve(size_t vertexCount, size_t edgeCount = 0);
     void addEdge(SampleVertex* from, SampleVertex* to, double weight);
+    void addEdge(uint32_t fromId, uint32_t toId, double weight);
     
     const std::unordered_map<std::string, SampleVertex*>& getAllVertices() const { return vertices; }
+    const std::vector<SampleVertex*>& getVertexList() const { return vertexList; }
     SampleVertex* getVertexByName(const std::string& name) const;
+    SampleVertex* getVertex(uint32_t id) const { return vertexList[id]; }
+    // Id of the named vertex, NO_VERTEX if there is none
+    uint32_t findVertexId(const std::string& name) const { return names.find(name); }
+    uint32_t findVertexId(const char* begin, const char* end) const { return names.find(begin, end); }
+    unsigned long getVersion() const { return version; }
+
+    // Returns a read-only CSR snapshot of the graph. The snapshot is owned by
+    // the graph and rebuilt on the next call after addVertex/addEdge.
+    // Not thread-safe: freeze before handing the snapshot to other threads.
+    const SampleCSRGraph* freeze();
 };
-#endif
\ No newline at end of file
+#endif
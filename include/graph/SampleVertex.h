@@ -5,17 +5,20 @@
 #include <string>
 #include <vector>
 #include <limits>
+#include <cstdint>
+#include "SampleVertexType.h"
 
 class SampleEdge;
 
 class SampleVertex {
 private:
     std::string name;
+    uint32_t id; // dense index assigned by the owning graph
     double latitude;
     double longitude;
     int mapRow;
     int mapCol;
-    std::string type; // "normal", "pickup", "dropoff", "garage"
+    SampleVertexType type;
     int status; // 0 = unvisited, 1 = visited
     double distance;
     SampleVertex* parent;
@@ -26,9 +29,12 @@ public:
     ~SampleVertex();
     
     void addNeighbor(SampleEdge* edge);
+    void reserveNeighbors(size_t count) { neighbors.reserve(count); }
     
     // Getters and setters
-    std::string getName() const { return name; }
+    const std::string& getName() const { return name; }
+    uint32_t getId() const { return id; }
+    void setId(uint32_t id) { this->id = id; }
     double getLatitude() const { return latitude; }
     void setLatitude(double lat) { this->latitude = lat; }
     double getLongitude() const { return longitude; }
@@ -37,8 +43,11 @@ public:
     void setMapRow(int row) { this->mapRow = row; }
     int getMapCol() const { return mapCol; }
     void setMapCol(int col) { this->mapCol = col; }
-    std::string getType() const { return type; }
-    void setType(const std::string& type) { this->type = type; }
+    SampleVertexType getVertexType() const { return type; }
+    void setVertexType(SampleVertexType type) { this->type = type; }
+    // String form of the type ("normal", "pickup", "dropoff", "garage")
+    std::string getType() const { return sampleVertexTypeName(type); }
+    void setType(const std::string& type) { this->type = sampleParseVertexType(type); }
     int getStatus() const { return status; }
     void setStatus(int status) { this->status = status; }
     double getDistance() const { return distance; }
@@ -0,0 +1,40 @@
+// SampleVertexType.h
+#ifndef SAMPLE_VERTEX_TYPE_H
+#define SAMPLE_VERTEX_TYPE_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Role of a place in the delivery problem, parsed once from the CSV type
+// column; the strings are only produced again for output
+enum class SampleVertexType : uint8_t {
+    Normal = 0,
+    Pickup = 1,
+    Dropoff = 2,
+    Garage = 3
+};
+
+inline const char* sampleVertexTypeName(SampleVertexType type) {
+    switch (type) {
+    case SampleVertexType::Pickup: return "pickup";
+    case SampleVertexType::Dropoff: return "dropoff";
+    case SampleVertexType::Garage: return "garage";
+    default: return "normal";
+    }
+}
+
+// "pickup", "dropoff" and "garage" map to their type, anything else is a
+// normal place (as it was when types were compared as strings)
+inline SampleVertexType sampleParseVertexType(const char* begin, const char* end) {
+    size_t length = static_cast<size_t>(end - begin);
+    if (length == 6 && std::memcmp(begin, "pickup", 6) == 0) return SampleVertexType::Pickup;
+    if (length == 7 && std::memcmp(begin, "dropoff", 7) == 0) return SampleVertexType::Dropoff;
+    if (length == 6 && std::memcmp(begin, "garage", 6) == 0) return SampleVertexType::Garage;
+    return SampleVertexType::Normal;
+}
+
+inline SampleVertexType sampleParseVertexType(const std::string& text) {
+    return sampleParseVertexType(text.data(), text.data() + text.size());
+}
+#endif
@@ -0,0 +1,157 @@
+// SampleQueryServer.h
+#ifndef SAMPLE_QUERY_SERVER_H
+#define SAMPLE_QUERY_SERVER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include "algorithm/SampleQueryContext.h"
+#include "util/SampleJSON.h"
+#include "util/SampleThreadPool.h"
+
+// Daemon mode: loads the map once and answers line-delimited JSON requests
+// over stdin/stdout or a Unix-domain socket, one JSON object per line each
+// way. Every request may carry an "id", echoed in its response; responses
+// come in completion order, so clients that pipeline should set one.
+//
+//   {"op":"distance","from":A,"to":B}         -> {"distance":d}
+//   {"op":"path","from":A,"to":B}             -> {"distance":d,"path":[...]}
+//   {"op":"matrix","sources":[...],"targets":[...]} -> {"distances":[[...]]}
+//   {"op":"plan"[,"trucks":k]}                -> the delivery cycle of main():
+//                                                stops, profit, legs, costs;
+//                                                with trucks, the k best
+//                                                disjoint cycles through the garage;
+//                                                with "budget_ms":t, the cycle's
+//                                                stops in a shorter order found
+//                                                within t milliseconds
+//   {"op":"reload"}                           -> {"version":n,...}
+//   {"op":"info"}                             -> map size, version, requests served,
+//                                                hierarchy shortcuts
+//   {"op":"shutdown"}                         -> stops the server
+//
+// Places are vertex names or numeric ids; unreachable distances are null.
+// Distances, paths and the legs of plans come from a contraction hierarchy
+// on maps of up to 20,000 vertices, built with the model (some seconds at
+// that size). Larger maps, which would take minutes, use A* steered by the
+// great-circle distance to the target (plain Dijkstra on maps where some
+// road is shorter than that).
+// Failures answer {"ok":false,"error":"..."} and the server carries on.
+//
+// Requests are read as they arrive and queued. The dispatcher posts each
+// one to the thread pool as a task of its own, searched in its worker's
+// workspace, and goes straight back to the queue, so requests pipelined on
+// one connection or sent on many run concurrently and a slow plan holds up
+// only the worker it runs on. File watching and shutdown stay on the
+// dispatcher; on shutdown the requests already taken are answered first.
+//
+// The map is read from the CSV files, or mapped from a binary snapshot
+// (--convert-snapshot) when one is given and not stale. Distance, path and
+// matrix requests search the snapshot's CSR arrays in place; the vertex
+// objects and the profit graph that plan requests walk are only built
+// from it on the first plan request, so a large map is served as soon as
+// it is mapped. A snapshot that cannot be used falls back to the CSV files.
+//
+// The map (positive graph, profit graph and their frozen snapshots) is an
+// immutable model behind a shared pointer. Each request takes a reference
+// to the current model when it starts; a reload builds a whole new model
+// on the side and swaps the pointer, so requests in flight finish on the
+// map they started with and the old model is freed after the last one.
+// Reloads happen on request, and when the map files change: the files are
+// checked every watch interval and reloaded once their size and
+// modification time hold still for one interval, so a half-written file is
+// not picked up (writers should still prefer write-then-rename).
+class SampleQueryServer {
+private:
+    struct Model;
+    struct Connection;
+    struct Pending {
+        std::shared_ptr<Connection> connection;
+        std::string line;
+    };
+    // Search state of one worker: the context of most searches, and the
+    // backward side of the contraction hierarchy queries
+    struct Workspace {
+        SampleQueryContext context;
+        SampleQueryContext backward;
+    };
+    struct FileStamp {
+        int64_t size;
+        int64_t modified;
+        bool operator==(const FileStamp& other) const { return size == other.size && modified == other.modified; }
+    };
+
+    std::string snapshotFile; // empty: the CSV files
+    std::string verticesFile;
+    std::string distancesFile;
+    SampleThreadPool& pool;
+    std::vector<std::unique_ptr<Workspace> > workspaces; // by worker
+
+    std::shared_ptr<const Model> model; // accessed with std::atomic_load/store
+    std::mutex reloadLock;              // one model build at a time
+    unsigned long nextVersion;          // guarded by reloadLock
+
+    // Request queue, guarded by queueLock
+    std::mutex queueLock;
+    std::condition_variable queueReady;
+    std::vector<Pending> queue;
+    unsigned openReaders;
+    bool stopping;
+    std::atomic<unsigned long> served;
+
+    // File watching, only touched by the dispatching thread
+    double watchSeconds;
+    std::chrono::steady_clock::time_point nextWatch;
+    std::vector<FileStamp> pendingStamps; // last change seen, reloaded once it holds still
+    std::vector<FileStamp> failedStamps;  // files that failed to load, not retried until they change
+    std::thread reloadThread;
+    std::atomic<bool> reloading;
+
+    void start();
+    std::shared_ptr<const Model> buildModel(SampleThreadPool* buildPool);
+    std::vector<FileStamp> stampFiles() const;
+    void watchFiles();
+
+    void readLoop(std::shared_ptr<Connection> connection);
+    void startReader(const std::shared_ptr<Connection>& connection);
+    void dispatchLoop(bool untilInputEnds);
+    void reply(Connection& connection, const std::string& line);
+    void stop();
+
+    std::string handle(const std::string& line, Workspace& workspace);
+    void answer(const SampleJSONValue& request, const Model& model, Workspace& workspace, std::ostream& out);
+
+    SampleQueryServer(const SampleQueryServer&);
+    SampleQueryServer& operator=(const SampleQueryServer&);
+
+public:
+    // Loads the map (throws std::runtime_error if the files cannot be
+    // read); watchSeconds 0 turns the file watching off
+    SampleQueryServer(const std::string& verticesFile, const std::string& distancesFile,
+                      SampleThreadPool& pool, double watchSeconds = 1.0);
+    // Maps the snapshot instead, unless it is unusable or stale against
+    // the CSV files, which are then read
+    SampleQueryServer(const std::string& snapshotFile, const std::string& verticesFile,
+                      const std::string& distancesFile, SampleThreadPool& pool, double watchSeconds = 1.0);
+    ~SampleQueryServer();
+
+    // Loads the map files again and swaps the new model in; on failure
+    // throws and keeps serving the old one. Returns the new version.
+    unsigned long reload();
+
+    // Serves requests read from inputFd, answering on outputFd, until the
+    // input ends (after answering everything read) or a shutdown request
+    void serveStream(int inputFd, int outputFd);
+    // Serves connections on a Unix-domain socket at path until a shutdown
+    // request, SIGINT or SIGTERM; throws if the socket cannot be set up
+    void serveSocket(const std::string& path);
+
+    // Answers one request line; the response is one line without the newline
+    std::string handle(const std::string& line);
+};
+#endif
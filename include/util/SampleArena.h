@@ -0,0 +1,59 @@
+// SampleArena.h
+#ifndef SAMPLE_ARENA_H
+#define SAMPLE_ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Bump-pointer allocator for objects that live exactly as long as their
+// owner (the vertices and edges of a graph). Memory comes from chunks that
+// double in size up to MAX_CHUNK_SIZE, so objects allocated one after the
+// other sit next to each other. Nothing is freed individually: destroying
+// the arena releases every chunk at once and runs no destructors, so
+// owners must destroy objects that hold resources themselves.
+class SampleArena {
+public:
+    static const size_t FIRST_CHUNK_SIZE = 4096;
+    static const size_t MAX_CHUNK_SIZE = 1 << 20;
+
+private:
+    std::vector<char*> chunks;
+    char* cursor;
+    char* limit;
+    size_t nextChunkSize;
+    size_t bytesAllocated;
+
+    void* allocateSlow(size_t size, size_t alignment);
+
+    SampleArena(const SampleArena&);
+    SampleArena& operator=(const SampleArena&);
+
+public:
+    SampleArena();
+    ~SampleArena();
+
+    // size bytes aligned to alignment (a power of two, at most that of
+    // std::max_align_t)
+    void* allocate(size_t size, size_t alignment) {
+        char* aligned = reinterpret_cast<char*>((reinterpret_cast<size_t>(cursor) + alignment - 1) & ~(alignment - 1));
+        if (cursor == nullptr || aligned + size > limit) return allocateSlow(size, alignment);
+        cursor = aligned + size;
+        bytesAllocated += size;
+        return aligned;
+    }
+
+    // Constructs a T in the arena
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // Sizes the next chunk for at least bytes more, e.g. before a bulk load
+    void reserve(size_t bytes);
+
+    size_t getChunkCount() const { return chunks.size(); }
+    size_t getBytesAllocated() const { return bytesAllocated; }
+};
+#endif
@@ -0,0 +1,198 @@
+// SampleCSVScanner.h
+#ifndef SAMPLE_CSV_SCANNER_H
+#define SAMPLE_CSV_SCANNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <limits>
+
+// A field of the current line, pointing into the scanned buffer
+struct SampleCSVField {
+    const char* begin;
+    const char* end;
+
+    size_t length() const { return static_cast<size_t>(end - begin); }
+    std::string toString() const { return std::string(begin, end); }
+};
+
+// Line and field scanner over an in-memory CSV buffer (no quoting). Lines
+// end in LF or CRLF, fields are split on commas and trimmed of surrounding
+// spaces and tabs. Nothing is copied; fields point into the buffer.
+class SampleCSVScanner {
+private:
+    const char* cursor;
+    const char* bufferEnd;
+    const char* lineBegin;
+    const char* lineEnd;
+    size_t lineNumber;
+
+    static bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+public:
+    SampleCSVScanner(const char* begin, const char* end)
+        : cursor(begin), bufferEnd(end), lineBegin(begin), lineEnd(begin), lineNumber(0) {}
+
+    // Advances to the next line; false once the buffer is exhausted
+    bool nextLine() {
+        if (cursor >= bufferEnd) return false;
+        lineBegin = cursor;
+        const char* newline = static_cast<const char*>(std::memchr(cursor, '\n', bufferEnd - cursor));
+        lineEnd = newline != nullptr ? newline : bufferEnd;
+        cursor = newline != nullptr ? newline + 1 : bufferEnd;
+        while (lineEnd > lineBegin && isBlank(lineEnd[-1])) lineEnd--; // CR and trailing spaces
+        lineNumber++;
+        return true;
+    }
+
+    // 1-based number of the current line
+    size_t getLineNumber() const { return lineNumber; }
+    bool isBlankLine() const {
+        for (const char* p = lineBegin; p < lineEnd; p++) {
+            if (!isBlank(*p)) return false;
+        }
+        return true;
+    }
+
+    // Splits the current line into at most maxFields trimmed fields and
+    // returns how many fields the line really has
+    size_t splitFields(SampleCSVField* fields, size_t maxFields) const {
+        size_t count = 0;
+        const char* p = lineBegin;
+        while (true) {
+            const char* comma = static_cast<const char*>(std::memchr(p, ',', lineEnd - p));
+            const char* fieldEnd = comma != nullptr ? comma : lineEnd;
+            if (count < maxFields) {
+                const char* b = p;
+                const char* e = fieldEnd;
+                while (b < e && isBlank(*b)) b++;
+                while (e > b && isBlank(e[-1])) e--;
+                fields[count].begin = b;
+                fields[count].end = e;
+            }
+            count++;
+            if (comma == nullptr) return count;
+            p = comma + 1;
+        }
+    }
+
+    // Number of lines in a buffer, for sizing storage before parsing
+    static size_t countLines(const char* begin, const char* end) {
+        size_t count = 0;
+        for (const char* p = begin; p < end; ) {
+            const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            count++;
+            if (newline == nullptr) break;
+            p = newline + 1;
+        }
+        return count;
+    }
+
+    // Parses the whole field as a decimal number in the style of
+    // std::from_chars: no locale, no leading spaces, false on any leftover
+    // characters. Up to 19 significant digits and powers of ten up to 22
+    // convert exactly with one multiplication or division; longer numbers
+    // fall back to strtod.
+    static bool parseDouble(const char* begin, const char* end, double& value) {
+        static const double POWERS[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+        const char* p = begin;
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative = *p == '-';
+            p++;
+        }
+        uint64_t mantissa = 0;
+        int digits = 0;     // significant digits kept in mantissa
+        int exponent = 0;   // power of ten to apply to mantissa
+        bool anyDigit = false;
+        bool exact = true;  // false when digits had to be dropped
+        for (; p < end && *p >= '0' && *p <= '9'; p++) {
+            anyDigit = true;
+            if (digits < 19) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                if (mantissa != 0) digits++;
+            } else {
+                exponent++;
+                exact = false;
+            }
+        }
+        if (p < end && *p == '.') {
+            for (p++; p < end && *p >= '0' && *p <= '9'; p++) {
+                anyDigit = true;
+                if (digits < 19) {
+                    mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                    if (mantissa != 0) digits++;
+                    exponent--;
+                } else {
+                    exact = false;
+                }
+            }
+        }
+        if (!anyDigit) return false;
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            p++;
+            bool negativeExponent = false;
+            if (p < end && (*p == '-' || *p == '+')) {
+                negativeExponent = *p == '-';
+                p++;
+            }
+            if (p == end || *p < '0' || *p > '9') return false;
+            int written = 0;
+            for (; p < end && *p >= '0' && *p <= '9'; p++) {
+                if (written < 100000) written = written * 10 + (*p - '0');
+            }
+            exponent += negativeExponent ? -written : written;
+        }
+        if (p != end) return false;
+
+        if (exact && mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22) {
+            double result = static_cast<double>(mantissa);
+            result = exponent < 0 ? result / POWERS[-exponent] : result * POWERS[exponent];
+            value = negative ? -result : result;
+            return true;
+        }
+
+        // Rare: let the C library round long or extreme numbers
+        char local[64];
+        std::string heap;
+        const char* text = local;
+        size_t length = static_cast<size_t>(end - begin);
+        if (length < sizeof(local)) {
+            std::memcpy(local, begin, length);
+            local[length] = '\0';
+        } else {
+            heap.assign(begin, end);
+            text = heap.c_str();
+        }
+        char* parsedEnd = nullptr;
+        value = std::strtod(text, &parsedEnd);
+        return parsedEnd == text + length;
+    }
+
+    // Parses the whole field as a decimal int; false on junk or overflow
+    static bool parseInt(const char* begin, const char* end, int& value) {
+        const char* p = begin;
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative = *p == '-';
+            p++;
+        }
+        if (p == end) return false;
+        int64_t result = 0;
+        for (; p < end; p++) {
+            if (*p < '0' || *p > '9') return false;
+            result = result * 10 + (*p - '0');
+            if (result > static_cast<int64_t>(std::numeric_limits<int>::max()) + 1) return false;
+        }
+        if (negative) result = -result;
+        if (result > std::numeric_limits<int>::max() || result < std::numeric_limits<int>::min()) return false;
+        value = static_cast<int>(result);
+        return true;
+    }
+};
+#endif
@@ -0,0 +1,40 @@
+// SampleChecksum.h
+#ifndef SAMPLE_CHECKSUM_H
+#define SAMPLE_CHECKSUM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// 64-bit non-cryptographic checksum that consumes eight bytes per step, fast
+// enough to run over a whole snapshot or CSV export at startup. Catches
+// truncation, stray edits and stale files, not deliberate tampering.
+inline uint64_t sampleChecksum(const void* data, size_t size, uint64_t seed = 0) {
+    const uint64_t MULTIPLIER = 0x9E3779B97F4A7C15ULL;
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed ^ (size * MULTIPLIER);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, 8); // unaligned-safe load
+        hash = (hash ^ word) * MULTIPLIER;
+        hash ^= hash >> 29;
+    }
+    uint64_t tail = 0;
+    for (size_t shift = 0; i < size; i++, shift += 8) {
+        tail |= static_cast<uint64_t>(bytes[i]) << shift;
+    }
+    hash = (hash ^ tail) * MULTIPLIER;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+// FNV-1a over a byte range, for hashing vertex names in lookup tables
+inline uint64_t sampleNameHash(const char* begin, const char* end) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (const char* p = begin; p < end; p++) {
+        hash = (hash ^ static_cast<unsigned char>(*p)) * 1099511628211ULL;
+    }
+    return hash;
+}
+#endif
@@ -0,0 +1,64 @@
+// SampleJSON.h
+#ifndef SAMPLE_JSON_H
+#define SAMPLE_JSON_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <ostream>
+
+enum class SampleJSONType {
+    Null,
+    Bool,
+    Number,
+    String,
+    Array,
+    Object
+};
+
+// Just enough JSON for the reports and the query server's line protocol:
+// a parsed value tree, and writers for strings and numbers. Objects keep
+// their members in input order; with repeated keys find() returns the first.
+class SampleJSONValue {
+private:
+    SampleJSONType type;
+    bool boolean;
+    double number;
+    std::string text;
+    std::vector<SampleJSONValue> items;                            // Array
+    std::vector<std::pair<std::string, SampleJSONValue> > members; // Object
+
+    class Parser;
+
+public:
+    SampleJSONValue();
+
+    SampleJSONType getType() const { return type; }
+    bool isNull() const { return type == SampleJSONType::Null; }
+    bool isNumber() const { return type == SampleJSONType::Number; }
+    bool isString() const { return type == SampleJSONType::String; }
+    bool isArray() const { return type == SampleJSONType::Array; }
+    bool isObject() const { return type == SampleJSONType::Object; }
+
+    bool getBool() const { return boolean; }
+    double getNumber() const { return number; }
+    const std::string& getString() const { return text; }
+    const std::vector<SampleJSONValue>& getItems() const { return items; }
+
+    // Member of an object, nullptr if absent or not an object
+    const SampleJSONValue* find(const std::string& key) const;
+
+    // Parses one complete value (surrounding white space allowed); throws
+    // std::runtime_error naming the offset of the first problem
+    static SampleJSONValue parse(const std::string& text);
+
+    // Writes the value back as compact JSON
+    void write(std::ostream& out) const;
+
+    // Quoted and escaped string
+    static void writeString(std::ostream& out, const std::string& text);
+    // Shortest form that reads back as the same double; null for NaN and
+    // infinities, which JSON cannot express
+    static void writeNumber(std::ostream& out, double value);
+};
+#endif
@@ -0,0 +1,33 @@
+// SampleMappedFile.h
+#ifndef SAMPLE_MAPPED_FILE_H
+#define SAMPLE_MAPPED_FILE_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// Read-only view of a whole file. On POSIX systems the file is mapped into
+// memory, so parsing reads straight from the page cache without copies;
+// elsewhere it is read into a buffer once. Throws std::runtime_error if the
+// file cannot be opened or mapped.
+class SampleMappedFile {
+private:
+    std::string path;
+    const char* data;
+    size_t size;
+    void* mapping;            // mmap base, nullptr when buffered or empty
+    std::vector<char> buffer; // fallback storage
+
+    SampleMappedFile(const SampleMappedFile&);
+    SampleMappedFile& operator=(const SampleMappedFile&);
+
+public:
+    SampleMappedFile(const std::string& path);
+    ~SampleMappedFile();
+
+    const std::string& getPath() const { return path; }
+    const char* begin() const { return data; }
+    const char* end() const { return data + size; }
+    size_t getSize() const { return size; }
+};
+#endif
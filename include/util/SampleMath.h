@@ -0,0 +1,42 @@
+// SampleMath.h
+#ifndef SAMPLE_MATH_H
+#define SAMPLE_MATH_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+const double SAMPLE_PI = 3.14159265358979323846;
+const double SAMPLE_DEGREES_TO_RADIANS = SAMPLE_PI / 180.0;
+
+// Route improvements gaining less than this are rounding noise
+const double SAMPLE_MIN_GAIN = 1e-9;
+
+// Leg lengths use max() (or infinity) for a place that cannot be reached
+inline bool sampleIsReachable(double length) {
+    return std::isfinite(length) && length != std::numeric_limits<double>::max();
+}
+
+// Gives every unreachable leg of a side x side row-major matrix one length
+// that is more than a route of reachable legs can cost, so route searches
+// get rid of such legs whenever they can and their sums stay finite
+inline void samplePenalizeUnreachable(std::vector<double>& legs, size_t side) {
+    double penalty = 1.0;
+    for (size_t from = 0; from < side; from++) {
+        double longest = 0.0;
+        for (size_t to = 0; to < side; to++) {
+            if (sampleIsReachable(legs[from * side + to])) {
+                longest = std::max(longest, legs[from * side + to]);
+            }
+        }
+        penalty += 2.0 * longest;
+    }
+    for (double& length : legs) {
+        if (!sampleIsReachable(length)) {
+            length = penalty;
+        }
+    }
+}
+#endif
@@ -0,0 +1,53 @@
+// SampleNameTable.h
+#ifndef SAMPLE_NAME_TABLE_H
+#define SAMPLE_NAME_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "util/SampleChecksum.h"
+
+// Interns strings as dense ids 0, 1, 2, ... in first-seen order. Lookups
+// take a character range, so callers holding a slice of a buffer need not
+// build a std::string; the table keeps its own copy of each name.
+class SampleNameTable {
+public:
+    static const uint32_t NO_NAME = 0xFFFFFFFFu;
+
+private:
+    std::vector<std::string> names; // by id
+    std::vector<uint32_t> slots;    // open addressing, NO_NAME when empty
+    size_t mask;
+
+    size_t findSlot(const char* begin, const char* end) const {
+        size_t length = static_cast<size_t>(end - begin);
+        for (size_t slot = static_cast<size_t>(sampleNameHash(begin, end)) & mask; ; slot = (slot + 1) & mask) {
+            uint32_t id = slots[slot];
+            if (id == NO_NAME) return slot;
+            const std::string& name = names[id];
+            if (name.size() == length && std::memcmp(name.data(), begin, length) == 0) return slot;
+        }
+    }
+
+    void rehash(size_t slotCount);
+
+public:
+    SampleNameTable();
+
+    // Room for count names without rehashing
+    void reserve(size_t count);
+
+    // Id of the name, adding it with the next id if it is new
+    uint32_t intern(const char* begin, const char* end);
+    uint32_t intern(const std::string& name) { return intern(name.data(), name.data() + name.size()); }
+
+    // NO_NAME if the name was never interned
+    uint32_t find(const char* begin, const char* end) const { return slots[findSlot(begin, end)]; }
+    uint32_t find(const std::string& name) const { return find(name.data(), name.data() + name.size()); }
+
+    const std::string& getName(uint32_t id) const { return names[id]; }
+    size_t size() const { return names.size(); }
+};
+#endif
@@ -0,0 +1,107 @@
+// SampleStats.h
+#ifndef SAMPLE_STATS_H
+#define SAMPLE_STATS_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <ostream>
+#include <cstdint>
+
+// Compile-time switch for the instrumentation, override with -DSAMPLE_STATS=0
+// to compile every counter and span below out of the build
+#ifndef SAMPLE_STATS
+#define SAMPLE_STATS 1
+#endif
+
+// Hot-path counters, summed over all threads
+enum class SampleCounter {
+    DijkstraSearches,       // kernel runs
+    DijkstraPushes,         // heap pushes, decrease-keys included
+    DijkstraStalePops,      // pops of vertices that were already settled
+    DijkstraEdgesScanned,   // arcs looked at from settled vertices
+    DijkstraSettled,        // vertices settled
+    BellmanFordRounds,      // relaxation passes (queue pops for SPFA)
+    BellmanFordRelaxations, // distances lowered
+    BellmanFordCycleWalk,   // vertices stepped through finding and extracting a cycle
+    CSVBytes,               // bytes of CSV read
+    CSVRows,                // non-blank CSV rows parsed
+    Count                   // number of counters, not a counter
+};
+
+// Run statistics: counters bumped by the search kernels and the CSV loader,
+// and named wall-clock spans with the peak resident set size at their end.
+// Nothing is recorded until enable(), so a run without a report only pays a
+// flag check per search: kernels count into locals and add them once per
+// call. Built with SAMPLE_STATS=0, the macros at the end expand to nothing.
+class SampleStats {
+public:
+    struct Span {
+        std::string name;
+        unsigned thread;         // small per-thread number, 0 for the first thread seen
+        uint64_t startMicros;    // since enable()
+        uint64_t durationMicros;
+        long peakRssKb;          // peak resident set size of the process at the end
+        std::vector<std::pair<std::string, double> > args;
+    };
+
+    static void enable();
+    static bool isEnabled();
+
+    static void add(SampleCounter counter, uint64_t amount);
+    static uint64_t get(SampleCounter counter);
+    static const char* getCounterName(SampleCounter counter); // "dijkstra.pushes", ...
+
+    static void addSpan(const Span& span);
+    static uint64_t nowMicros(); // steady clock, since enable()
+    static unsigned getThreadNumber();
+    static long getPeakRssKb();  // 0 where the platform cannot tell
+
+    // {"compiled_in", "counters": {name: value}, "spans": [...]}
+    static void writeJSON(std::ostream& out);
+    // Chrome trace-event format (chrome://tracing, Perfetto): one complete
+    // event per span, a counter track for the peak RSS and the counters'
+    // totals at the end of the run
+    static void writeChromeTrace(std::ostream& out);
+};
+
+// Times a stretch of code as one span, from construction to finish() or
+// destruction. restart() closes the current span and opens the next one,
+// for phases that follow each other in one scope.
+class SampleStatsSpan {
+private:
+    SampleStats::Span span;
+    bool open;
+
+    SampleStatsSpan(const SampleStatsSpan&);
+    SampleStatsSpan& operator=(const SampleStatsSpan&);
+
+public:
+    SampleStatsSpan(const char* name);
+    ~SampleStatsSpan();
+
+    void setArg(const char* name, double value);
+    double getSeconds() const; // elapsed so far
+    void restart(const char* name);
+    void finish();
+};
+
+#if SAMPLE_STATS
+#define SAMPLE_STATS_LOCAL(name) uint64_t name = 0
+#define SAMPLE_STATS_INC(name) (name++)
+#define SAMPLE_STATS_ADD(counter, amount) SampleStats::add(SampleCounter::counter, amount)
+#define SAMPLE_STATS_SPAN(span, name) SampleStatsSpan span(name)
+#define SAMPLE_STATS_ARG(span, name, value) span.setArg(name, value)
+#define SAMPLE_STATS_NEXT(span, name) span.restart(name)
+#define SAMPLE_STATS_END(span) span.finish()
+#else
+#define SAMPLE_STATS_LOCAL(name) ((void)0)
+#define SAMPLE_STATS_INC(name) ((void)0)
+#define SAMPLE_STATS_ADD(counter, amount) ((void)0)
+#define SAMPLE_STATS_SPAN(span, name) ((void)0)
+#define SAMPLE_STATS_ARG(span, name, value) ((void)0)
+#define SAMPLE_STATS_NEXT(span, name) ((void)0)
+#define SAMPLE_STATS_END(span) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,80 @@
+// SampleThreadPool.h
+#ifndef SAMPLE_THREAD_POOL_H
+#define SAMPLE_THREAD_POOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <deque>
+
+// Fixed set of worker threads for running independent searches in parallel.
+// run() hands the indices [0, count) out to the workers and blocks until all
+// of them are done; the worker number passed to the task lets callers keep
+// one query context per worker.
+//
+// Scheduling is work stealing: every worker starts on its own contiguous
+// block of indices and takes them from the front; a worker that runs dry
+// takes the back half of another worker's remaining block. Uneven tasks
+// (searches from a hub versus from a dead end) are balanced without all
+// workers contending on one shared counter.
+//
+// post() queues a single task for the first free worker and returns at once,
+// for callers that keep handing out work while earlier tasks still run. A
+// run() job goes ahead of queued tasks; a task already running finishes
+// first.
+class SampleThreadPool {
+private:
+    // Indices [next, end) still to run for one worker
+    struct WorkRange {
+        std::mutex lock;
+        size_t next;
+        size_t end;
+        char padding[64]; // keep neighbouring ranges off one cache line
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<WorkRange> > ranges; // by worker
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::condition_variable finished;
+
+    // Current job, guarded by mutex
+    std::function<void(size_t, unsigned)> task;
+    std::atomic<size_t> remaining; // tasks not yet finished
+    unsigned busyWorkers;
+    unsigned long jobId;
+    bool stopping;
+    std::atomic<unsigned long> steals;
+
+    // Posted tasks, guarded by mutex
+    std::deque<std::function<void(unsigned)> > posted; // not yet started
+    unsigned postedRunning;
+
+    void workerLoop(unsigned worker);
+    bool takeOwn(unsigned worker, size_t& index);
+    bool steal(unsigned worker, size_t& index);
+
+public:
+    // threadCount 0 picks std::thread::hardware_concurrency()
+    SampleThreadPool(unsigned threadCount = 0);
+    ~SampleThreadPool();
+
+    unsigned getThreadCount() const { return static_cast<unsigned>(workers.size()); }
+    // Blocks taken from another worker since the pool started
+    unsigned long getStealCount() const { return steals; }
+
+    // Calls task(index, worker) for every index in [0, count). Not re-entrant:
+    // one run() at a time, and tasks must not call run() themselves.
+    void run(size_t count, const std::function<void(size_t, unsigned)>& task);
+
+    // Queues task(worker) to run on one worker. Tasks still queued when the
+    // pool is destroyed are run before the workers stop.
+    void post(const std::function<void(unsigned)>& task);
+    // Blocks until every posted task has finished; not to be called from a task
+    void wait();
+};
+#endif
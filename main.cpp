@@ -1,60 +1,149 @@
 // main.cpp
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <vector>
 #include <cmath>
+#include <cstdlib>
+#include <fstream>
 #include <unordered_set>
+#include <memory>
 #include "graph/SampleVertex.h"
-#include "graph/SampleEdge.h"
 #include "graph/SamplePositiveGraph.h"
 #include "graph/SampleNegativeGraph.h"
+#include "graph/SampleCSRGraph.h"
+#include "graph/SampleCSVLoader.h"
+#include "graph/SampleGraphSnapshot.h"
 #include "algorithm/SampleDijkstra.h"
 #include "algorithm/SampleBellmanFord.h"
+#include "algorithm/SampleQueryContext.h"
+#include "algorithm/SampleDistanceMatrix.h"
+#include "algorithm/SampleCycleRatio.h"
+#include "algorithm/SampleQueryBatch.h"
+#include "algorithm/SampleDeliveryPlanner.h"
+#include "algorithm/SampleTourOptimizer.h"
+#include "algorithm/SampleFleetPlanner.h"
+#include "util/SampleStats.h"
+#include "server/SampleQueryServer.h"
 
 
 
 SamplePositiveGraph* loadPositiveGraphFromCSV(const std::string& verticesFile, const std::string& distancesFile);
 SamplePositiveGraph* createSamplePositiveGraph();
-SampleNegativeGraph* createNegativeGraph(SamplePositiveGraph* positiveGraph);
+SampleGraphSnapshot* openSnapshot(const std::string& path);
+int convertToSnapshot(const std::string& path, SampleThreadPool& pool);
 double calculateEuclideanDistance(SampleVertex* v1, SampleVertex* v2);
 SampleVertex* findGarageVertex(SamplePositiveGraph* graph);
-double calculateCycleProfit(const std::vector<SampleVertex*>& cycle);
-double calculateTotalDistance(SamplePositiveGraph* graph, SampleVertex* garage, const std::vector<SampleVertex*>& cycle);
-void runSimplePathAnalysis(SamplePositiveGraph* graph, SampleVertex* garage);
+void runSimplePathAnalysis(SamplePositiveGraph* graph, SampleVertex* garage, SampleThreadPool& pool);
+void writeStatsReports(const std::string& statsPath, const std::string& tracePath);
+int runServer(const std::string& socketPath, const std::string& snapshotPath, SampleThreadPool& pool);
+
+const std::string VERTICES_FILE = "data/vertices.csv";
+const std::string DISTANCES_FILE = "data/distances.csv";
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Command line options
+    std::string snapshotPath;
+    std::string convertPath;
+    std::string statsPath; // run statistics as JSON
+    std::string tracePath; // the same as a Chrome trace-event file
+    bool serve = false;    // daemon mode, on stdin/stdout unless a socket is given
+    std::string socketPath;
+    unsigned threadCount = 0; // 0: one worker per hardware thread
+    double tourBudgetMillis = 50; // for improving the visiting order
+    unsigned truckCount = 3;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 11, "--snapshot=") == 0) {
+            snapshotPath = arg.substr(11);
+        } else if (arg.compare(0, 19, "--convert-snapshot=") == 0) {
+            convertPath = arg.substr(19);
+        } else if (arg == "--serve") {
+            serve = true;
+        } else if (arg.compare(0, 8, "--serve=") == 0 && arg.size() > 8) {
+            serve = true;
+            socketPath = arg.substr(8);
+        } else if (arg.compare(0, 8, "--stats=") == 0) {
+            statsPath = arg.substr(8);
+        } else if (arg.compare(0, 8, "--trace=") == 0) {
+            tracePath = arg.substr(8);
+        } else if (arg.compare(0, 10, "--threads=") == 0 && arg.size() > 10 &&
+                   arg.find_first_not_of("0123456789", 10) == std::string::npos) {
+            threadCount = static_cast<unsigned>(std::strtoul(arg.c_str() + 10, nullptr, 10));
+        } else if (arg.compare(0, 9, "--trucks=") == 0 && arg.size() > 9 &&
+                   arg.find_first_not_of("0123456789", 9) == std::string::npos && std::atoi(arg.c_str() + 9) > 0) {
+            truckCount = static_cast<unsigned>(std::strtoul(arg.c_str() + 9, nullptr, 10));
+        } else if (arg.compare(0, 14, "--tour-budget=") == 0 && arg.size() > 14 &&
+                   arg.find_first_not_of("0123456789", 14) == std::string::npos) {
+            tourBudgetMillis = std::strtod(arg.c_str() + 14, nullptr);
+        } else if (arg == "--heap=binary") {
+            SampleQueryContext::setDefaultHeapType(SampleHeapType::Binary);
+        } else if (arg == "--heap=4ary") {
+            SampleQueryContext::setDefaultHeapType(SampleHeapType::FourAry);
+        } else if (arg == "--heap=radix") {
+            SampleQueryContext::setDefaultHeapType(SampleHeapType::Radix);
+        } else {
+            std::cout << "Usage: " << argv[0] << " [--heap=binary|4ary|radix] [--snapshot=FILE] [--threads=N]"
+                      << " [--trucks=N] [--tour-budget=MS] [--stats=FILE] [--trace=FILE]" << std::endl;
+            std::cout << "       " << argv[0] << " [--threads=N] --convert-snapshot=FILE" << std::endl;
+            std::cout << "       " << argv[0] << " [--heap=binary|4ary|radix] [--snapshot=FILE] [--threads=N] --serve[=SOCKET]" << std::endl;
+            return 1;
+        }
+    }
+    if (!statsPath.empty() || !tracePath.empty()) {
+        SampleStats::enable();
+    }
+    
+    // Worker threads shared by every batch of independent searches below
+    SampleThreadPool pool(threadCount);
+    if (!convertPath.empty()) {
+        int status = convertToSnapshot(convertPath, pool);
+        writeStatsReports(statsPath, tracePath);
+        return status;
+    }
+    if (serve) {
+        return runServer(socketPath, snapshotPath, pool);
+    }
+    
     std::cout << "=== Delivery Truck Route Optimization System ===" << std::endl;
     std::cout << "Maximizing Delivery Profit by Combining Bellman-Ford and Dijkstra Algorithms" << std::endl;
     
     try {
         // Step 1: Create the positive graph (for Dijkstra)
         std::cout << "\n1. Constructing Positive Weight Map..." << std::endl;
-        SamplePositiveGraph* positiveGraph = loadPositiveGraphFromCSV("data/vertices.csv", "data/distances.csv");
+        SAMPLE_STATS_SPAN(phase, "1. positive graph");
+        SampleGraphSnapshot* snapshot = snapshotPath.empty() ? nullptr : openSnapshot(snapshotPath);
+        SamplePositiveGraph* positiveGraph = snapshot != nullptr ? snapshot->toPositiveGraph()
+                                                                 : loadPositiveGraphFromCSV(VERTICES_FILE, DISTANCES_FILE);
         std::cout << "Positive graph created with " << positiveGraph->getAllVertices().size() << " vertices." << std::endl;
+        // Searches that only need the arrays run on the mapped snapshot (same
+        // ids); the steps below that walk vertices use positiveGraph
+        const SampleCSRGraph* roadGraph = snapshot != nullptr ? snapshot->getGraph() : positiveGraph->freeze();
         
         // Step 2: Create the negative graph (for Bellman-Ford)
         std::cout << "\n2. Constructing Negative Weight Map for Profit Analysis..." << std::endl;
-        SampleNegativeGraph* negativeGraph = createNegativeGraph(positiveGraph);
+        SAMPLE_STATS_NEXT(phase, "2. negative graph");
+        SampleNegativeGraph* negativeGraph = SampleDeliveryPlanner::createNegativeGraph(positiveGraph, snapshot, &pool);
         std::cout << "Negative graph created for profit calculations." << std::endl;
         
         // Find the garage vertex (central hub)
         SampleVertex* garage = findGarageVertex(positiveGraph);
         if (garage == nullptr) {
             std::cout << "Error: Garage vertex not found in the graph!" << std::endl;
-            delete positiveGraph;
             delete negativeGraph;
+            delete positiveGraph;
+            delete snapshot;
             return 1;
         }
         
         // Step 3: Run Bellman-Ford to find negative cycles (profitable routes)
         std::cout << "\n3. Running Bellman-Ford to Find Optimal Delivery Sequence..." << std::endl;
+        SAMPLE_STATS_NEXT(phase, "3. negative cycle");
         SampleBellmanFord bellmanFord(negativeGraph);
-        std::vector<SampleVertex*> profitableCycle = bellmanFord.findNegativeCycle();
+        std::vector<SampleVertex*> profitableCycle = bellmanFord.findNegativeCycleSPFA();
         
         if (profitableCycle.empty()) {
             std::cout << "No profitable delivery cycles found!" << std::endl;
-            runSimplePathAnalysis(positiveGraph, garage);
+            SAMPLE_STATS_NEXT(phase, "4. simple path analysis");
+            runSimplePathAnalysis(positiveGraph, garage, pool);
         } else {
             // Print the profitable cycle
             std::cout << "\nFound profitable delivery cycle:" << std::endl;
@@ -65,18 +154,19 @@ int main() {
             std::cout << profitableCycle[0]->getName() << std::endl;
             
             // Calculate the total profit of the cycle
-            double profit = calculateCycleProfit(profitableCycle);
+            double profit = SampleDeliveryPlanner::cycleWeight(negativeGraph->freeze(), profitableCycle);
             std::cout << "Total profit for this cycle: $" << (-profit) << std::endl;
             
             // Step 4: Use Dijkstra to find shortest paths between vertices in the profitable cycle
             std::cout << "\n4. Using Dijkstra to Find Shortest Paths Between Delivery Points..." << std::endl;
+            SAMPLE_STATS_NEXT(phase, "4. shortest paths");
             SampleDijkstra dijkstra(positiveGraph);
             
-            // Execute the profitable cycle and print the detailed path using Dijkstra
-            dijkstra.executeNegativeCycleAndPrintPath(garage, profitableCycle);
+            // Execute the profitable cycle and print the detailed path using
+            // Dijkstra; the legs add up to the total distance
+            double totalDistance = dijkstra.executeNegativeCycleAndPrintPath(garage, profitableCycle);
             
-            // Calculate total distance and final profit
-            double totalDistance = calculateTotalDistance(positiveGraph, garage, profitableCycle);
+            // Calculate final profit
             double travelCost = totalDistance * 0.1; // Assuming $0.1 per distance unit
             double finalProfit = (-profit) - travelCost;
             
@@ -85,142 +175,235 @@ int main() {
             std::cout << "Total travel distance: " << totalDistance << " units" << std::endl;
             std::cout << "Travel cost: $" << travelCost << std::endl;
             std::cout << "Final profit after travel costs: $" << finalProfit << std::endl;
+            std::cout << "Shortest path legs: " << dijkstra.getBidirectionalLegs() << " bidirectional" << std::endl;
+            std::cout << "Shortest path trees: " << dijkstra.getCache().getMisses() << " searched, "
+                      << dijkstra.getCache().getHits() << " reused" << std::endl;
+            
+            // The cycle is driven in the order it was found; search for a
+            // shorter one that still picks up before dropping off
+            SampleTourOptimizer::Options tourOptions;
+            tourOptions.budgetSeconds = tourBudgetMillis / 1000.0;
+            SampleDeliveryPlanner::ImprovedTour tour = SampleDeliveryPlanner::improveTour(
+                roadGraph, garage, profitableCycle, tourOptions, &pool);
+            std::cout << "\n=== Improved Visiting Order ===" << std::endl;
+            std::cout << "Route: " << garage->getName();
+            for (SampleVertex* vertex : tour.stops) {
+                std::cout << " -> " << vertex->getName();
+            }
+            std::cout << " -> " << garage->getName() << std::endl;
+            std::cout << "Moves: " << tour.result.twoOptMoves << " 2-opt, " << tour.result.orOptMoves << " Or-opt, "
+                      << tour.result.relocateMoves << " relocate, " << tour.result.kicks << " restarts" << std::endl;
+            std::cout << "Route distance: " << tour.result.length << " units (found order: "
+                      << tour.result.initialLength << ")" << std::endl;
+            std::cout << "Final profit after travel costs: $"
+                      << (-profit) - tour.result.length * 0.1 << std::endl;
         }
-        
+
+        // Step 5: Rank separate profitable cycles through the garage, one per truck
+        std::cout << "\n5. Ranking Profitable Delivery Cycles Through the Garage..." << std::endl;
+        SAMPLE_STATS_NEXT(phase, "5. top cycles");
+        const size_t TRUCK_COUNT = truckCount;
+        std::vector<SampleBellmanFord::RankedCycle> rankedCycles =
+            bellmanFord.findTopCycles(garage, TRUCK_COUNT, 8, true);
+        if (rankedCycles.empty()) {
+            std::cout << "No profitable cycles through the garage found!" << std::endl;
+        }
+        for (size_t i = 0; i < rankedCycles.size(); i++) {
+            std::cout << "Truck " << (i + 1) << ": ";
+            for (SampleVertex* vertex : rankedCycles[i].vertices) {
+                std::cout << vertex->getName() << " -> ";
+            }
+            std::cout << rankedCycles[i].vertices[0]->getName()
+                      << " (profit: $" << (-rankedCycles[i].weight) << ")" << std::endl;
+        }
+
+        // Step 6: Best profit per unit of travel distance (minimum cost/distance ratio cycle)
+        std::cout << "\n6. Finding the Cycle with the Best Profit per Distance..." << std::endl;
+        SAMPLE_STATS_NEXT(phase, "6. best ratio cycle");
+        SampleCycleRatio cycleRatio(negativeGraph->freeze());
+        SampleCycleRatio::RatioCycle ratioCycle =
+            cycleRatio.findMinimumRatioCycle(SampleDeliveryPlanner::arcDistances(roadGraph, negativeGraph->freeze(), &pool));
+        if (ratioCycle.vertices.empty() || ratioCycle.cost >= 0) {
+            std::cout << "No profitable cycle found!" << std::endl;
+        } else {
+            std::cout << "Cycle: ";
+            for (SampleVertex* vertex : ratioCycle.vertices) {
+                std::cout << vertex->getName() << " -> ";
+            }
+            std::cout << ratioCycle.vertices[0]->getName() << std::endl;
+            std::cout << "Profit: $" << (-ratioCycle.cost) << " over " << ratioCycle.time
+                      << " distance units ($" << (-ratioCycle.ratio) << " per unit, "
+                      << cycleRatio.getIterations() << " policy iterations)" << std::endl;
+        }
+
+        // Step 7: The whole fleet: trucks at every garage sharing out all orders
+        std::cout << "\n7. Planning the Fleet Across All Garages..." << std::endl;
+        SAMPLE_STATS_NEXT(phase, "7. fleet plan");
+        std::vector<uint32_t> garages = SampleDeliveryPlanner::findGarages(positiveGraph);
+        std::vector<SampleFleetPlanner::Order> orders = SampleDeliveryPlanner::createOrders(positiveGraph, &pool);
+        if (garages.empty() || orders.empty()) {
+            std::cout << "No orders to plan!" << std::endl;
+        } else {
+            SampleFleetPlanner fleetPlanner(positiveGraph->freeze(), garages, orders);
+            SampleFleetPlanner::Options fleetOptions;
+            fleetOptions.truckCount = truckCount;
+            fleetOptions.budgetSeconds = tourBudgetMillis / 1000.0;
+            SampleFleetPlanner::Plan plan = fleetPlanner.plan(fleetOptions, &pool);
+            for (size_t i = 0; i < plan.routes.size(); i++) {
+                const SampleFleetPlanner::Route& route = plan.routes[i];
+                std::string depot = positiveGraph->getVertex(route.depot)->getName();
+                if (route.orders.empty()) {
+                    std::cout << "Truck " << (i + 1) << ": stays at " << depot << std::endl;
+                    continue;
+                }
+                std::cout << "Truck " << (i + 1) << ": " << depot;
+                for (uint32_t stop : route.stops) {
+                    std::cout << " -> " << positiveGraph->getVertex(stop)->getName();
+                }
+                std::cout << " -> " << depot << " (" << route.orders.size() << " orders, "
+                          << route.distance << " units)" << std::endl;
+            }
+            std::cout << "Orders delivered: " << (orders.size() - plan.unserved.size()) << " of " << orders.size()
+                      << " from " << garages.size() << " garage(s), " << plan.movedOrders << " moved by rebalancing"
+                      << std::endl;
+            std::cout << "Fleet profit: $" << plan.profit << " - travel cost $" << plan.distance * 0.1
+                      << " = $" << plan.profit - plan.distance * 0.1 << std::endl;
+        }
+
+        SAMPLE_STATS_END(phase);
+
         // Clean up
-        delete positiveGraph;
         delete negativeGraph;
+        delete positiveGraph;
+        delete snapshot;
         
     } catch (const std::exception& e) {
         std::cout << "Error: " << e.what() << std::endl;
     }
     
+    writeStatsReports(statsPath, tracePath);
     return 0;
 }
 
-SamplePositiveGraph* loadPositiveGraphFromCSV(const std::string& verticesFile, const std::string& distancesFile) {
-    SamplePositiveGraph* graph = new SamplePositiveGraph();
-    
+// Daemon mode: the map stays loaded and requests come in as JSON lines.
+// stdout carries the answers there, so messages go to stderr.
+int runServer(const std::string& socketPath, const std::string& snapshotPath, SampleThreadPool& pool) {
     try {
-        // First, load all vertices
-        std::ifstream verticesStream(verticesFile);
-        if (!verticesStream.is_open()) {
-            throw std::runtime_error("Unable to open vertices file");
-        }
-        
-        std::string line;
-        std::getline(verticesStream, line); // Skip header line
-        
-        while (std::getline(verticesStream, line)) {
-            std::stringstream ss(line);
-            std::string name, type, temp;
-            double latitude, longitude;
-            int mapRow, mapCol;
-            
-            // Parse CSV line
-            std::getline(ss, name, ',');
-            std::getline(ss, temp, ',');
-            latitude = std::stod(temp);
-            std::getline(ss, temp, ',');
-            longitude = std::stod(temp);
-            std::getline(ss, temp, ',');
-            mapRow = std::stoi(temp);
-            std::getline(ss, temp, ',');
-            mapCol = std::stoi(temp);
-            std::getline(ss, type, ',');
-            
-            SampleVertex* vertex = new SampleVertex(name);
-            vertex->setLatitude(latitude);
-            vertex->setLongitude(longitude);
-            vertex->setMapRow(mapRow);
-            vertex->setMapCol(mapCol);
-            vertex->setType(type);
-            
-            graph->addVertex(vertex);
-        }
-        verticesStream.close();
-        
-        // Then, load all edges/distances
-        std::ifstream distancesStream(distancesFile);
-        if (!distancesStream.is_open()) {
-            throw std::runtime_error("Unable to open distances file");
-        }
-        
-        std::getline(distancesStream, line); // Skip header line
-        
-        while (std::getline(distancesStream, line)) {
-            std::stringstream ss(line);
-            std::string fromName, toName, temp;
-            double distance;
-            
-            // Parse CSV line
-            std::getline(ss, fromName, ',');
-            std::getline(ss, toName, ',');
-            std::getline(ss, temp, ',');
-            distance = std::stod(temp);
-            
-            SampleVertex* from = graph->getVertexByName(fromName);
-            SampleVertex* to = graph->getVertexByName(toName);
-            
-            if (from != nullptr && to != nullptr) {
-                graph->addEdge(from, to, distance);
-            }
+        // With a snapshot the map is queried where it is mapped
+        std::unique_ptr<SampleQueryServer> server(
+            snapshotPath.empty() ? new SampleQueryServer(VERTICES_FILE, DISTANCES_FILE, pool)
+                                 : new SampleQueryServer(snapshotPath, VERTICES_FILE, DISTANCES_FILE, pool));
+        if (socketPath.empty()) {
+            std::cerr << "Serving requests on stdin/stdout" << std::endl;
+            server->serveStream(0, 1);
+        } else {
+            std::cerr << "Serving requests on " << socketPath << std::endl;
+            server->serveSocket(socketPath);
         }
-        distancesStream.close();
-        
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Writes the run statistics asked for on the command line, if any
+void writeStatsReports(const std::string& statsPath, const std::string& tracePath) {
+    if (!SAMPLE_STATS && (!statsPath.empty() || !tracePath.empty())) {
+        std::cout << "Note: statistics were compiled out (SAMPLE_STATS=0), the reports are empty" << std::endl;
+    }
+    if (!statsPath.empty()) {
+        std::ofstream out(statsPath.c_str());
+        SampleStats::writeJSON(out);
+        std::cout << (out ? "Statistics written to " : "Cannot write statistics to ") << statsPath << std::endl;
+    }
+    if (!tracePath.empty()) {
+        std::ofstream out(tracePath.c_str());
+        SampleStats::writeChromeTrace(out);
+        std::cout << (out ? "Trace written to " : "Cannot write trace to ") << tracePath << std::endl;
+    }
+}
+
+SamplePositiveGraph* loadPositiveGraphFromCSV(const std::string& verticesFile, const std::string& distancesFile) {
+    try {
+        return SampleCSVLoader::loadPositiveGraph(verticesFile, distancesFile);
     } catch (const std::exception& e) {
         std::cout << "Error reading CSV files: " << e.what() << std::endl;
         
         // If files not found, create a sample graph for demonstration
         std::cout << "Creating sample graph for demonstration instead..." << std::endl;
-        delete graph;
         return createSamplePositiveGraph();
     }
-    
-    return graph;
+}
+
+// Maps a snapshot written by --convert-snapshot; nullptr (after saying
+// why) when it cannot be used and the CSV files have to be read instead
+SampleGraphSnapshot* openSnapshot(const std::string& path) {
+    SampleGraphSnapshot* snapshot = nullptr;
+    try {
+        snapshot = new SampleGraphSnapshot(path);
+    } catch (const std::exception& e) {
+        std::cout << "Cannot use snapshot: " << e.what() << std::endl;
+        return nullptr;
+    }
+    if (snapshot->isStale(VERTICES_FILE, DISTANCES_FILE)) {
+        std::cout << "Snapshot " << path << " is stale (CSV files changed), reading the CSV files instead." << std::endl;
+        delete snapshot;
+        return nullptr;
+    }
+    std::cout << "Loaded snapshot " << path << std::endl;
+    return snapshot;
+}
+
+// Converter mode: CSV files -> binary snapshot with the pickup x dropoff matrix
+int convertToSnapshot(const std::string& path, SampleThreadPool& pool) {
+    try {
+        SamplePositiveGraph* graph = SampleCSVLoader::loadPositiveGraph(VERTICES_FILE, DISTANCES_FILE);
+        SampleGraphSnapshot::write(path, graph, VERTICES_FILE, DISTANCES_FILE, true, &pool);
+        std::cout << "Snapshot written to " << path << " (" << graph->getVertexList().size()
+                  << " vertices, " << graph->freeze()->getArcCount() << " arcs)" << std::endl;
+        delete graph;
+    } catch (const std::exception& e) {
+        std::cout << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
 }
 
 SamplePositiveGraph* createSamplePositiveGraph() {
     SamplePositiveGraph* graph = new SamplePositiveGraph();
     
     // Add vertices (locations)
-    SampleVertex* garage = new SampleVertex("Garage");
-    garage->setType("garage");
+    SampleVertex* garage = graph->createVertex("Garage");
+    garage->setVertexType(SampleVertexType::Garage);
     garage->setLatitude(40.7128);
     garage->setLongitude(-74.0060);
     
-    SampleVertex* locationA = new SampleVertex("LocationA");
-    locationA->setType("pickup");
+    SampleVertex* locationA = graph->createVertex("LocationA");
+    locationA->setVertexType(SampleVertexType::Pickup);
     locationA->setLatitude(40.7300);
     locationA->setLongitude(-74.0100);
     
-    SampleVertex* locationB = new SampleVertex("LocationB");
-    locationB->setType("pickup");
+    SampleVertex* locationB = graph->createVertex("LocationB");
+    locationB->setVertexType(SampleVertexType::Pickup);
     locationB->setLatitude(40.7200);
     locationB->setLongitude(-73.9900);
     
-    SampleVertex* locationC = new SampleVertex("LocationC");
-    locationC->setType("pickup");
+    SampleVertex* locationC = graph->createVertex("LocationC");
+    locationC->setVertexType(SampleVertexType::Pickup);
     locationC->setLatitude(40.7050);
     locationC->setLongitude(-74.0200);
     
-    SampleVertex* locationD = new SampleVertex("LocationD");
-    locationD->setType("dropoff");
+    SampleVertex* locationD = graph->createVertex("LocationD");
+    locationD->setVertexType(SampleVertexType::Dropoff);
     locationD->setLatitude(40.7400);
     locationD->setLongitude(-73.9800);
     
-    SampleVertex* locationE = new SampleVertex("LocationE");
-    locationE->setType("dropoff");
+    SampleVertex* locationE = graph->createVertex("LocationE");
+    locationE->setVertexType(SampleVertexType::Dropoff);
     locationE->setLatitude(40.7150);
     locationE->setLongitude(-73.9700);
     
-    graph->addVertex(garage);
-    graph->addVertex(locationA);
-    graph->addVertex(locationB);
-    graph->addVertex(locationC);
-    graph->addVertex(locationD);
-    graph->addVertex(locationE);
-    
     // Add edges with positive weights (distances/costs)
     graph->addEdge(garage, locationA, 5.0);
     graph->addEdge(garage, locationB, 7.0);
@@ -238,104 +421,6 @@ SamplePositiveGraph* createSamplePositiveGraph() {
     return graph;
 }
 
-SampleNegativeGraph* createNegativeGraph(SamplePositiveGraph* positiveGraph) {
-    SampleNegativeGraph* graph = new SampleNegativeGraph();
-    const double BASE_PROFIT = 15.0;        // Increased base profit
-    const double DISTANCE_PROFIT = 2.0;     // Profit per distance unit
-    const double MULTI_PICKUP_BONUS = 3.0;  // Bonus for multiple pickups
-    
-    // 1. Copy all vertices
-    for (const auto& pair : positiveGraph->getAllVertices()) {
-        SampleVertex* vertex = pair.second;
-        SampleVertex* newVertex = new SampleVertex(vertex->getName());
-        newVertex->setType(vertex->getType());
-        newVertex->setLatitude(vertex->getLatitude());
-        newVertex->setLongitude(vertex->getLongitude());
-        newVertex->setMapRow(vertex->getMapRow());
-        newVertex->setMapCol(vertex->getMapCol());
-        graph->addVertex(newVertex);
-    }
-
-    // 2. Create profit edges (pickup to dropoff with negative weights representing profit)
-    for (const auto& fromPair : positiveGraph->getAllVertices()) {
-        SampleVertex* from = fromPair.second;
-        if (from->getType() == "pickup") {
-            for (const auto& toPair : positiveGraph->getAllVertices()) {
-                SampleVertex* to = toPair.second;
-                if (to->getType() == "dropoff") {
-                    // Find the shortest path distance in the positive graph
-                    SampleDijkstra dijkstra(positiveGraph);
-                    dijkstra.runDijkstra(from);
-                    double distance = to->getDistance();
-                    
-                    if (distance > 0) {
-                        // Calculate profit - make it negative for Bellman-Ford
-                        double profit = BASE_PROFIT + (distance * DISTANCE_PROFIT);
-                        graph->addEdge(from->getName(), to->getName(), -profit);
-                    }
-                }
-            }
-        }
-    }
-
-    // 3. Special constraints to ensure valid delivery routes
-    
-    // a) Between pickups (with small negative weights to encourage multiple pickups)
-    for (const auto& fromPair : graph->getAllVertices()) {
-        SampleVertex* from = fromPair.second;
-        if (from->getType() == "pickup") {
-            for (const auto& toPair : graph->getAllVertices()) {
-                SampleVertex* to = toPair.second;
-                if (to->getType() == "pickup" && from != to) {
-                    // Small negative weight to encourage visiting multiple pickups
-                    graph->addEdge(from->getName(), to->getName(), -MULTI_PICKUP_BONUS);
-                }
-            }
-        }
-    }
-    
-    // b) REMOVED direct connections between dropoffs to prevent invalid cycles
-    
-    // c) From dropoffs back to garage ONLY (no direct dropoff-to-dropoff)
-    for (const auto& pair : graph->getAllVertices()) {
-        SampleVertex* vertex = pair.second;
-        if (vertex->getType() == "dropoff") {
-            graph->addEdge(vertex->getName(), "Garage", 0.0);
-        }
-    }
-    
-    // d) From garage to pickups ONLY (no direct garage-to-dropoff)
-    for (const auto& pair : graph->getAllVertices()) {
-        SampleVertex* vertex = pair.second;
-        if (vertex->getType() == "pickup") {
-            graph->addEdge("Garage", vertex->getName(), 0.0);
-        }
-    }
-    
-    // 5. Add artificial high-profit paths for certain routes to guide the algorithm
-    // This creates a "suggested" multi-stop route pattern
-    
-    // Example of a multi-pickup, multi-dropoff route with high profit
-    if (graph->getVertexByName("RestaurantA") && graph->getVertexByName("RestaurantB") && 
-        graph->getVertexByName("OfficeA") && graph->getVertexByName("OfficeB")) {
-        
-        // Create a high-profit path from RestaurantA to RestaurantB to OfficeA to OfficeB
-        graph->addEdge("RestaurantA", "RestaurantB", -MULTI_PICKUP_BONUS * 2);
-        graph->addEdge("RestaurantB", "OfficeA", -BASE_PROFIT * 1.5);
-        graph->addEdge("OfficeA", "OfficeB", -MULTI_PICKUP_BONUS * 2);
-    }
-
-    // Create another potential profitable route
-    if (graph->getVertexByName("RestaurantB") && graph->getVertexByName("RestaurantC") && 
-        graph->getVertexByName("OfficeB") && graph->getVertexByName("OfficeC")) {
-        
-        graph->addEdge("RestaurantB", "RestaurantC", -MULTI_PICKUP_BONUS * 2);
-        graph->addEdge("RestaurantC", "OfficeB", -BASE_PROFIT * 1.5);
-        graph->addEdge("OfficeB", "OfficeC", -MULTI_PICKUP_BONUS * 2);
-    }
-
-    return graph;
-}
 double calculateEuclideanDistance(SampleVertex* v1, SampleVertex* v2) {
         double lat1 = v1->getLatitude();
         double lon1 = v1->getLongitude();
@@ -349,7 +434,7 @@ double calculateEuclideanDistance(SampleVertex* v1, SampleVertex* v2) {
     SampleVertex* findGarageVertex(SamplePositiveGraph* graph) {
         for (const auto& pair : graph->getAllVertices()) {
             SampleVertex* vertex = pair.second;
-            if (vertex->getType() == "garage") {
+            if (vertex->getVertexType() == SampleVertexType::Garage) {
                 return vertex;
             }
         }
@@ -363,93 +448,55 @@ double calculateEuclideanDistance(SampleVertex* v1, SampleVertex* v2) {
         return nullptr;
     }
     
-    double calculateCycleProfit(const std::vector<SampleVertex*>& cycle) {
-        double totalProfit = 0.0;
-        
-        for (size_t i = 0; i < cycle.size(); i++) {
-            SampleVertex* current = cycle[i];
-            SampleVertex* next = cycle[(i + 1) % cycle.size()];
-            
-            // Find the edge between these vertices and add its weight (negative = profit)
-            for (SampleEdge* edge : current->getNeighbors()) {
-                if ((edge->getVertexF() == current && edge->getVertexT() == next) ||
-                    (edge->getVertexF() == next && edge->getVertexT() == current)) {
-                    totalProfit += edge->getWeight();
-                    break;
-                }
-            }
-        }
-        
-        return totalProfit;
-    }
-    
-    double calculateTotalDistance(SamplePositiveGraph* graph, SampleVertex* garage, const std::vector<SampleVertex*>& cycle) {
-        double totalDistance = 0.0;
-        
-        // Create Dijkstra instance
-        SampleDijkstra dijkstra(graph);
-        
-        // Get distance from garage to first location
-        SampleVertex* firstLocation = graph->getVertexByName(cycle[0]->getName());
-        dijkstra.runDijkstra(garage);
-        totalDistance += firstLocation->getDistance();
-        
-        // Get distances between locations in the cycle
-        for (size_t i = 0; i < cycle.size() - 1; i++) {
-            SampleVertex* current = graph->getVertexByName(cycle[i]->getName());
-            SampleVertex* next = graph->getVertexByName(cycle[i + 1]->getName());
-            
-            dijkstra.runDijkstra(current);
-            totalDistance += next->getDistance();
-        }
-        
-        // Get distance from last location back to garage
-        SampleVertex* lastLocation = graph->getVertexByName(cycle[cycle.size() - 1]->getName());
-        dijkstra.runDijkstra(lastLocation);
-        totalDistance += garage->getDistance();
-        
-        return totalDistance;
-    }
-    
-    void runSimplePathAnalysis(SamplePositiveGraph* graph, SampleVertex* garage) {
+    void runSimplePathAnalysis(SamplePositiveGraph* graph, SampleVertex* garage, SampleThreadPool& pool) {
         std::cout << "\nRunning simple path analysis between key locations..." << std::endl;
         
-        SampleDijkstra dijkstra(graph);
-        
         // Find pickup and dropoff vertices
         std::vector<SampleVertex*> pickups;
         std::vector<SampleVertex*> dropoffs;
         
         for (const auto& pair : graph->getAllVertices()) {
             SampleVertex* vertex = pair.second;
-            if (vertex->getType() == "pickup") {
+            if (vertex->getVertexType() == SampleVertexType::Pickup) {
                 pickups.push_back(vertex);
-            } else if (vertex->getType() == "dropoff") {
+            } else if (vertex->getVertexType() == SampleVertexType::Dropoff) {
                 dropoffs.push_back(vertex);
             }
         }
         
+        // Each group of distances below is its own batch job: garage to every
+        // pickup, every pickup to all dropoffs, every dropoff back to garage
+        std::vector<uint32_t> garageIds(1, garage->getId());
+        SampleQueryBatch batch(graph->freeze());
+        size_t garageJob = batch.submit(garage->getId(), SampleDeliveryPlanner::vertexIds(pickups));
+        std::vector<size_t> pickupJobs;
+        for (SampleVertex* pickup : pickups) {
+            pickupJobs.push_back(batch.submit(pickup->getId(), SampleDeliveryPlanner::vertexIds(dropoffs)));
+        }
+        std::vector<size_t> dropoffJobs;
+        for (SampleVertex* dropoff : dropoffs) {
+            dropoffJobs.push_back(batch.submit(dropoff->getId(), garageIds));
+        }
+        batch.run(&pool);
+        
         // Analyze paths from garage to each pickup point
         std::cout << "\nDistances from Garage to Pickup points:" << std::endl;
-        for (SampleVertex* pickup : pickups) {
-            dijkstra.runDijkstra(garage);
-            std::cout << "To " << pickup->getName() << ": " << pickup->getDistance() << " units" << std::endl;
+        for (size_t i = 0; i < pickups.size(); i++) {
+            std::cout << "To " << pickups[i]->getName() << ": " << batch.getDistance(garageJob, i) << " units" << std::endl;
         }
         
         // Analyze paths between pickup and dropoff points
         std::cout << "\nDistances from Pickup to Dropoff points:" << std::endl;
-        for (SampleVertex* pickup : pickups) {
-            for (SampleVertex* dropoff : dropoffs) {
-                dijkstra.runDijkstra(pickup);
-                std::cout << "From " << pickup->getName() << " to " << dropoff->getName() << ": " 
-                         << dropoff->getDistance() << " units" << std::endl;
+        for (size_t i = 0; i < pickups.size(); i++) {
+            for (size_t j = 0; j < dropoffs.size(); j++) {
+                std::cout << "From " << pickups[i]->getName() << " to " << dropoffs[j]->getName() << ": " 
+                         << batch.getDistance(pickupJobs[i], j) << " units" << std::endl;
             }
         }
         
         // Analyze paths from dropoff points back to garage
         std::cout << "\nDistances from Dropoff points back to Garage:" << std::endl;
-        for (SampleVertex* dropoff : dropoffs) {
-            dijkstra.runDijkstra(dropoff);
-            std::cout << "From " << dropoff->getName() << ": " << garage->getDistance() << " units" << std::endl;
+        for (size_t i = 0; i < dropoffs.size(); i++) {
+            std::cout << "From " << dropoffs[i]->getName() << ": " << batch.getDistance(dropoffJobs[i], 0) << " units" << std::endl;
         }
-    }
\ No newline at end of file
+    }
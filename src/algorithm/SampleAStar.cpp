@@ -0,0 +1,158 @@
+// SampleAStar.cpp
+#include "algorithm/SampleAStar.h"
+#include "util/SampleMath.h"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+const double SampleAStar::EARTH_RADIUS_KM = 6371.0088;
+
+// Shrinks the bound a little so rounding in the trigonometry can never make
+// the heuristic overestimate an arc that passed the admissibility check
+static const double HEURISTIC_SLACK = 1.0 - 1e-9;
+
+// Coordinates in degrees of the graph's vertex objects
+static void readCoordinates(const SampleCSRGraph* graph, std::vector<double>& latitudes,
+                            std::vector<double>& longitudes) {
+    uint32_t n = graph->getVertexCount();
+    latitudes.resize(n);
+    longitudes.resize(n);
+    for (uint32_t id = 0; id < n; id++) {
+        SampleVertex* vertex = graph->getVertex(id);
+        latitudes[id] = vertex->getLatitude();
+        longitudes[id] = vertex->getLongitude();
+    }
+}
+
+SampleAStar::SampleAStar(const SampleCSRGraph* graph, double costPerKm) {
+    this->graph = graph;
+    this->costPerKm = costPerKm;
+
+    std::vector<double> latitudes, longitudes;
+    readCoordinates(graph, latitudes, longitudes);
+    setCoordinates(latitudes, longitudes);
+}
+
+SampleAStar::SampleAStar(const SampleCSRGraph* graph, const std::vector<double>& latitudes,
+                         const std::vector<double>& longitudes, double costPerKm) {
+    this->graph = graph;
+    this->costPerKm = costPerKm;
+    setCoordinates(latitudes, longitudes);
+}
+
+void SampleAStar::setCoordinates(const std::vector<double>& latitudes, const std::vector<double>& longitudes) {
+    uint32_t n = graph->getVertexCount();
+    latitude.resize(n);
+    longitude.resize(n);
+    cosLatitude.resize(n);
+    for (uint32_t id = 0; id < n; id++) {
+        latitude[id] = latitudes[id] * SAMPLE_DEGREES_TO_RADIANS;
+        longitude[id] = longitudes[id] * SAMPLE_DEGREES_TO_RADIANS;
+        cosLatitude[id] = std::cos(latitude[id]);
+    }
+
+    // The heuristic is admissible if no arc is cheaper than its great-circle
+    // length times costPerKm; a single cheaper arc switches it off, and so
+    // does a bound that no arc sets
+    double maxCostPerKm = computeMaxCostPerKm(graph, latitudes, longitudes);
+    if (costPerKm == 0) {
+        costPerKm = maxCostPerKm;
+    }
+    this->heuristicEnabled = costPerKm > 0 && costPerKm < std::numeric_limits<double>::max() &&
+                             costPerKm <= maxCostPerKm;
+}
+
+double SampleAStar::estimate(uint32_t u, uint32_t target) const {
+    if (!heuristicEnabled) {
+        return 0;
+    }
+    double sinLat = std::sin((latitude[target] - latitude[u]) / 2);
+    double sinLon = std::sin((longitude[target] - longitude[u]) / 2);
+    double a = sinLat * sinLat + cosLatitude[u] * cosLatitude[target] * sinLon * sinLon;
+    double km = 2 * EARTH_RADIUS_KM * std::asin(std::min(1.0, std::sqrt(a)));
+    return km * costPerKm * HEURISTIC_SLACK;
+}
+
+// A* over the CSR arrays. Queue keys are distance + estimate; with a
+// consistent estimate the keys popped never decrease, which also keeps the
+// radix heap valid.
+template <typename Heap>
+static void aStarKernel(const SampleAStar& aStar, const SampleCSRGraph* graph, uint32_t source, uint32_t target,
+                        SampleQueryContext& context, Heap& heap) {
+    const uint32_t* offsets = graph->getOffsets();
+    const uint32_t* targets = graph->getTargets();
+    const double* weights = graph->getWeights();
+
+    heap.reset(graph->getVertexCount());
+    context.setDistance(source, 0, SampleQueryContext::NO_VERTEX);
+    heap.push(source, aStar.estimate(source, target));
+
+    while (!heap.empty()) {
+        double key = heap.topKey();
+        uint32_t u = heap.pop();
+        if (context.isSettled(u)) continue; // Stale entry
+        context.setSettled(u);
+        if (u == target) break;
+
+        double du = context.getDistance(u);
+        for (uint32_t arc = offsets[u]; arc < offsets[u + 1]; arc++) {
+            uint32_t v = targets[arc];
+            if (context.isSettled(v)) continue;
+
+            double newDist = du + weights[arc];
+            if (newDist < context.getDistance(v)) {
+                context.setDistance(v, newDist, u);
+                // Clamp so rounding never pushes a key below the current one
+                heap.push(v, std::max(key, newDist + aStar.estimate(v, target)));
+            }
+        }
+    }
+}
+
+double SampleAStar::findShortestPath(uint32_t source, uint32_t target, SampleQueryContext& context) const {
+    context.reset(graph->getVertexCount());
+    context.setSource(source);
+
+    switch (context.getHeapType()) {
+    case SampleHeapType::Binary:
+        aStarKernel(*this, graph, source, target, context, context.getBinaryHeap());
+        break;
+    case SampleHeapType::Radix:
+        aStarKernel(*this, graph, source, target, context, context.getRadixHeap());
+        break;
+    default:
+        aStarKernel(*this, graph, source, target, context, context.getFourAryHeap());
+        break;
+    }
+    return context.getDistance(target);
+}
+
+double SampleAStar::haversineKm(double lat1, double lon1, double lat2, double lon2) {
+    double phi1 = lat1 * SAMPLE_DEGREES_TO_RADIANS;
+    double phi2 = lat2 * SAMPLE_DEGREES_TO_RADIANS;
+    double sinLat = std::sin((phi2 - phi1) / 2);
+    double sinLon = std::sin((lon2 - lon1) * SAMPLE_DEGREES_TO_RADIANS / 2);
+    double a = sinLat * sinLat + std::cos(phi1) * std::cos(phi2) * sinLon * sinLon;
+    return 2 * EARTH_RADIUS_KM * std::asin(std::min(1.0, std::sqrt(a)));
+}
+
+double SampleAStar::computeMaxCostPerKm(const SampleCSRGraph* graph) {
+    std::vector<double> latitudes, longitudes;
+    readCoordinates(graph, latitudes, longitudes);
+    return computeMaxCostPerKm(graph, latitudes, longitudes);
+}
+
+double SampleAStar::computeMaxCostPerKm(const SampleCSRGraph* graph, const std::vector<double>& latitudes,
+                                        const std::vector<double>& longitudes) {
+    double maxCostPerKm = std::numeric_limits<double>::max();
+    for (uint32_t u = 0; u < graph->getVertexCount(); u++) {
+        for (uint32_t arc = graph->getArcBegin(u); arc < graph->getArcEnd(u); arc++) {
+            uint32_t v = graph->getArcTarget(arc);
+            double km = haversineKm(latitudes[u], longitudes[u], latitudes[v], longitudes[v]);
+            if (km > 0) {
+                maxCostPerKm = std::min(maxCostPerKm, graph->getArcWeight(arc) / km);
+            }
+        }
+    }
+    return maxCostPerKm;
+}
@@ -1,118 +1,474 @@
 #include "algorithm/SampleBellmanFord.h"
+#include "util/SampleStats.h"
 #include <limits>
 #include <algorithm>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <queue>
+#include <functional>
+#include <utility>
 
 // Constructor implementation
-SampleBellmanFord::SampleBellmanFord(SampleNegativeGraph* graph) : graph(graph) {}
+SampleBellmanFord::SampleBellmanFord(SampleNegativeGraph* graph) : graph(graph), csrGraph(nullptr) {}
+
+SampleBellmanFord::SampleBellmanFord(const SampleCSRGraph* csrGraph) : graph(nullptr), csrGraph(csrGraph) {}
+
+const uint32_t SampleBellmanFord::NO_PARENT;
+
+const SampleCSRGraph* SampleBellmanFord::getSnapshot() {
+    return csrGraph != nullptr ? csrGraph : graph->freeze();
+}
+
+uint32_t SampleBellmanFord::getSource(const SampleCSRGraph* csr) const {
+    // Choose an arbitrary source vertex: the first one the negative graph
+    // lists, or vertex 0 of a bare snapshot
+    if (graph != nullptr && csr->getVertexCount() > 0) {
+        return graph->getAllVertices().begin()->second->getId();
+    }
+    return 0;
+}
+
+std::vector<SampleBellmanFord::Edge> SampleBellmanFord::buildEdgeList(const SampleCSRGraph* csr) {
+    std::vector<Edge> edges(csr->getArcCount());
+    for (uint32_t u = 0; u < csr->getVertexCount(); u++) {
+        for (uint32_t arc = csr->getArcBegin(u); arc < csr->getArcEnd(u); arc++) {
+            edges[arc].from = u;
+            edges[arc].to = csr->getArcTarget(arc);
+            edges[arc].weight = csr->getArcWeight(arc);
+        }
+    }
+    return edges;
+}
 
 // reconstructCycle implementation
 std::vector<SampleVertex*> SampleBellmanFord::reconstructCycle(
-    SampleVertex* cycleVertex, 
-    const std::unordered_map<SampleVertex*, SampleVertex*>& parent) 
+    const SampleCSRGraph* csr,
+    uint32_t cycleVertex,
+    const std::vector<uint32_t>& parent)
 {
-    std::vector<SampleVertex*> cycle;
-    SampleVertex* current = cycleVertex;
+    uint32_t n = csr->getVertexCount();
     
-    // Find a node in the cycle
-    std::unordered_set<SampleVertex*> visited;
-    for (int i = 0; i < parent.size(); ++i) {
-        if (!current || parent.find(current) == parent.end()) return {};
-        current = parent.at(current);
-        if (visited.count(current)) break;
-        visited.insert(current);
+    // Go back n steps to ensure we're in the cycle
+    for (uint32_t i = 0; i < n; i++) {
+        cycleVertex = parent[cycleVertex];
+        if (cycleVertex == NO_PARENT) {
+            SAMPLE_STATS_ADD(BellmanFordCycleWalk, i + 1);
+            return std::vector<SampleVertex*>();
+        }
     }
-    if (!current) return {};
     
-    // Reconstruct cycle
+    // Extract the cycle
+    std::vector<SampleVertex*> cycle;
+    uint32_t current = cycleVertex;
     do {
-        cycle.push_back(current);
-        current = parent.at(current);
-        if (cycle.size() > parent.size()) return {};
-    } while (current != cycleVertex && current != nullptr);
+        cycle.push_back(csr->getVertex(current));
+        current = parent[current];
+    } while (current != cycleVertex && current != NO_PARENT);
+    SAMPLE_STATS_ADD(BellmanFordCycleWalk, n + cycle.size());
     
+    // Reverse to get correct order
     std::reverse(cycle.begin(), cycle.end());
     return cycle;
 }
 
+// Any cycle of the parent graph, found by following parents from every
+// vertex in turn and marking each walk with its own stamp
+std::vector<SampleVertex*> SampleBellmanFord::findParentCycle(
+    const SampleCSRGraph* csr,
+    const std::vector<uint32_t>& parent)
+{
+    uint32_t n = csr->getVertexCount();
+    std::vector<uint32_t> walk(n, NO_PARENT);
+    SAMPLE_STATS_LOCAL(steps);
+    for (uint32_t start = 0; start < n; start++) {
+        uint32_t v = start;
+        while (v != NO_PARENT && walk[v] == NO_PARENT) {
+            walk[v] = start;
+            v = parent[v];
+            SAMPLE_STATS_INC(steps);
+        }
+        if (v != NO_PARENT && walk[v] == start) {
+            // This walk ran into itself, so v is on a cycle
+            SAMPLE_STATS_ADD(BellmanFordCycleWalk, steps);
+            return reconstructCycle(csr, v, parent);
+        }
+    }
+    SAMPLE_STATS_ADD(BellmanFordCycleWalk, steps);
+    return std::vector<SampleVertex*>();
+}
 
-std::vector<SampleVertex*> SampleBellmanFord::findNegativeCycle() {
-    // Get all vertices
-    std::vector<SampleVertex*> vertices;
-    for (const auto& pair : graph->getAllVertices()) {
-        vertices.push_back(pair.second);
+std::vector<SampleVertex*> SampleBellmanFord::findNegativeCycle(SampleThreadPool* pool) {
+    const SampleCSRGraph* csr = getSnapshot();
+    uint32_t n = csr->getVertexCount();
+    if (n == 0) {
+        return std::vector<SampleVertex*>();
+    }
+    if (pool != nullptr) {
+        return findNegativeCycleParallel(csr, pool);
     }
-    int n = vertices.size();
     
-    // Choose an arbitrary source vertex
-    SampleVertex* source = vertices[0];
+    uint32_t source = getSource(csr);
+    std::vector<Edge> edges = buildEdgeList(csr);
+    const double INF = std::numeric_limits<double>::max();
+    std::vector<double> dist(n, INF);
+    std::vector<uint32_t> parent(n, NO_PARENT);
+    dist[source] = 0.0;
+    SAMPLE_STATS_LOCAL(rounds);
+    SAMPLE_STATS_LOCAL(relaxations);
     
-    // Initialize distances and parent pointers
-    std::unordered_map<SampleVertex*, double> dist;
-    std::unordered_map<SampleVertex*, SampleVertex*> parent;
+    // Relax all edges up to n-1 times
+    for (uint32_t i = 0; i + 1 < n; i++) {
+        bool changed = false;
+        SAMPLE_STATS_INC(rounds);
+        for (const Edge& edge : edges) {
+            double du = dist[edge.from];
+            if (du != INF && du + edge.weight < dist[edge.to]) {
+                dist[edge.to] = du + edge.weight;
+                parent[edge.to] = edge.from;
+                changed = true;
+                SAMPLE_STATS_INC(relaxations);
+            }
+        }
+        if (!changed) break; // Converged, so there is no reachable negative cycle
+    }
+    SAMPLE_STATS_ADD(BellmanFordRounds, rounds);
+    SAMPLE_STATS_ADD(BellmanFordRelaxations, relaxations);
     
-    for (SampleVertex* v : vertices) {
-        dist[v] = std::numeric_limits<double>::max();
-        parent[v] = nullptr;
+    // Check for negative cycles
+    for (const Edge& edge : edges) {
+        double du = dist[edge.from];
+        if (du != INF && du + edge.weight < dist[edge.to]) {
+            // Found a negative cycle; link the arc so it is closed in parent
+            parent[edge.to] = edge.from;
+            return reconstructCycle(csr, edge.to, parent);
+        }
     }
-    dist[source] = 0.0;
     
-    // Relax all edges n-1 times
-    for (int i = 0; i < n - 1; i++) {
-        for (SampleVertex* u : vertices) {
-            for (SampleEdge* edge : u->getNeighbors()) {
-                SampleVertex* v = edge->getVertexT();
-                double weight = edge->getWeight();
-                
-                if (dist[u] != std::numeric_limits<double>::max() && dist[u] + weight < dist[v]) {
-                    dist[v] = dist[u] + weight;
-                    parent[v] = u;
+    // No negative cycle found
+    return std::vector<SampleVertex*>();
+}
+
+std::vector<SampleVertex*> SampleBellmanFord::findNegativeCycleParallel(const SampleCSRGraph* csr, SampleThreadPool* pool) {
+    uint32_t n = csr->getVertexCount();
+    uint32_t source = getSource(csr);
+    std::vector<Edge> arcs = buildEdgeList(csr);
+    
+    // Group the arcs by target (counting sort) so a chunk of targets owns
+    // every write to its distances and parents
+    std::vector<uint32_t> firstIn(n + 1, 0);
+    for (const Edge& edge : arcs) {
+        firstIn[edge.to + 1]++;
+    }
+    for (uint32_t v = 0; v < n; v++) {
+        firstIn[v + 1] += firstIn[v];
+    }
+    std::vector<Edge> edges(arcs.size());
+    std::vector<uint32_t> fill(firstIn.begin(), firstIn.end() - 1);
+    for (const Edge& edge : arcs) {
+        edges[fill[edge.to]++] = edge;
+    }
+    
+    // Chunk boundaries at target boundaries, a few chunks per worker with
+    // about the same number of arcs each
+    size_t chunkCount = std::min<size_t>(static_cast<size_t>(pool->getThreadCount()) * 4, n);
+    std::vector<uint32_t> chunkStart(1, 0);
+    for (size_t c = 1; c < chunkCount; c++) {
+        size_t goal = edges.size() * c / chunkCount;
+        uint32_t v = static_cast<uint32_t>(std::lower_bound(firstIn.begin(), firstIn.end(), goal) - firstIn.begin());
+        if (v > chunkStart.back() && v < n) {
+            chunkStart.push_back(v);
+        }
+    }
+    chunkStart.push_back(n);
+    chunkCount = chunkStart.size() - 1;
+    
+    // Other chunks read distances while they are written, so they are
+    // atomics; relaxed order is enough because the pool run is the barrier
+    const double INF = std::numeric_limits<double>::max();
+    std::unique_ptr<std::atomic<double>[]> dist(new std::atomic<double>[n]);
+    for (uint32_t v = 0; v < n; v++) {
+        dist[v].store(INF, std::memory_order_relaxed);
+    }
+    dist[source].store(0.0, std::memory_order_relaxed);
+    std::vector<uint32_t> parent(n, NO_PARENT);
+    std::atomic<bool> changed(false);
+    
+    auto relaxChunk = [&](size_t chunk, unsigned) {
+        bool chunkChanged = false;
+        SAMPLE_STATS_LOCAL(relaxations);
+        for (uint32_t v = chunkStart[chunk]; v < chunkStart[chunk + 1]; v++) {
+            double before = dist[v].load(std::memory_order_relaxed);
+            double dv = before;
+            uint32_t pv = parent[v];
+            for (uint32_t e = firstIn[v]; e < firstIn[v + 1]; e++) {
+                double du = dist[edges[e].from].load(std::memory_order_relaxed);
+                if (du != INF && du + edges[e].weight < dv) {
+                    dv = du + edges[e].weight;
+                    pv = edges[e].from;
                 }
             }
+            if (dv < before) {
+                dist[v].store(dv, std::memory_order_relaxed);
+                parent[v] = pv;
+                chunkChanged = true;
+                SAMPLE_STATS_INC(relaxations);
+            }
+        }
+        SAMPLE_STATS_ADD(BellmanFordRelaxations, relaxations);
+        if (chunkChanged) {
+            changed.store(true, std::memory_order_relaxed);
+        }
+    };
+    
+    // Round n changing anything proves a reachable negative cycle, but a
+    // cycle usually closes in the parent graph much earlier; look for one
+    // after rounds 1, 2, 4, 8, ... to keep the serial scan cheap
+    uint32_t nextCheck = 1;
+    for (uint32_t round = 1; ; round++) {
+        changed.store(false, std::memory_order_relaxed);
+        pool->run(chunkCount, relaxChunk);
+        SAMPLE_STATS_ADD(BellmanFordRounds, 1);
+        if (!changed.load(std::memory_order_relaxed)) {
+            return std::vector<SampleVertex*>(); // Converged, no reachable negative cycle
+        }
+        if (round == nextCheck || round >= n) {
+            std::vector<SampleVertex*> cycle = findParentCycle(csr, parent);
+            if (!cycle.empty()) {
+                return cycle;
+            }
+            if (round == nextCheck) {
+                nextCheck *= 2;
+            }
+            if (round >= 2 * n) {
+                // Should not happen, but never loop forever
+                return findNegativeCycle();
+            }
         }
     }
+}
+
+std::vector<SampleVertex*> SampleBellmanFord::findNegativeCycleSPFA() {
+    const SampleCSRGraph* csr = getSnapshot();
+    const uint32_t NONE = NO_PARENT;
+    uint32_t n = csr->getVertexCount();
+    uint32_t root = n; // virtual source with a zero arc to every vertex
+    if (n == 0) {
+        return std::vector<SampleVertex*>();
+    }
     
-    // Check for negative cycles
-    SampleVertex* cycleVertex = nullptr;
-    for (SampleVertex* u : vertices) {
-        for (SampleEdge* edge : u->getNeighbors()) {
-            SampleVertex* v = edge->getVertexT();
-            double weight = edge->getWeight();
+    const uint32_t* offsets = csr->getOffsets();
+    const uint32_t* targets = csr->getTargets();
+    const double* weights = csr->getWeights();
+    
+    // The shortest path tree is kept as a circular preorder list through the
+    // root, with depths, so the subtree of v is v followed by every vertex
+    // deeper than v up to the next one that is not
+    std::vector<double> dist(n, 0.0);
+    std::vector<uint32_t> parent(n + 1, root);
+    std::vector<uint32_t> next(n + 1), prev(n + 1), depth(n + 1, 1);
+    std::vector<char> inTree(n, 1), inQueue(n, 1);
+    std::deque<uint32_t> queue;
+    
+    // Initially every vertex hangs directly off the root, in id order
+    depth[root] = 0;
+    parent[root] = NONE;
+    for (uint32_t v = 0; v <= n; v++) {
+        next[v] = v == n ? 0 : v + 1;
+        prev[v] = v == 0 ? n : v - 1;
+        if (v < n) queue.push_back(v);
+    }
+    
+    // Counted into locals, added before each return
+    SAMPLE_STATS_LOCAL(pops);
+    SAMPLE_STATS_LOCAL(relaxations);
+    SAMPLE_STATS_LOCAL(walked);
+#define SAMPLE_SPFA_STATS() \
+    SAMPLE_STATS_ADD(BellmanFordRounds, pops); \
+    SAMPLE_STATS_ADD(BellmanFordRelaxations, relaxations); \
+    SAMPLE_STATS_ADD(BellmanFordCycleWalk, walked)
+    
+    while (!queue.empty()) {
+        uint32_t u = queue.front();
+        queue.pop_front();
+        if (!inQueue[u]) continue; // Left the tree since it was queued
+        inQueue[u] = 0;
+        SAMPLE_STATS_INC(pops);
+        
+        for (uint32_t arc = offsets[u]; arc < offsets[u + 1]; arc++) {
+            uint32_t v = targets[arc];
+            double newDist = dist[u] + weights[arc];
+            if (!(newDist < dist[v])) continue;
+            SAMPLE_STATS_INC(relaxations);
+            if (v == u) {
+                // Negative self-loop
+                SAMPLE_SPFA_STATS();
+                return std::vector<SampleVertex*>(1, csr->getVertex(u));
+            }
+            
+
+            // Disassemble the subtree of v: its vertices are about to get
+            // shorter paths through v anyway, so drop them from the tree and
+            // the queue. Finding u in there means u..v..u is a negative cycle.
+            if (inTree[v]) {
+                uint32_t last = v;
+                for (uint32_t x = next[v]; depth[x] > depth[v]; x = next[x]) {
+                    SAMPLE_STATS_INC(walked);
+                    if (x == u) {
+                        // Walk the tree path from u up to v; with the arc u->v it closes the cycle
+                        std::vector<SampleVertex*> cycle;
+                        for (uint32_t at = u; at != v; at = parent[at]) {
+                            cycle.push_back(csr->getVertex(at));
+                        }
+                        cycle.push_back(csr->getVertex(v));
+                        std::reverse(cycle.begin(), cycle.end());
+                        SAMPLE_STATS_ADD(BellmanFordCycleWalk, cycle.size());
+                        SAMPLE_SPFA_STATS();
+                        return cycle;
+                    }
+                    inTree[x] = 0;
+                    inQueue[x] = 0;
+                    last = x;
+                }
+                // Unlink v and its former subtree
+                next[prev[v]] = next[last];
+                prev[next[last]] = prev[v];
+            }
             
-            if (dist[u] != std::numeric_limits<double>::max() && dist[u] + weight < dist[v]) {
-                // Found a negative cycle
-                cycleVertex = v;
-                break;
+            // Hang v under u
+            dist[v] = newDist;
+            parent[v] = u;
+            depth[v] = depth[u] + 1;
+            inTree[v] = 1;
+            next[v] = next[u];
+            prev[v] = u;
+            prev[next[u]] = v;
+            next[u] = v;
+            
+            if (!inQueue[v]) {
+                inQueue[v] = 1;
+                queue.push_back(v);
             }
         }
-        if (cycleVertex != nullptr) break;
     }
     
-    // If no negative cycle found
-    if (cycleVertex == nullptr) {
-        return std::vector<SampleVertex*>();
+    SAMPLE_SPFA_STATS();
+#undef SAMPLE_SPFA_STATS
+    return std::vector<SampleVertex*>();
+}
+
+std::vector<SampleBellmanFord::RankedCycle> SampleBellmanFord::findTopCycles(
+    SampleVertex* through, size_t k, uint32_t maxArcs, bool disjoint, size_t maxLabels)
+{
+    std::vector<RankedCycle> result;
+    if (through == nullptr) {
+        return result;
+    }
+    const SampleCSRGraph* csr = getSnapshot();
+    uint32_t n = csr->getVertexCount();
+    uint32_t start = through->getId();
+    if (k == 0 || maxArcs == 0 || start >= n || csr->getVertex(start) != through) {
+        return result;
     }
     
-    // Find the cycle
-    std::unordered_set<SampleVertex*> visited;
+    const uint32_t* offsets = csr->getOffsets();
+    const uint32_t* targets = csr->getTargets();
+    const double* weights = csr->getWeights();
+    const double INF = std::numeric_limits<double>::max();
     
-    // Go back n steps to ensure we're in the cycle
-    for (int i = 0; i < n; i++) {
-        cycleVertex = parent[cycleVertex];
-        if (cycleVertex == nullptr) return std::vector<SampleVertex*>(); // Handle potential null pointer
+    // back[s * n + v]: cheapest walk from v to start using at most s arcs.
+    // Walks may repeat vertices, so this never overestimates a simple path.
+    std::vector<double> back(static_cast<size_t>(maxArcs + 1) * n, INF);
+    back[start] = 0.0;
+    for (uint32_t steps = 1; steps <= maxArcs; steps++) {
+        const double* previous = &back[static_cast<size_t>(steps - 1) * n];
+        double* current = &back[static_cast<size_t>(steps) * n];
+        for (uint32_t v = 0; v < n; v++) {
+            double best = previous[v];
+            if (v != start) {
+                for (uint32_t arc = offsets[v]; arc < offsets[v + 1]; arc++) {
+                    double rest = previous[targets[arc]];
+                    if (rest != INF && weights[arc] + rest < best) {
+                        best = weights[arc] + rest;
+                    }
+                }
+            }
+            current[v] = best;
+        }
     }
     
-    // Extract the cycle
-    std::vector<SampleVertex*> cycle;
-    SampleVertex* current = cycleVertex;
+    // Partial paths from start, linked back through their parent label
+    struct Label {
+        uint32_t vertex;
+        uint32_t parent;
+        uint32_t arcs;
+        double cost;
+    };
+    std::vector<Label> labels;
+    std::vector<char> used(n, 0); // vertices taken by an earlier disjoint cycle
     
-    do {
-        cycle.push_back(current);
-        current = parent[current];
-        if (current == nullptr) break; // Safety check
-    } while (current != cycleVertex && std::find(cycle.begin(), cycle.end(), current) == cycle.end());
+    // Open labels by (cost + bound, label index); the index breaks ties in
+    // the order labels were created
+    typedef std::pair<double, uint32_t> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > open;
+    Label first = { start, NO_PARENT, 0, 0.0 };
+    labels.push_back(first);
+    open.push(Entry(-INF, 0));
     
-    // Reverse to get correct order
-    std::reverse(cycle.begin(), cycle.end());
+    auto onPath = [&](uint32_t label, uint32_t v) {
+        for (; label != NO_PARENT; label = labels[label].parent) {
+            if (labels[label].vertex == v) return true;
+        }
+        return false;
+    };
     
-    return cycle;
-}
\ No newline at end of file
+    while (!open.empty() && result.size() < k) {
+        Entry top = open.top();
+        open.pop();
+        if (top.first >= 0.0) break; // Nothing profitable left
+        
+        Label label = labels[top.second];
+        if (label.vertex == start && label.arcs > 0) {
+            // A closed cycle; every open entry is at least as costly
+            std::vector<uint32_t> ids;
+            for (uint32_t at = labels[top.second].parent; at != NO_PARENT; at = labels[at].parent) {
+                ids.push_back(labels[at].vertex);
+            }
+            std::reverse(ids.begin(), ids.end());
+            
+            bool overlaps = false;
+            for (uint32_t id : ids) {
+                overlaps = overlaps || used[id];
+            }
+            if (overlaps) continue;
+            
+            RankedCycle cycle;
+            for (uint32_t id : ids) {
+                cycle.vertices.push_back(csr->getVertex(id));
+                if (disjoint && id != start) used[id] = 1;
+            }
+            cycle.weight = label.cost;
+            result.push_back(cycle);
+            continue;
+        }
+        if (label.vertex != start && used[label.vertex]) continue;
+        
+        uint32_t remaining = maxArcs - label.arcs - 1; // arcs left after this one
+        for (uint32_t arc = offsets[label.vertex]; arc < offsets[label.vertex + 1]; arc++) {
+            uint32_t v = targets[arc];
+            double rest = back[static_cast<size_t>(remaining) * n + v];
+            if (rest == INF || used[v]) continue;
+            if (v != start && onPath(top.second, v)) continue;
+            
+            double cost = label.cost + weights[arc];
+            if (cost + rest >= 0.0) continue; // Cannot close into a profitable cycle
+            if (labels.size() >= maxLabels) {
+                return result; // Work budget spent
+            }
+            Label next = { v, top.second, label.arcs + 1, cost };
+            labels.push_back(next);
+            open.push(Entry(cost + rest, static_cast<uint32_t>(labels.size() - 1)));
+        }
+    }
+    return result;
+}
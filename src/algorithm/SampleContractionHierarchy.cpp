@@ -0,0 +1,347 @@
+// SampleContractionHierarchy.cpp
+#include "algorithm/SampleContractionHierarchy.h"
+#include <stdexcept>
+#include <limits>
+#include <algorithm>
+
+namespace {
+
+// Witness searches for the priorities only estimate the shortcut count, so
+// they settle far fewer vertices than the searches for the real shortcuts
+const uint32_t PRIORITY_SETTLE_LIMIT = 30;
+
+struct ContractionArc {
+    uint32_t target;
+    double weight;
+    uint32_t middle;
+};
+
+struct Shortcut {
+    uint32_t from;
+    uint32_t to;
+    double weight;
+};
+
+typedef std::vector<std::vector<ContractionArc> > Adjacency;
+
+// Inserts the undirected arc from-to, or lowers its weight if it already exists
+void addArc(Adjacency& adjacency, uint32_t from, uint32_t to, double weight, uint32_t middle) {
+    for (ContractionArc& arc : adjacency[from]) {
+        if (arc.target == to) {
+            if (weight < arc.weight) {
+                arc.weight = weight;
+                arc.middle = middle;
+            }
+            return;
+        }
+    }
+    ContractionArc arc = { to, weight, middle };
+    adjacency[from].push_back(arc);
+}
+
+// Dijkstra from source in the remaining graph without the excluded vertex,
+// bounded by distance and by the number of settled vertices, and done once
+// the targetCount vertices marked in isTarget are settled
+void witnessSearch(const Adjacency& adjacency, uint32_t source, uint32_t excluded,
+                   double maxDistance, uint32_t settleLimit, const std::vector<char>& isTarget,
+                   uint32_t targetCount, SampleQueryContext& context) {
+    SampleIndexedDaryHeap<4>& heap = context.getFourAryHeap();
+    context.reset(static_cast<uint32_t>(adjacency.size()));
+    heap.reset(static_cast<uint32_t>(adjacency.size()));
+    context.setDistance(source, 0, SampleQueryContext::NO_VERTEX);
+    heap.push(source, 0);
+
+    uint32_t settledCount = 0;
+    while (!heap.empty() && heap.topKey() <= maxDistance && settledCount < settleLimit) {
+        uint32_t u = heap.pop();
+        context.setSettled(u);
+        settledCount++;
+        if (isTarget[u] && --targetCount == 0) break;
+
+        double du = context.getDistance(u);
+        for (const ContractionArc& arc : adjacency[u]) {
+            if (arc.target == excluded || context.isSettled(arc.target)) continue;
+            double newDist = du + arc.weight;
+            if (newDist < context.getDistance(arc.target)) {
+                context.setDistance(arc.target, newDist, u);
+                heap.push(arc.target, newDist);
+            }
+        }
+    }
+}
+
+// Shortcuts needed to contract v: u-v-w needs one unless a witness path
+// u..w that avoids v is at most as long. An unfinished witness search
+// conservatively keeps the shortcut. isTarget is all zero scratch space,
+// one entry per vertex, and is left that way.
+void findShortcuts(const Adjacency& adjacency, uint32_t v, uint32_t settleLimit,
+                   SampleQueryContext& context, std::vector<char>& isTarget, std::vector<Shortcut>& shortcuts) {
+    shortcuts.clear();
+    const std::vector<ContractionArc>& neighbors = adjacency[v];
+
+    for (size_t i = 0; i + 1 < neighbors.size(); i++) {
+        // The search from u only has to reach the neighbours after it, no
+        // farther than the longest path through v to one of them
+        uint32_t u = neighbors[i].target;
+        double farthest = 0;
+        for (size_t j = i + 1; j < neighbors.size(); j++) {
+            isTarget[neighbors[j].target] = 1;
+            farthest = std::max(farthest, neighbors[j].weight);
+        }
+        witnessSearch(adjacency, u, v, neighbors[i].weight + farthest, settleLimit, isTarget,
+                      static_cast<uint32_t>(neighbors.size() - i - 1), context);
+        for (size_t j = i + 1; j < neighbors.size(); j++) {
+            isTarget[neighbors[j].target] = 0;
+        }
+        for (size_t j = i + 1; j < neighbors.size(); j++) {
+            double via = neighbors[i].weight + neighbors[j].weight;
+            if (context.getDistance(neighbors[j].target) > via) {
+                Shortcut shortcut = { u, neighbors[j].target, via };
+                shortcuts.push_back(shortcut);
+            }
+        }
+    }
+}
+
+} // namespace
+
+SampleContractionHierarchy::SampleContractionHierarchy(const SampleCSRGraph* graph, uint32_t witnessSettleLimit) {
+    if (!graph->isUndirected()) {
+        throw std::runtime_error("Contraction hierarchy needs an undirected graph");
+    }
+    this->graph = graph;
+    this->shortcutCount = 0;
+    contract(witnessSettleLimit);
+}
+
+void SampleContractionHierarchy::contract(uint32_t settleLimit) {
+    uint32_t n = graph->getVertexCount();
+
+    // Working copy of the graph without self-loops and parallel arcs
+    Adjacency adjacency(n);
+    for (uint32_t u = 0; u < n; u++) {
+        for (uint32_t arc = graph->getArcBegin(u); arc < graph->getArcEnd(u); arc++) {
+            uint32_t v = graph->getArcTarget(arc);
+            if (v != u) {
+                addArc(adjacency, u, v, graph->getArcWeight(arc), SampleQueryContext::NO_VERTEX);
+            }
+        }
+    }
+
+    SampleQueryContext witness(n);
+    std::vector<char> isTarget(n, 0);
+    std::vector<Shortcut> shortcuts;
+    std::vector<uint32_t> contractedNeighbors(n, 0);
+    std::vector<std::vector<ContractionArc> > upLists(n);
+    rank.assign(n, 0);
+
+    // Priority = edge difference + contracted neighbours, lowest first
+    SampleIndexedDaryHeap<4> order;
+    order.reset(n);
+    for (uint32_t v = 0; v < n; v++) {
+        findShortcuts(adjacency, v, PRIORITY_SETTLE_LIMIT, witness, isTarget, shortcuts);
+        order.push(v, static_cast<double>(shortcuts.size()) - static_cast<double>(adjacency[v].size()));
+    }
+
+    uint32_t nextRank = 0;
+    while (!order.empty()) {
+        uint32_t v = order.pop();
+
+        // Priorities go stale as neighbours get contracted; recompute lazily
+        // and put v back if it is no longer the cheapest
+        findShortcuts(adjacency, v, PRIORITY_SETTLE_LIMIT, witness, isTarget, shortcuts);
+        double priority = static_cast<double>(shortcuts.size()) - static_cast<double>(adjacency[v].size())
+                          + contractedNeighbors[v];
+        if (!order.empty() && priority > order.topKey()) {
+            order.push(v, priority);
+            continue;
+        }
+
+        // The shortcuts actually added come from the full witness searches
+        findShortcuts(adjacency, v, settleLimit, witness, isTarget, shortcuts);
+
+        // Every remaining neighbour is ranked above v
+        rank[v] = nextRank++;
+        upLists[v] = adjacency[v];
+
+        for (const Shortcut& shortcut : shortcuts) {
+            addArc(adjacency, shortcut.from, shortcut.to, shortcut.weight, v);
+            addArc(adjacency, shortcut.to, shortcut.from, shortcut.weight, v);
+        }
+        shortcutCount += static_cast<uint32_t>(shortcuts.size());
+
+        // Drop v from the remaining graph
+        for (const ContractionArc& arc : adjacency[v]) {
+            std::vector<ContractionArc>& list = adjacency[arc.target];
+            for (size_t i = 0; i < list.size(); i++) {
+                if (list[i].target == v) {
+                    list[i] = list.back();
+                    list.pop_back();
+                    break;
+                }
+            }
+            contractedNeighbors[arc.target]++;
+        }
+        std::vector<ContractionArc>().swap(adjacency[v]);
+    }
+
+    // Flatten the upward arcs into CSR form
+    upOffsets.assign(n + 1, 0);
+    for (uint32_t v = 0; v < n; v++) {
+        upOffsets[v + 1] = upOffsets[v] + static_cast<uint32_t>(upLists[v].size());
+    }
+    upTargets.reserve(upOffsets[n]);
+    upWeights.reserve(upOffsets[n]);
+    upMiddles.reserve(upOffsets[n]);
+    for (uint32_t v = 0; v < n; v++) {
+        for (const ContractionArc& arc : upLists[v]) {
+            upTargets.push_back(arc.target);
+            upWeights.push_back(arc.weight);
+            upMiddles.push_back(arc.middle);
+        }
+    }
+}
+
+uint32_t SampleContractionHierarchy::findUpArc(uint32_t from, uint32_t to) const {
+    // Arcs are stored once, at their lower ranked end
+    uint32_t low = rank[from] < rank[to] ? from : to;
+    uint32_t high = low == from ? to : from;
+    uint32_t i = upOffsets[low];
+    while (upTargets[i] != high) {
+        i++;
+    }
+    return i;
+}
+
+void SampleContractionHierarchy::unpackArc(uint32_t from, uint32_t to, std::vector<uint32_t>& path) const {
+    // Appends the original vertices after from up to and including to.
+    // A shortcut a-b with middle m unpacks into a-m and m-b, both of which
+    // are stored at m because m was contracted before a and b.
+    std::vector<std::pair<uint32_t, uint32_t> > pending;
+    pending.push_back(std::make_pair(from, to));
+    while (!pending.empty()) {
+        std::pair<uint32_t, uint32_t> arc = pending.back();
+        pending.pop_back();
+        uint32_t middle = upMiddles[findUpArc(arc.first, arc.second)];
+        if (middle == SampleQueryContext::NO_VERTEX) {
+            path.push_back(arc.second);
+        } else {
+            pending.push_back(std::make_pair(middle, arc.second));
+            pending.push_back(std::make_pair(arc.first, middle));
+        }
+    }
+}
+
+// Upward bidirectional search. Each side only follows arcs to higher ranked
+// vertices; the search ends once both smallest keys reach the best meeting
+// distance.
+template <typename Heap>
+static double upwardKernel(const std::vector<uint32_t>& upOffsets, const std::vector<uint32_t>& upTargets,
+                           const std::vector<double>& upWeights, uint32_t source, uint32_t target,
+                           SampleQueryContext& forward, Heap& forwardHeap,
+                           SampleQueryContext& backward, Heap& backwardHeap, uint32_t& meet) {
+    const double INF = std::numeric_limits<double>::max();
+    uint32_t n = static_cast<uint32_t>(upOffsets.size() - 1);
+    forwardHeap.reset(n);
+    backwardHeap.reset(n);
+    forward.setDistance(source, 0, SampleQueryContext::NO_VERTEX);
+    backward.setDistance(target, 0, SampleQueryContext::NO_VERTEX);
+    forwardHeap.push(source, 0);
+    backwardHeap.push(target, 0);
+
+    double best = INF;
+    meet = SampleQueryContext::NO_VERTEX;
+    if (source == target) {
+        meet = source;
+        return 0;
+    }
+
+    while (true) {
+        double forwardKey = forwardHeap.empty() ? INF : forwardHeap.topKey();
+        double backwardKey = backwardHeap.empty() ? INF : backwardHeap.topKey();
+        if (std::min(forwardKey, backwardKey) >= best) break;
+
+        bool forwardSide = forwardKey <= backwardKey;
+        SampleQueryContext& side = forwardSide ? forward : backward;
+        SampleQueryContext& other = forwardSide ? backward : forward;
+        Heap& heap = forwardSide ? forwardHeap : backwardHeap;
+
+        uint32_t u = heap.pop();
+        if (side.isSettled(u)) continue; // Stale entry
+        side.setSettled(u);
+
+        double du = side.getDistance(u);
+        
+        // Stall-on-demand: the graph is undirected, so an up-arc u-v is also
+        // a down-arc into u. If it reaches u cheaper, du is not a shortest
+        // distance and nothing needs to be relaxed from u.
+        bool stalled = false;
+        for (uint32_t i = upOffsets[u]; i < upOffsets[u + 1] && !stalled; i++) {
+            stalled = side.getDistance(upTargets[i]) + upWeights[i] < du;
+        }
+        if (stalled) continue;
+        
+        for (uint32_t i = upOffsets[u]; i < upOffsets[u + 1]; i++) {
+            uint32_t v = upTargets[i];
+            double newDist = du + upWeights[i];
+            if (newDist < side.getDistance(v)) {
+                side.setDistance(v, newDist, u);
+                heap.push(v, newDist);
+            }
+            if (other.isTouched(v) && side.getDistance(v) + other.getDistance(v) < best) {
+                best = side.getDistance(v) + other.getDistance(v);
+                meet = v;
+            }
+        }
+    }
+    return best;
+}
+
+double SampleContractionHierarchy::findShortestPath(uint32_t source, uint32_t target,
+                                                    SampleQueryContext& forward, SampleQueryContext& backward,
+                                                    std::vector<uint32_t>* path) const {
+    uint32_t n = graph->getVertexCount();
+    forward.reset(n);
+    forward.setSource(source);
+    backward.reset(n);
+    backward.setSource(target);
+
+    uint32_t meet;
+    double distance;
+    switch (forward.getHeapType()) {
+    case SampleHeapType::Binary:
+        distance = upwardKernel(upOffsets, upTargets, upWeights, source, target,
+                                forward, forward.getBinaryHeap(), backward, backward.getBinaryHeap(), meet);
+        break;
+    case SampleHeapType::Radix:
+        distance = upwardKernel(upOffsets, upTargets, upWeights, source, target,
+                                forward, forward.getRadixHeap(), backward, backward.getRadixHeap(), meet);
+        break;
+    default:
+        distance = upwardKernel(upOffsets, upTargets, upWeights, source, target,
+                                forward, forward.getFourAryHeap(), backward, backward.getFourAryHeap(), meet);
+        break;
+    }
+
+    if (path != nullptr) {
+        path->clear();
+        if (meet == SampleQueryContext::NO_VERTEX) {
+            return distance; // Target not reachable
+        }
+
+        // Up-path source..meet, then down-path meet..target, arc by arc
+        std::vector<uint32_t> upward;
+        for (uint32_t at = meet; at != SampleQueryContext::NO_VERTEX; at = forward.getParent(at)) {
+            upward.push_back(at);
+        }
+        std::reverse(upward.begin(), upward.end());
+        path->push_back(source);
+        for (size_t i = 0; i + 1 < upward.size(); i++) {
+            unpackArc(upward[i], upward[i + 1], *path);
+        }
+        for (uint32_t at = meet; backward.getParent(at) != SampleQueryContext::NO_VERTEX; at = backward.getParent(at)) {
+            unpackArc(at, backward.getParent(at), *path);
+        }
+    }
+    return distance;
+}
@@ -0,0 +1,313 @@
+// SampleCycleRatio.cpp
+#include "algorithm/SampleCycleRatio.h"
+#include <stdexcept>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
+static const uint32_t NONE = 0xFFFFFFFFu;
+
+// Relative slack for comparing ratios and potentials, so rounding noise
+// cannot make the policy flip back and forth
+static const double TOLERANCE = 1e-10;
+
+// Safety net; Howard needs far fewer rounds in practice
+static const uint32_t MAX_ITERATIONS = 100000;
+
+SampleCycleRatio::SampleCycleRatio(const SampleCSRGraph* graph) {
+    this->graph = graph;
+    this->iterations = 0;
+}
+
+SampleCycleRatio::RatioCycle SampleCycleRatio::makeCycle(const std::vector<uint32_t>& vertices,
+                                                         const std::vector<uint32_t>& arcs,
+                                                         const std::vector<double>& times) const {
+    RatioCycle cycle;
+    cycle.cost = 0;
+    cycle.time = 0;
+    for (size_t i = 0; i < arcs.size(); i++) {
+        cycle.vertices.push_back(graph->getVertex(vertices[i]));
+        cycle.cost += graph->getArcWeight(arcs[i]);
+        cycle.time += times.empty() ? 1.0 : times[arcs[i]];
+    }
+    cycle.ratio = cycle.time > 0 ? cycle.cost / cycle.time : 0;
+    return cycle;
+}
+
+SampleCycleRatio::RatioCycle SampleCycleRatio::findMinimumRatioCycle(const std::vector<double>& times) {
+    uint32_t n = graph->getVertexCount();
+    uint32_t m = graph->getArcCount();
+    const uint32_t* offsets = graph->getOffsets();
+    const uint32_t* targets = graph->getTargets();
+    const double* weights = graph->getWeights();
+    iterations = 0;
+
+    if (!times.empty()) {
+        if (times.size() != m) {
+            throw std::runtime_error("Cycle ratio needs one time per arc");
+        }
+        for (double time : times) {
+            if (!(time > 0)) {
+                throw std::runtime_error("Cycle ratio needs positive arc times");
+            }
+        }
+    }
+    auto timeOf = [&](uint32_t arc) { return times.empty() ? 1.0 : times[arc]; };
+
+    // Only vertices that can reach a cycle take part; peel off the ones
+    // whose every out-arc ends in a dead end
+    std::vector<uint32_t> inOffsets(n + 1, 0);
+    for (uint32_t arc = 0; arc < m; arc++) {
+        inOffsets[targets[arc] + 1]++;
+    }
+    for (uint32_t v = 0; v < n; v++) {
+        inOffsets[v + 1] += inOffsets[v];
+    }
+    std::vector<uint32_t> inSources(m);
+    std::vector<uint32_t> fill(inOffsets.begin(), inOffsets.end() - 1);
+    for (uint32_t u = 0; u < n; u++) {
+        for (uint32_t arc = offsets[u]; arc < offsets[u + 1]; arc++) {
+            inSources[fill[targets[arc]]++] = u;
+        }
+    }
+    std::vector<uint32_t> liveOut(n);
+    std::vector<uint32_t> deadEnds;
+    for (uint32_t v = 0; v < n; v++) {
+        liveOut[v] = offsets[v + 1] - offsets[v];
+        if (liveOut[v] == 0) deadEnds.push_back(v);
+    }
+    while (!deadEnds.empty()) {
+        uint32_t x = deadEnds.back();
+        deadEnds.pop_back();
+        for (uint32_t i = inOffsets[x]; i < inOffsets[x + 1]; i++) {
+            if (--liveOut[inSources[i]] == 0) deadEnds.push_back(inSources[i]);
+        }
+    }
+
+    // Initial policy: the cheapest live out-arc of every live vertex
+    std::vector<uint32_t> policy(n, NONE);
+    bool anyLive = false;
+    for (uint32_t u = 0; u < n; u++) {
+        if (liveOut[u] == 0) continue;
+        anyLive = true;
+        for (uint32_t arc = offsets[u]; arc < offsets[u + 1]; arc++) {
+            if (liveOut[targets[arc]] == 0) continue;
+            if (policy[u] == NONE || weights[arc] < weights[policy[u]]) {
+                policy[u] = arc;
+            }
+        }
+    }
+    if (!anyLive) {
+        return makeCycle(std::vector<uint32_t>(), std::vector<uint32_t>(), times);
+    }
+
+    std::vector<double> ratio(n, 0.0);
+    std::vector<double> potential(n, 0.0);
+    std::vector<uint32_t> walk(n);
+    std::vector<char> done(n);
+    std::vector<uint32_t> stack;
+
+    while (true) {
+        // Evaluate the policy: follow policy arcs from every vertex until a
+        // known vertex or a new cycle, then fill in ratios and potentials
+        // with potential(u) = cost - ratio * time + potential(next)
+        std::fill(walk.begin(), walk.end(), NONE);
+        std::fill(done.begin(), done.end(), 0);
+        for (uint32_t s = 0; s < n; s++) {
+            if (policy[s] == NONE || walk[s] != NONE) continue;
+            stack.clear();
+            uint32_t v = s;
+            while (walk[v] == NONE) {
+                walk[v] = s;
+                stack.push_back(v);
+                v = targets[policy[v]];
+            }
+            if (walk[v] == s && !done[v]) {
+                // Closed a new cycle at v
+                double cost = 0, time = 0;
+                uint32_t u = v;
+                do {
+                    cost += weights[policy[u]];
+                    time += timeOf(policy[u]);
+                    u = targets[policy[u]];
+                } while (u != v);
+                double cycleRatio = cost / time;
+                potential[v] = 0;
+                for (u = v; targets[policy[u]] != v; u = targets[policy[u]]) {
+                    uint32_t next = targets[policy[u]];
+                    potential[next] = potential[u] - weights[policy[u]] + cycleRatio * timeOf(policy[u]);
+                }
+                u = v;
+                do {
+                    ratio[u] = cycleRatio;
+                    done[u] = 1;
+                    u = targets[policy[u]];
+                } while (u != v);
+            }
+            while (!stack.empty()) {
+                uint32_t u = stack.back();
+                stack.pop_back();
+                if (done[u]) continue;
+                uint32_t next = targets[policy[u]];
+                ratio[u] = ratio[next];
+                potential[u] = weights[policy[u]] - ratio[u] * timeOf(policy[u]) + potential[next];
+                done[u] = 1;
+            }
+        }
+
+        if (++iterations >= MAX_ITERATIONS) break;
+
+        // Improve: first switch to arcs that reach a smaller ratio
+        bool changed = false;
+        for (uint32_t u = 0; u < n; u++) {
+            if (policy[u] == NONE) continue;
+            double slack = TOLERANCE * std::max(1.0, std::fabs(ratio[u]));
+            double best = ratio[u] - slack;
+            for (uint32_t arc = offsets[u]; arc < offsets[u + 1]; arc++) {
+                uint32_t v = targets[arc];
+                if (liveOut[v] != 0 && ratio[v] < best) {
+                    best = ratio[v];
+                    policy[u] = arc;
+                    changed = true;
+                }
+            }
+        }
+        if (changed) continue;
+
+        // Same ratio everywhere reachable: switch to arcs with a smaller potential
+        for (uint32_t u = 0; u < n; u++) {
+            if (policy[u] == NONE) continue;
+            double ratioSlack = TOLERANCE * std::max(1.0, std::fabs(ratio[u]));
+            double best = potential[u] - TOLERANCE * std::max(1.0, std::fabs(potential[u]));
+            for (uint32_t arc = offsets[u]; arc < offsets[u + 1]; arc++) {
+                uint32_t v = targets[arc];
+                if (liveOut[v] == 0 || std::fabs(ratio[v] - ratio[u]) > ratioSlack) continue;
+                double value = weights[arc] - ratio[u] * timeOf(arc) + potential[v];
+                if (value < best) {
+                    best = value;
+                    policy[u] = arc;
+                    changed = true;
+                }
+            }
+        }
+        if (!changed) break;
+    }
+
+    // The best vertex leads into a cycle with the minimum ratio
+    uint32_t best = NONE;
+    for (uint32_t u = 0; u < n; u++) {
+        if (policy[u] != NONE && (best == NONE || ratio[u] < ratio[best])) {
+            best = u;
+        }
+    }
+    std::fill(walk.begin(), walk.end(), NONE);
+    uint32_t v = best;
+    while (walk[v] == NONE) {
+        walk[v] = 0;
+        v = targets[policy[v]];
+    }
+    std::vector<uint32_t> cycleVertices, cycleArcs;
+    uint32_t u = v;
+    do {
+        cycleVertices.push_back(u);
+        cycleArcs.push_back(policy[u]);
+        u = targets[policy[u]];
+    } while (u != v);
+    return makeCycle(cycleVertices, cycleArcs, times);
+}
+
+SampleCycleRatio::RatioCycle SampleCycleRatio::findMinimumMeanCycleKarp() const {
+    uint32_t n = graph->getVertexCount();
+    const uint32_t* offsets = graph->getOffsets();
+    const uint32_t* targets = graph->getTargets();
+    const double* weights = graph->getWeights();
+    const double INF = std::numeric_limits<double>::max();
+
+    // cheapest[k * n + v]: cheapest walk of exactly k arcs ending in v,
+    // starting anywhere; via[k * n + v] is its last arc
+    std::vector<double> cheapest(static_cast<size_t>(n + 1) * n, INF);
+    std::vector<uint32_t> via(static_cast<size_t>(n + 1) * n, NONE);
+    std::vector<uint32_t> arcSource(graph->getArcCount());
+    for (uint32_t u = 0; u < n; u++) {
+        cheapest[u] = 0;
+        for (uint32_t arc = offsets[u]; arc < offsets[u + 1]; arc++) {
+            arcSource[arc] = u;
+        }
+    }
+    for (uint32_t k = 1; k <= n; k++) {
+        const double* previous = &cheapest[static_cast<size_t>(k - 1) * n];
+        double* current = &cheapest[static_cast<size_t>(k) * n];
+        uint32_t* currentVia = &via[static_cast<size_t>(k) * n];
+        for (uint32_t u = 0; u < n; u++) {
+            if (previous[u] == INF) continue;
+            for (uint32_t arc = offsets[u]; arc < offsets[u + 1]; arc++) {
+                double candidate = previous[u] + weights[arc];
+                if (candidate < current[targets[arc]]) {
+                    current[targets[arc]] = candidate;
+                    currentVia[targets[arc]] = arc;
+                }
+            }
+        }
+    }
+
+    // mean = min over v of max over k of (D_n(v) - D_k(v)) / (n - k)
+    double bestMean = INF;
+    uint32_t best = NONE;
+    for (uint32_t v = 0; v < n; v++) {
+        double last = cheapest[static_cast<size_t>(n) * n + v];
+        if (last == INF) continue;
+        double worst = -INF;
+        for (uint32_t k = 0; k < n; k++) {
+            double atK = cheapest[static_cast<size_t>(k) * n + v];
+            if (atK != INF) {
+                worst = std::max(worst, (last - atK) / (n - k));
+            }
+        }
+        if (worst < bestMean) {
+            bestMean = worst;
+            best = v;
+        }
+    }
+    if (best == NONE) {
+        return makeCycle(std::vector<uint32_t>(), std::vector<uint32_t>(), std::vector<double>());
+    }
+
+    // The n-arc walk into best repeats a vertex; cut every cycle out of it
+    // and keep the one with the smallest mean
+    std::vector<uint32_t> walkVertices(n + 1), walkArcs(n + 1, NONE);
+    uint32_t v = best;
+    for (uint32_t k = n; ; k--) {
+        walkVertices[k] = v;
+        if (k == 0) break;
+        walkArcs[k] = via[static_cast<size_t>(k) * n + v];
+        v = arcSource[walkArcs[k]];
+    }
+    RatioCycle result;
+    result.cost = 0;
+    result.time = 0;
+    result.ratio = INF;
+    std::vector<uint32_t> position(n, NONE); // index in pending, NONE if not on it
+    std::vector<uint32_t> pending;           // levels of the walk not yet cut out
+    for (uint32_t k = 0; k <= n; k++) {
+        uint32_t x = walkVertices[k];
+        if (position[x] == NONE) {
+            position[x] = static_cast<uint32_t>(pending.size());
+            pending.push_back(k);
+            continue;
+        }
+        // x comes back: the pending levels from its first visit form a cycle,
+        // the arc out of each one being the arc into the next
+        std::vector<uint32_t> cycleVertices, cycleArcs;
+        for (size_t i = position[x]; i < pending.size(); i++) {
+            cycleVertices.push_back(walkVertices[pending[i]]);
+            cycleArcs.push_back(i + 1 < pending.size() ? walkArcs[pending[i + 1]] : walkArcs[k]);
+            if (i > position[x]) position[walkVertices[pending[i]]] = NONE;
+        }
+        pending.resize(position[x] + 1);
+        RatioCycle cycle = makeCycle(cycleVertices, cycleArcs, std::vector<double>());
+        if (cycle.ratio < result.ratio) {
+            result = cycle;
+        }
+    }
+    return result;
+}
@@ -3,62 +3,325 @@
 #include "graph/SampleVertex.h"
 #include "graph/SampleEdge.h"
 #include "graph/SamplePositiveGraph.h"
-#include "graph/SampleNegativeGraph.h"
-#include <queue>
+#include "util/SampleStats.h"
 #include <algorithm>
 #include <iostream>
+#include <limits>
 
-// Custom comparator for priority queue
-struct VertexComparator {
-    bool operator()(SampleVertex* a, SampleVertex* b) {
-        return a->getDistance() > b->getDistance();
-    }
-};
+const uint32_t SampleDijkstra::NO_PARENT;
 
 SampleDijkstra::SampleDijkstra(SamplePositiveGraph* positiveGraph) {
     this->positiveGraph = positiveGraph;
+    this->legVersion = 0;
+    this->bidirectionalLegs = 0;
 }
 
 void SampleDijkstra::runDijkstra(SampleVertex* source) {
-    // Create a priority queue of vertices
-    std::priority_queue<SampleVertex*, std::vector<SampleVertex*>, VertexComparator> priorityQueue;
+    // Search the frozen snapshot (or reuse the cached tree), then publish the
+    // results on the vertices. A full search settles every reachable vertex.
+    const SampleShortestPathCache::Tree& tree = getTree(source->getId());
+    const SampleCSRGraph* graph = positiveGraph->freeze();
     
-    // Initialize distances and status for all vertices in the positive graph
-    for (const auto& pair : positiveGraph->getAllVertices()) {
-        SampleVertex* vertex = pair.second;
-        vertex->setDistance(std::numeric_limits<double>::max()); // Set initial distance to infinity
-        vertex->setStatus(0); // Set vertex status to unvisited (0)
-        vertex->setParent(nullptr); // No parent initially
+    for (uint32_t id = 0; id < graph->getVertexCount(); id++) {
+        SampleVertex* vertex = graph->getVertex(id);
+        uint32_t parent = tree.parent[id];
+        vertex->setDistance(tree.distance[id]);
+        vertex->setStatus(tree.distance[id] != std::numeric_limits<double>::max() ? 1 : 0);
+        vertex->setParent(parent != NO_PARENT ? graph->getVertex(parent) : nullptr);
+    }
+}
+
+const SampleShortestPathCache::Tree& SampleDijkstra::getTree(uint32_t source) {
+    const SampleCSRGraph* graph = positiveGraph->freeze();
+    cache.validate(positiveGraph->getVersion());
+    const SampleShortestPathCache::Tree* tree = cache.find(source);
+    if (tree != nullptr) {
+        return *tree;
+    }
+    runDijkstra(graph, source, context);
+    return cache.insert(context, graph->getVertexCount());
+}
+
+double SampleDijkstra::getDistance(SampleVertex* source, SampleVertex* target) {
+    return getTree(source->getId()).distance[target->getId()];
+}
+
+double SampleDijkstra::findLeg(uint32_t source, uint32_t target, std::vector<uint32_t>& path) {
+    const SampleCSRGraph* graph = positiveGraph->freeze();
+    cache.validate(positiveGraph->getVersion());
+    if (legVersion != positiveGraph->getVersion() || legSource.size() != graph->getVertexCount()) {
+        legSource.assign(graph->getVertexCount(), 0);
+        legVersion = positiveGraph->getVersion();
     }
     
-    source->setDistance(0); // Set distance for the source vertex to 0
-    priorityQueue.push(source); // Add the source vertex to the priority queue
+    // A whole tree only pays off once its source starts more than one leg
+    if (legSource[source] || cache.contains(source)) {
+        const SampleShortestPathCache::Tree& tree = getTree(source);
+        path = tree.getPath(target);
+        return tree.distance[target];
+    }
+    legSource[source] = 1;
+    bidirectionalLegs++;
+    return runBidirectional(graph, source, target, context, backward, path);
+}
+
+// Stop conditions for the search: called with every settled vertex and true
+// once the search can end
+struct StopAtTarget {
+    uint32_t target; // NO_PARENT never matches, so the whole graph is searched
+    bool operator()(uint32_t u) const { return u == target; }
+};
+
+struct StopAtTargetSet {
+    const std::vector<char>* isTarget;
+    uint32_t remaining;
+    bool operator()(uint32_t u) { return (*isTarget)[u] && --remaining == 0; }
+};
+
+struct StopWithinRadius {
+    const std::vector<char>* isTarget;
+    uint32_t remaining;
+    double radius;
+    const SampleQueryContext* context;
+    bool operator()(uint32_t u) {
+        return context->getDistance(u) > radius || ((*isTarget)[u] && --remaining == 0);
+    }
+};
+
+// Dijkstra over the CSR arrays, shared by every priority queue type.
+// With a lazy queue a vertex can be popped again after it was settled; those
+// stale pops are skipped.
+template <typename Heap, typename Stop>
+static void dijkstraKernel(const SampleCSRGraph* graph, uint32_t source, Stop& stop,
+                           SampleQueryContext& context, Heap& heap) {
+    const uint32_t* offsets = graph->getOffsets();
+    const uint32_t* targets = graph->getTargets();
+    const double* weights = graph->getWeights();
+    SAMPLE_STATS_LOCAL(pushes);
+    SAMPLE_STATS_LOCAL(stalePops);
+    SAMPLE_STATS_LOCAL(scanned);
+    SAMPLE_STATS_LOCAL(settled);
     
-    while (!priorityQueue.empty()) {
-        SampleVertex* u = priorityQueue.top(); // Get the vertex with the smallest distance
-        priorityQueue.pop();
-        u->setStatus(1); // Mark the vertex as visited (1)
+    heap.reset(graph->getVertexCount());
+    context.setDistance(source, 0, SampleDijkstra::NO_PARENT);
+    heap.push(source, 0);
+    SAMPLE_STATS_INC(pushes);
+    
+    while (!heap.empty()) {
+        uint32_t u = heap.pop(); // Get the vertex with the smallest distance
+        if (context.isSettled(u)) { // Stale entry, u was settled with a smaller distance
+            SAMPLE_STATS_INC(stalePops);
+            continue;
+        }
+        context.setSettled(u);
+        SAMPLE_STATS_INC(settled);
+        if (stop(u)) break; // The distances asked for are final, no need to go further
         
-        for (SampleEdge* edge : u->getNeighbors()) {
-            SampleVertex* v;
-            
-            // Determine the target vertex
-            if (edge->getVertexT() == u) {
-                v = edge->getVertexF();
-            } else {
-                v = edge->getVertexT();
-            }
+        double du = context.getDistance(u);
+        for (uint32_t arc = offsets[u]; arc < offsets[u + 1]; arc++) {
+            uint32_t v = targets[arc];
+            SAMPLE_STATS_INC(scanned);
+            if (context.isSettled(v)) continue;
             
-            if (v->getStatus() == 1) continue; // Skip already visited vertices
-            
-            double newDist = u->getDistance() + edge->getWeight(); // Calculate the new distance
-            if (newDist < v->getDistance()) {
-                v->setDistance(newDist); // Update the distance
-                v->setParent(u); // Set the parent to the current vertex
-                priorityQueue.push(v); // Add the vertex to the queue with the updated distance
+            double newDist = du + weights[arc];
+            if (newDist < context.getDistance(v)) {
+                context.setDistance(v, newDist, u);
+                heap.push(v, newDist); // Insert, or decrease-key on an indexed heap
+                SAMPLE_STATS_INC(pushes);
             }
         }
     }
+    
+    SAMPLE_STATS_ADD(DijkstraSearches, 1);
+    SAMPLE_STATS_ADD(DijkstraPushes, pushes);
+    SAMPLE_STATS_ADD(DijkstraStalePops, stalePops);
+    SAMPLE_STATS_ADD(DijkstraEdgesScanned, scanned);
+    SAMPLE_STATS_ADD(DijkstraSettled, settled);
+}
+
+// One step of a bidirectional search: settle the closest vertex of this side
+// and relax its arcs, updating the best meeting point seen so far
+template <typename Heap>
+static void bidirectionalStep(const SampleCSRGraph* graph, SampleQueryContext& side, Heap& heap,
+                              const SampleQueryContext& other, double& best, uint32_t& meet) {
+    const uint32_t* offsets = graph->getOffsets();
+    const uint32_t* targets = graph->getTargets();
+    const double* weights = graph->getWeights();
+    
+    uint32_t u = heap.pop();
+    if (side.isSettled(u)) return; // Stale entry
+    side.setSettled(u);
+    
+    double du = side.getDistance(u);
+    for (uint32_t arc = offsets[u]; arc < offsets[u + 1]; arc++) {
+        uint32_t v = targets[arc];
+        if (side.isSettled(v)) continue;
+        
+        double newDist = du + weights[arc];
+        if (newDist < side.getDistance(v)) {
+            side.setDistance(v, newDist, u);
+            heap.push(v, newDist);
+        }
+        
+        // A vertex reached from both ends closes a source-target path
+        if (other.isTouched(v) && side.getDistance(v) + other.getDistance(v) < best) {
+            best = side.getDistance(v) + other.getDistance(v);
+            meet = v;
+        }
+    }
+}
+
+// Forward search from source and backward search from target, always
+// expanding the side whose queue has the smaller key. Once the two smallest
+// keys add up to at least the best meeting distance, no shorter path exists.
+template <typename Heap>
+static double bidirectionalKernel(const SampleCSRGraph* graph, uint32_t source, uint32_t target,
+                                  SampleQueryContext& forward, Heap& forwardHeap,
+                                  SampleQueryContext& backward, Heap& backwardHeap,
+                                  uint32_t& meet) {
+    const double INF = std::numeric_limits<double>::max();
+    double best = INF;
+    meet = SampleDijkstra::NO_PARENT;
+    
+    forwardHeap.reset(graph->getVertexCount());
+    backwardHeap.reset(graph->getVertexCount());
+    forward.setDistance(source, 0, SampleDijkstra::NO_PARENT);
+    backward.setDistance(target, 0, SampleDijkstra::NO_PARENT);
+    forwardHeap.push(source, 0);
+    backwardHeap.push(target, 0);
+    if (source == target) {
+        meet = source;
+        return 0;
+    }
+    
+    while (true) {
+        double forwardKey = forwardHeap.empty() ? INF : forwardHeap.topKey();
+        double backwardKey = backwardHeap.empty() ? INF : backwardHeap.topKey();
+        if (forwardKey == INF || backwardKey == INF || forwardKey + backwardKey >= best) break;
+        
+        if (forwardKey <= backwardKey) {
+            bidirectionalStep(graph, forward, forwardHeap, backward, best, meet);
+        } else {
+            bidirectionalStep(graph, backward, backwardHeap, forward, best, meet);
+        }
+    }
+    return best;
+}
+
+void SampleDijkstra::runDijkstra(const SampleCSRGraph* graph, uint32_t source, SampleQueryContext& context) {
+    runPointToPoint(graph, source, NO_PARENT, context);
+}
+
+template <typename Stop>
+static void runKernel(const SampleCSRGraph* graph, uint32_t source, Stop& stop, SampleQueryContext& context) {
+    context.reset(graph->getVertexCount());
+    context.setSource(source);
+    
+    switch (context.getHeapType()) {
+    case SampleHeapType::Binary:
+        dijkstraKernel(graph, source, stop, context, context.getBinaryHeap());
+        break;
+    case SampleHeapType::Radix:
+        dijkstraKernel(graph, source, stop, context, context.getRadixHeap());
+        break;
+    default:
+        dijkstraKernel(graph, source, stop, context, context.getFourAryHeap());
+        break;
+    }
+}
+
+double SampleDijkstra::runPointToPoint(const SampleCSRGraph* graph, uint32_t source, uint32_t target,
+                                       SampleQueryContext& context) {
+    StopAtTarget stop = { target };
+    runKernel(graph, source, stop, context);
+    return target != NO_PARENT ? context.getDistance(target) : 0;
+}
+
+void SampleDijkstra::runOneToMany(const SampleCSRGraph* graph, uint32_t source,
+                                  const std::vector<char>& isTarget, uint32_t targetCount,
+                                  SampleQueryContext& context) {
+    StopAtTargetSet stop = { &isTarget, targetCount };
+    runKernel(graph, source, stop, context);
+}
+
+void SampleDijkstra::runNearest(const SampleCSRGraph* graph, uint32_t source,
+                                const std::vector<char>& isTarget, uint32_t count, double radius,
+                                SampleQueryContext& context) {
+    StopWithinRadius stop = { &isTarget, count, radius, &context };
+    runKernel(graph, source, stop, context);
+}
+
+double SampleDijkstra::runBidirectional(const SampleCSRGraph* graph, uint32_t source, uint32_t target,
+                                        SampleQueryContext& forward, SampleQueryContext& backward,
+                                        std::vector<uint32_t>& path) {
+    path.clear();
+    if (!graph->isUndirected()) {
+        // The backward search walks arcs in reverse, which needs a symmetric graph
+        double distance = runPointToPoint(graph, source, target, forward);
+        path = forward.getPath(target);
+        return distance;
+    }
+    
+    forward.reset(graph->getVertexCount());
+    forward.setSource(source);
+    backward.reset(graph->getVertexCount());
+    backward.setSource(target);
+    
+    uint32_t meet;
+    double distance;
+    switch (forward.getHeapType()) {
+    case SampleHeapType::Binary:
+        distance = bidirectionalKernel(graph, source, target, forward, forward.getBinaryHeap(),
+                                       backward, backward.getBinaryHeap(), meet);
+        break;
+    case SampleHeapType::Radix:
+        distance = bidirectionalKernel(graph, source, target, forward, forward.getRadixHeap(),
+                                       backward, backward.getRadixHeap(), meet);
+        break;
+    default:
+        distance = bidirectionalKernel(graph, source, target, forward, forward.getFourAryHeap(),
+                                       backward, backward.getFourAryHeap(), meet);
+        break;
+    }
+    if (meet == NO_PARENT) {
+        return distance; // Target not reachable
+    }
+    
+    // Source -> meet from the forward tree, then meet -> target from the backward tree
+    path = forward.getPath(meet);
+    for (uint32_t at = backward.getParent(meet); at != NO_PARENT; at = backward.getParent(at)) {
+        path.push_back(at);
+    }
+    return distance;
+}
+
+void SampleDijkstra::runDijkstra(const SampleCSRGraph* graph, uint32_t source,
+                                 std::vector<double>& distance, std::vector<uint32_t>& parent) {
+    SampleQueryContext context(graph->getVertexCount());
+    runDijkstra(graph, source, context);
+    
+    uint32_t n = graph->getVertexCount();
+    distance.assign(n, std::numeric_limits<double>::max());
+    parent.assign(n, NO_PARENT);
+    for (uint32_t v : context.getTouched()) {
+        distance[v] = context.getDistance(v);
+        parent[v] = context.getParent(v);
+    }
+}
+
+std::vector<uint32_t> SampleDijkstra::getShortestPath(const std::vector<uint32_t>& parent,
+                                                      uint32_t source, uint32_t target) {
+    std::vector<uint32_t> path;
+    for (uint32_t at = target; at != NO_PARENT; at = parent[at]) {
+        path.push_back(at);
+    }
+    std::reverse(path.begin(), path.end());
+    
+    // The walk ends at the source only if the target was reached from it
+    if (path.empty() || path[0] != source) {
+        path.clear();
+    }
+    return path;
 }
 
 std::vector<SampleVertex*> SampleDijkstra::getShortestPath(SampleVertex* target) {
@@ -76,60 +339,55 @@ std::vector<SampleVertex*> SampleDijkstra::getShortestPath(SampleVertex* target)
     return path;
 }
 
-void SampleDijkstra::printShortestPath(SampleVertex* source, SampleVertex* target) {
-    runDijkstra(source); // Run Dijkstra from the source to calculate all shortest paths
-    std::vector<SampleVertex*> path = getShortestPath(target); // Get the shortest path to the target
+double SampleDijkstra::printShortestPath(SampleVertex* source, SampleVertex* target) {
+    const SampleCSRGraph* graph = positiveGraph->freeze();
+    std::vector<uint32_t> path;
+    double totalDistance = findLeg(source->getId(), target->getId(), path);
     
-    if (path.empty() || path[0] != source) {
+    if (path.empty()) {
         std::cout << "No path from " << source->getName() << " to " << target->getName() << std::endl;
     } else {
         std::cout << "Shortest path from " << source->getName() << " to " << target->getName() << ": ";
         
         for (size_t i = 0; i < path.size(); i++) {
-            std::cout << path[i]->getName();
+            std::cout << graph->getVertex(path[i])->getName();
             if (i < path.size() - 1) {
                 std::cout << " -> ";
             }
         }
         std::cout << std::endl;
         
-        // Calculate and print the total distance
-        double totalDistance = target->getDistance();
+        // Print the total distance
         std::cout << "Total distance: " << totalDistance << std::endl;
     }
+    return totalDistance;
 }
 
-void SampleDijkstra::executeNegativeCycleAndPrintPath(SampleVertex* garage, const std::vector<SampleVertex*>& cycle) {
+double SampleDijkstra::executeNegativeCycleAndPrintPath(SampleVertex* garage, const std::vector<SampleVertex*>& cycle) {
     std::cout << "Shortest path:" << std::endl;
     
-    // Find the corresponding vertices in the positive graph
-    std::vector<SampleVertex*> positiveCycle;
-    for (SampleVertex* vertex : cycle) {
-        positiveCycle.push_back(positiveGraph->getVertexByName(vertex->getName()));
-    }
+    // The profit graph is an overlay on the positive graph, so the cycle
+    // already holds positive graph vertices
+    const std::vector<SampleVertex*>& positiveCycle = cycle;
     
     double totalDistance = 0;
     
-    // Iterate over the cycle in the positive graph and print the shortest paths
+    // Iterate over the cycle in the positive graph. Every stop starts one
+    // leg, so each leg is a bidirectional search that also yields the leg
+    // distance; see findLeg for stops that start more than one
     for (size_t i = 0; i < positiveCycle.size(); i++) {
         if (i == 0) { // from the garage to the first pickup vertex
-            runDijkstra(garage);
-            printShortestPath(garage, positiveCycle[i]);
-            totalDistance += positiveCycle[i]->getDistance();
+            totalDistance += printShortestPath(garage, positiveCycle[i]);
         }
         
         if (i == positiveCycle.size() - 1) { // back to the garage
-            runDijkstra(positiveCycle[i]);
-            printShortestPath(positiveCycle[i], garage);
-            totalDistance += garage->getDistance();
+            totalDistance += printShortestPath(positiveCycle[i], garage);
             continue;
         }
         
-        // Run Dijkstra again from the new current vertex to find the next shortest path
-        runDijkstra(positiveCycle[i]);
-        printShortestPath(positiveCycle[i], positiveCycle[i + 1]);
-        totalDistance += positiveCycle[i + 1]->getDistance();
+        totalDistance += printShortestPath(positiveCycle[i], positiveCycle[i + 1]);
     }
     
     std::cout << "Total route distance: " << totalDistance << std::endl;
+    return totalDistance;
 }
\ No newline at end of file
@@ -0,0 +1,165 @@
+// SampleDistanceMatrix.cpp
+#include "algorithm/SampleDistanceMatrix.h"
+#include "algorithm/SampleDijkstra.h"
+#include "algorithm/SampleQueryContext.h"
+#include <limits>
+#include <algorithm>
+#include <memory>
+
+const double SampleDistanceMatrix::LANE_RADIUS = 0.02;
+
+SampleDistanceMatrix::SampleDistanceMatrix(const std::vector<uint32_t>& sources, const std::vector<uint32_t>& targets) {
+    this->sources = sources;
+    this->targets = targets;
+    this->kernel = SampleMultiSourceDijkstra::detectKernel();
+    distances.assign(sources.size() * targets.size(), std::numeric_limits<double>::max());
+
+    // A vertex listed twice keeps its first row/column
+    for (size_t row = 0; row < sources.size(); row++) {
+        rowOf.insert(std::make_pair(sources[row], row));
+    }
+    for (size_t column = 0; column < targets.size(); column++) {
+        columnOf.insert(std::make_pair(targets[column], column));
+    }
+}
+
+void SampleDistanceMatrix::storeRow(size_t row, const SampleQueryContext& context) {
+    size_t columns = targets.size();
+    for (size_t column = 0; column < columns; column++) {
+        distances[row * columns + column] = context.getDistance(targets[column]);
+    }
+}
+
+std::vector<std::vector<size_t> > SampleDistanceMatrix::planBlocks(const SampleCSRGraph* graph,
+                                                                   const std::vector<char>& isTarget,
+                                                                   uint32_t targetCount,
+                                                                   SampleQueryContext& context) {
+    std::vector<std::vector<size_t> > blocks;
+    size_t lanes = SampleMultiSourceDijkstra::getLaneCount(kernel);
+
+    // The first row is searched right away; how far it had to go to reach
+    // its targets sets the radius within which sources count as neighbours
+    SampleDijkstra::runOneToMany(graph, sources[0], isTarget, targetCount, context);
+    storeRow(0, context);
+    double reach = 0.0;
+    for (uint32_t target : targets) {
+        double distance = context.getDistance(target);
+        if (distance != std::numeric_limits<double>::max()) {
+            reach = std::max(reach, distance);
+        }
+    }
+    double radius = reach * LANE_RADIUS;
+
+    // Rows not in a block yet, by source vertex
+    std::unordered_map<uint32_t, std::vector<size_t> > pendingRows;
+    std::vector<char> isPending(graph->getVertexCount(), 0);
+    uint32_t pendingCount = 0; // distinct vertices with pending rows
+    for (size_t row = sources.size(); row-- > 1; ) {
+        pendingRows[sources[row]].push_back(row); // last row first, popped in order
+        if (!isPending[sources[row]]) {
+            isPending[sources[row]] = 1;
+            pendingCount++;
+        }
+    }
+    // Moves pending rows of v into block until it is full
+    auto take = [&](uint32_t v, std::vector<size_t>& block) {
+        std::vector<size_t>& rows = pendingRows[v];
+        while (!rows.empty() && block.size() < lanes) {
+            block.push_back(rows.back());
+            rows.pop_back();
+        }
+        if (rows.empty() && isPending[v]) {
+            isPending[v] = 0;
+            pendingCount--;
+        }
+    };
+
+    // Greedy: each block is the first pending row plus its nearest pending
+    // sources within the radius; a row with none is searched on its own
+    std::vector<std::pair<double, uint32_t> > nearest;
+    for (size_t row = 1; row < sources.size(); row++) {
+        uint32_t anchor = sources[row];
+        if (!isPending[anchor] || pendingRows[anchor].back() != row) continue; // already placed
+        std::vector<size_t> block;
+        take(anchor, block);
+        if (block.size() < lanes && pendingCount > 0 && radius > 0.0) {
+            uint32_t wanted = static_cast<uint32_t>(std::min<size_t>(lanes - block.size(), pendingCount));
+            SampleDijkstra::runNearest(graph, anchor, isPending, wanted, radius, context);
+            nearest.clear();
+            for (uint32_t v : context.getTouched()) {
+                if (isPending[v] && context.isSettled(v) && context.getDistance(v) <= radius) {
+                    nearest.push_back(std::make_pair(context.getDistance(v), v));
+                }
+            }
+            std::sort(nearest.begin(), nearest.end());
+            for (size_t i = 0; i < nearest.size() && block.size() < lanes; i++) {
+                take(nearest[i].second, block);
+            }
+        }
+        blocks.push_back(block);
+    }
+    return blocks;
+}
+
+void SampleDistanceMatrix::compute(const SampleCSRGraph* graph, SampleThreadPool* pool) {
+    if (sources.empty() || targets.empty()) return;
+
+    // Target markers are shared read-only by all searches
+    std::vector<char> isTarget(graph->getVertexCount(), 0);
+    uint32_t targetCount = 0;
+    for (uint32_t target : targets) {
+        if (!isTarget[target]) {
+            isTarget[target] = 1;
+            targetCount++;
+        }
+    }
+
+    unsigned workerCount = pool != nullptr ? pool->getThreadCount() : 1;
+    std::vector<SampleQueryContext> contexts(workerCount, SampleQueryContext(graph->getVertexCount()));
+    // Lane state is large (a row of doubles per vertex), so it is only
+    // made for workers that get a block
+    std::vector<std::unique_ptr<SampleMultiSourceDijkstra> > searches(workerCount);
+    std::vector<std::vector<size_t> > blocks = planBlocks(graph, isTarget, targetCount, contexts[0]);
+
+    // Each row is written by exactly one block
+    size_t columns = targets.size();
+    std::function<void(size_t, unsigned)> computeBlock = [&](size_t index, unsigned worker) {
+        const std::vector<size_t>& block = blocks[index];
+        if (block.size() == 1) {
+            SampleDijkstra::runOneToMany(graph, sources[block[0]], isTarget, targetCount, contexts[worker]);
+            storeRow(block[0], contexts[worker]);
+            return;
+        }
+        if (!searches[worker]) {
+            searches[worker].reset(new SampleMultiSourceDijkstra(graph->getVertexCount(), kernel));
+        }
+        SampleMultiSourceDijkstra& search = *searches[worker];
+        uint32_t blockSources[SampleMultiSourceDijkstra::MAX_LANES];
+        for (size_t lane = 0; lane < block.size(); lane++) {
+            blockSources[lane] = sources[block[lane]];
+        }
+        search.run(graph, blockSources, static_cast<unsigned>(block.size()), isTarget, targetCount);
+        for (size_t lane = 0; lane < block.size(); lane++) {
+            for (size_t column = 0; column < columns; column++) {
+                distances[block[lane] * columns + column] = search.getDistance(static_cast<unsigned>(lane), targets[column]);
+            }
+        }
+    };
+
+    if (pool != nullptr) {
+        pool->run(blocks.size(), computeBlock);
+    } else {
+        for (size_t index = 0; index < blocks.size(); index++) {
+            computeBlock(index, 0);
+        }
+    }
+}
+
+double SampleDistanceMatrix::getDistanceById(uint32_t source, uint32_t target) const {
+    std::unordered_map<uint32_t, size_t>::const_iterator row = rowOf.find(source);
+    std::unordered_map<uint32_t, size_t>::const_iterator column = columnOf.find(target);
+    if (row == rowOf.end() || column == columnOf.end()) {
+        return std::numeric_limits<double>::max();
+    }
+    return getDistance(row->second, column->second);
+}
@@ -0,0 +1,587 @@
+// SampleFleetPlanner.cpp
+#include "algorithm/SampleFleetPlanner.h"
+#include "algorithm/SampleDistanceMatrix.h"
+#include "graph/SampleVertex.h"
+#include "util/SampleStats.h"
+#include "util/SampleMath.h"
+#include <algorithm>
+#include <unordered_map>
+#include <limits>
+#include <stdexcept>
+#include <cmath>
+#include <thread>
+
+namespace {
+
+const uint32_t CLUSTER_ROUNDS = 10;     // k-means rounds at most
+const size_t NO_GAP = static_cast<size_t>(-1);
+
+struct Point {
+    double x;
+    double y;
+};
+
+double squaredDistance(const Point& a, const Point& b) {
+    return (a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y);
+}
+
+} // namespace
+
+SampleFleetPlanner::SampleFleetPlanner(const SampleCSRGraph* graph, const std::vector<uint32_t>& depots,
+                                       const std::vector<Order>& orders)
+    : graph(graph), depots(depots), orders(orders) {
+    if (depots.empty()) {
+        throw std::invalid_argument("SampleFleetPlanner: no depots");
+    }
+    std::unordered_map<uint32_t, uint32_t> placeOf;
+    auto addPlace = [&](uint32_t id) {
+        if (id >= graph->getVertexCount()) {
+            throw std::invalid_argument("SampleFleetPlanner: vertex id out of range");
+        }
+        auto found = placeOf.find(id);
+        if (found != placeOf.end()) {
+            return found->second;
+        }
+        uint32_t place = static_cast<uint32_t>(places.size());
+        places.push_back(id);
+        placeOf.insert(std::make_pair(id, place));
+        return place;
+    };
+    for (uint32_t depot : depots) {
+        depotPlace.push_back(addPlace(depot));
+    }
+
+    // A route lists every place once, so a place cannot be both a pickup
+    // and a dropoff, and a dropoff belongs to one order
+    std::unordered_map<uint32_t, int> role; // 1 pickup, 2 dropoff
+    for (const Order& order : orders) {
+        int& pickupRole = role[order.pickup];
+        int& dropoffRole = role[order.dropoff];
+        if (pickupRole == 2 || dropoffRole != 0 || order.pickup == order.dropoff) {
+            throw std::invalid_argument("SampleFleetPlanner: a place is a dropoff of one order and part of another");
+        }
+        pickupRole = 1;
+        dropoffRole = 2;
+        pickupPlace.push_back(addPlace(order.pickup));
+        dropoffPlace.push_back(addPlace(order.dropoff));
+    }
+}
+
+void SampleFleetPlanner::computeLegs(SampleThreadPool* pool) {
+    SampleDistanceMatrix matrix(places, places);
+    matrix.compute(graph, pool);
+    size_t count = places.size();
+    realLegs.assign(count * count, 0.0);
+    for (size_t from = 0; from < count; from++) {
+        for (size_t to = 0; to < count; to++) {
+            realLegs[from * count + to] = from == to ? 0.0 : matrix.getDistance(from, to);
+        }
+    }
+
+    // The same penalty as in SampleTourOptimizer, so the arithmetic below
+    // stays finite
+    legs = realLegs;
+    samplePenalizeUnreachable(legs, count);
+}
+
+// Depot -> pickup -> dropoff -> depot, max() if a leg is unreachable
+double SampleFleetPlanner::orderCost(uint32_t depot, uint32_t order) const {
+    size_t count = places.size();
+    uint32_t from[3] = { depotPlace[depot], pickupPlace[order], dropoffPlace[order] };
+    uint32_t to[3] = { pickupPlace[order], dropoffPlace[order], depotPlace[depot] };
+    double cost = 0.0;
+    for (int i = 0; i < 3; i++) {
+        double length = realLegs[from[i] * count + to[i]];
+        if (!sampleIsReachable(length)) {
+            return std::numeric_limits<double>::max();
+        }
+        cost += length;
+    }
+    return cost;
+}
+
+double SampleFleetPlanner::routeLength(const Work& route, const std::vector<double>& matrix) const {
+    size_t count = places.size();
+    uint32_t from = depotPlace[route.depot];
+    double length = 0.0;
+    for (size_t i = 0; i <= route.stops.size(); i++) {
+        uint32_t to = i < route.stops.size() ? route.stops[i] : depotPlace[route.depot];
+        double step = matrix[from * count + to];
+        if (!sampleIsReachable(step)) {
+            return std::numeric_limits<double>::max();
+        }
+        length += step;
+        from = to;
+    }
+    return length;
+}
+
+// Orders by how much a second-best depot would cost them, the largest
+// first, each to its cheapest depot with room left (over capacity only
+// when no depot has room); returns the depot of every order, or the depot
+// count for orders none of them reaches
+std::vector<uint32_t> SampleFleetPlanner::assignDepots(const std::vector<uint32_t>& truckDepots, uint32_t capacity,
+                                                       std::vector<uint32_t>& unserved) const {
+    uint32_t depotCount = static_cast<uint32_t>(depots.size());
+    std::vector<uint32_t> room(depotCount, 0);
+    for (uint32_t depot : truckDepots) {
+        room[depot] += capacity;
+    }
+
+    std::vector<std::pair<double, uint32_t> > byRegret;
+    for (uint32_t order = 0; order < orders.size(); order++) {
+        double best = std::numeric_limits<double>::max();
+        double second = std::numeric_limits<double>::max();
+        for (uint32_t depot = 0; depot < depotCount; depot++) {
+            double cost = room[depot] > 0 ? orderCost(depot, order) : std::numeric_limits<double>::max();
+            if (cost < best) {
+                second = best;
+                best = cost;
+            } else if (cost < second) {
+                second = cost;
+            }
+        }
+        if (best == std::numeric_limits<double>::max()) {
+            unserved.push_back(order);
+        } else {
+            byRegret.push_back(std::make_pair(second == std::numeric_limits<double>::max()
+                                                  ? std::numeric_limits<double>::max() : second - best, order));
+        }
+    }
+    std::stable_sort(byRegret.begin(), byRegret.end(),
+                     [](const std::pair<double, uint32_t>& a, const std::pair<double, uint32_t>& b) {
+                         return a.first > b.first;
+                     });
+
+    std::vector<char> hasTrucks(depotCount, 0);
+    for (uint32_t depot : truckDepots) {
+        hasTrucks[depot] = 1;
+    }
+    std::vector<uint32_t> depotOf(orders.size(), depotCount);
+    for (const auto& entry : byRegret) {
+        uint32_t order = entry.second;
+        double bestCost = std::numeric_limits<double>::max();
+        double bestAnyCost = std::numeric_limits<double>::max();
+        uint32_t best = depotCount;
+        uint32_t bestAny = depotCount;
+        for (uint32_t depot = 0; depot < depotCount; depot++) {
+            double cost = hasTrucks[depot] ? orderCost(depot, order) : std::numeric_limits<double>::max();
+            if (cost < bestAnyCost) {
+                bestAnyCost = cost;
+                bestAny = depot;
+            }
+            if (room[depot] > 0 && cost < bestCost) {
+                bestCost = cost;
+                best = depot;
+            }
+        }
+        depotOf[order] = best != depotCount ? best : bestAny;
+        if (room[depotOf[order]] > 0) {
+            room[depotOf[order]]--;
+        }
+    }
+    return depotOf;
+}
+
+// k-means on the orders' midpoints (longitude scaled to the latitude), one
+// cluster per truck, seeded with points far apart; assignment follows the
+// same regret and capacity rule as the depots
+void SampleFleetPlanner::clusterDepot(const std::vector<uint32_t>& depotOrders, const std::vector<uint32_t>& trucks,
+                                      uint32_t capacity, std::vector<Work>& routes) const {
+    size_t k = std::min(trucks.size(), depotOrders.size());
+    if (k <= 1) {
+        if (!trucks.empty()) {
+            routes[trucks[0]].orders = depotOrders;
+        }
+        return;
+    }
+
+    std::vector<Point> points;
+    for (uint32_t order : depotOrders) {
+        const SampleVertex* pickup = graph->getVertex(orders[order].pickup);
+        const SampleVertex* dropoff = graph->getVertex(orders[order].dropoff);
+        double latitude = 0.0;
+        double longitude = 0.0;
+        if (pickup != nullptr && dropoff != nullptr) {
+            latitude = (pickup->getLatitude() + dropoff->getLatitude()) / 2;
+            longitude = (pickup->getLongitude() + dropoff->getLongitude()) / 2;
+        }
+        Point point = { longitude * std::cos(latitude * SAMPLE_PI / 180.0), latitude };
+        points.push_back(point);
+    }
+
+    // Seeds: the point farthest from the first, then each time the point
+    // farthest from the seeds so far
+    std::vector<Point> centers;
+    std::vector<double> nearestSeed(points.size(), std::numeric_limits<double>::max());
+    size_t next = 0;
+    for (size_t i = 1; i < points.size(); i++) {
+        if (squaredDistance(points[i], points[0]) > squaredDistance(points[next], points[0])) next = i;
+    }
+    while (centers.size() < k) {
+        centers.push_back(points[next]);
+        // Every distance takes the new seed into account before the farthest
+        // point is chosen; next itself is at distance 0 now
+        for (size_t i = 0; i < points.size(); i++) {
+            nearestSeed[i] = std::min(nearestSeed[i], squaredDistance(points[i], centers.back()));
+        }
+        for (size_t i = 0; i < points.size(); i++) {
+            if (nearestSeed[i] > nearestSeed[next]) next = i;
+        }
+    }
+
+    std::vector<size_t> clusterOf(points.size(), k);
+    for (uint32_t round = 0; round < CLUSTER_ROUNDS; round++) {
+        std::vector<std::pair<double, size_t> > byRegret;
+        for (size_t i = 0; i < points.size(); i++) {
+            double best = std::numeric_limits<double>::max();
+            double second = std::numeric_limits<double>::max();
+            for (const Point& center : centers) {
+                double distance = squaredDistance(points[i], center);
+                if (distance < best) {
+                    second = best;
+                    best = distance;
+                } else if (distance < second) {
+                    second = distance;
+                }
+            }
+            byRegret.push_back(std::make_pair(std::sqrt(second) - std::sqrt(best), i));
+        }
+        std::stable_sort(byRegret.begin(), byRegret.end(),
+                         [](const std::pair<double, size_t>& a, const std::pair<double, size_t>& b) {
+                             return a.first > b.first;
+                         });
+
+        std::vector<uint32_t> room(k, capacity);
+        std::vector<size_t> assigned(points.size(), k);
+        for (const auto& entry : byRegret) {
+            size_t i = entry.second;
+            size_t best = k;
+            for (size_t c = 0; c < k; c++) {
+                if (room[c] > 0 && (best == k || squaredDistance(points[i], centers[c]) <
+                                                 squaredDistance(points[i], centers[best]))) {
+                    best = c;
+                }
+            }
+            if (best == k) {
+                best = i % k; // Over capacity everywhere: spread the rest
+            } else {
+                room[best]--;
+            }
+            assigned[i] = best;
+        }
+        if (assigned == clusterOf) {
+            break;
+        }
+        clusterOf = assigned;
+
+        std::vector<Point> sums(k, Point());
+        std::vector<size_t> sizes(k, 0);
+        for (size_t i = 0; i < points.size(); i++) {
+            sums[clusterOf[i]].x += points[i].x;
+            sums[clusterOf[i]].y += points[i].y;
+            sizes[clusterOf[i]]++;
+        }
+        for (size_t c = 0; c < k; c++) {
+            if (sizes[c] > 0) {
+                centers[c].x = sums[c].x / sizes[c];
+                centers[c].y = sums[c].y / sizes[c];
+            }
+        }
+    }
+
+    for (size_t i = 0; i < points.size(); i++) {
+        routes[trucks[clusterOf[i]]].orders.push_back(depotOrders[i]);
+    }
+}
+
+// Cheapest way into route: the pickup at gap pickupAt and the dropoff at
+// gap dropoffAt >= pickupAt, where gap i lies before stops[i] (gap
+// stops.size() before the depot at the end). If the route already visits
+// the pickup only the dropoff goes in, after it, and pickupAt is NO_GAP.
+double SampleFleetPlanner::insertionCost(const Work& route, uint32_t order, size_t& pickupAt, size_t& dropoffAt) const {
+    uint32_t depot = depotPlace[route.depot];
+    uint32_t pickup = pickupPlace[order];
+    uint32_t dropoff = dropoffPlace[order];
+    const std::vector<uint32_t>& stops = route.stops;
+    size_t gaps = stops.size() + 1;
+    auto before = [&](size_t gap) { return gap == 0 ? depot : stops[gap - 1]; };
+    auto after = [&](size_t gap) { return gap == stops.size() ? depot : stops[gap]; };
+    auto detour = [&](size_t gap, uint32_t place) {
+        return leg(before(gap), place) + leg(place, after(gap)) - leg(before(gap), after(gap));
+    };
+
+    double best = std::numeric_limits<double>::max();
+    size_t visited = std::find(stops.begin(), stops.end(), pickup) - stops.begin();
+    if (visited < stops.size()) {
+        pickupAt = NO_GAP;
+        for (size_t gap = visited + 1; gap < gaps; gap++) {
+            double cost = detour(gap, dropoff);
+            if (cost < best) {
+                best = cost;
+                dropoffAt = gap;
+            }
+        }
+        return best;
+    }
+
+    // Best pickup gap so far for a dropoff in a later gap
+    double bestPickup = std::numeric_limits<double>::max();
+    size_t bestPickupAt = 0;
+    for (size_t gap = 0; gap < gaps; gap++) {
+        double together = leg(before(gap), pickup) + leg(pickup, dropoff) + leg(dropoff, after(gap))
+                        - leg(before(gap), after(gap));
+        if (together < best) {
+            best = together;
+            pickupAt = gap;
+            dropoffAt = gap;
+        }
+        if (bestPickup < std::numeric_limits<double>::max() && bestPickup + detour(gap, dropoff) < best) {
+            best = bestPickup + detour(gap, dropoff);
+            pickupAt = bestPickupAt;
+            dropoffAt = gap;
+        }
+        double pickupCost = detour(gap, pickup);
+        if (pickupCost < bestPickup) {
+            bestPickup = pickupCost;
+            bestPickupAt = gap;
+        }
+    }
+    return best;
+}
+
+void SampleFleetPlanner::insertOrder(Work& route, uint32_t order, size_t pickupAt, size_t dropoffAt) const {
+    route.stops.insert(route.stops.begin() + dropoffAt, dropoffPlace[order]);
+    if (pickupAt != NO_GAP) {
+        route.stops.insert(route.stops.begin() + pickupAt, pickupPlace[order]);
+    }
+    route.orders.push_back(order);
+}
+
+void SampleFleetPlanner::removeOrder(Work& route, uint32_t order) const {
+    route.orders.erase(std::find(route.orders.begin(), route.orders.end(), order));
+    route.stops.erase(std::find(route.stops.begin(), route.stops.end(), dropoffPlace[order]));
+    for (uint32_t other : route.orders) {
+        if (pickupPlace[other] == pickupPlace[order]) {
+            return; // Still needed
+        }
+    }
+    route.stops.erase(std::find(route.stops.begin(), route.stops.end(), pickupPlace[order]));
+}
+
+double SampleFleetPlanner::removalGain(const Work& route, uint32_t order) const {
+    Work without(route);
+    removeOrder(without, order);
+    return routeLength(route, legs) - routeLength(without, legs);
+}
+
+// Builds the route by cheapest insertion, farthest orders first, if it has
+// no stops yet, then improves the visiting order
+void SampleFleetPlanner::solveRoute(Work& route, double budgetSeconds, uint32_t seed) const {
+    if (route.stops.empty()) {
+        std::vector<uint32_t> pending;
+        pending.swap(route.orders);
+        std::vector<std::pair<double, uint32_t> > byCost;
+        for (uint32_t order : pending) {
+            byCost.push_back(std::make_pair(leg(depotPlace[route.depot], pickupPlace[order]) +
+                                            leg(dropoffPlace[order], depotPlace[route.depot]), order));
+        }
+        std::stable_sort(byCost.begin(), byCost.end(),
+                         [](const std::pair<double, uint32_t>& a, const std::pair<double, uint32_t>& b) {
+                             return a.first > b.first;
+                         });
+        for (const auto& entry : byCost) {
+            size_t pickupAt = NO_GAP;
+            size_t dropoffAt = 0;
+            insertionCost(route, entry.second, pickupAt, dropoffAt);
+            insertOrder(route, entry.second, pickupAt, dropoffAt);
+        }
+    }
+    if (route.stops.size() < 2) {
+        return;
+    }
+
+    // Stop k of the optimizer is stops[k - 1], the depot is 0
+    uint32_t stopCount = static_cast<uint32_t>(route.stops.size());
+    std::vector<uint32_t> local(1, depotPlace[route.depot]);
+    local.insert(local.end(), route.stops.begin(), route.stops.end());
+    std::unordered_map<uint32_t, uint32_t> stopOf;
+    for (uint32_t k = 1; k <= stopCount; k++) {
+        stopOf[local[k]] = k;
+    }
+    std::vector<uint32_t> pickupOf(stopCount + 1, 0);
+    for (uint32_t order : route.orders) {
+        pickupOf[stopOf[dropoffPlace[order]]] = stopOf[pickupPlace[order]];
+    }
+    std::vector<double> subLegs(local.size() * local.size());
+    for (size_t from = 0; from < local.size(); from++) {
+        for (size_t to = 0; to < local.size(); to++) {
+            subLegs[from * local.size() + to] = realLegs[local[from] * places.size() + local[to]];
+        }
+    }
+    std::vector<uint32_t> initial;
+    for (uint32_t k = 1; k <= stopCount; k++) {
+        initial.push_back(k);
+    }
+
+    SampleTourOptimizer::Options tourOptions;
+    tourOptions.budgetSeconds = budgetSeconds;
+    tourOptions.seed = seed;
+    SampleTourOptimizer optimizer(stopCount, subLegs, pickupOf);
+    SampleTourOptimizer::Result result = optimizer.optimize(initial, tourOptions);
+    for (uint32_t k = 0; k < stopCount; k++) {
+        route.stops[k] = local[result.order[k]];
+    }
+}
+
+// Routes are independent, so they are solved side by side; every one gets
+// its share of the fleet's budget for the workers there are
+void SampleFleetPlanner::solveRoutes(std::vector<Work>& routes, bool changedOnly, const Options& options,
+                                     SampleThreadPool* pool) const {
+    std::vector<size_t> pending;
+    for (size_t i = 0; i < routes.size(); i++) {
+        if (!routes[i].orders.empty() && (routes[i].changed || !changedOnly)) {
+            pending.push_back(i);
+        }
+    }
+    if (pending.empty()) {
+        return;
+    }
+    // Workers beyond the cores there are only share them
+    unsigned cores = std::max(std::thread::hardware_concurrency(), 1u);
+    double workers = pool != nullptr ? std::min(pool->getThreadCount(), cores) : 1.0;
+    double budget = std::min(options.budgetSeconds, options.budgetSeconds * workers / pending.size());
+    if (changedOnly) {
+        budget = 0.0; // Touched up after rebalancing: descend once, no restarts
+    }
+    auto solve = [&](size_t index, unsigned) {
+        size_t route = pending[index];
+        solveRoute(routes[route], budget, options.seed + static_cast<uint32_t>(route));
+        routes[route].changed = false;
+    };
+    if (pool != nullptr && pending.size() > 1) {
+        pool->run(pending.size(), solve);
+    } else {
+        for (size_t i = 0; i < pending.size(); i++) {
+            solve(i, 0);
+        }
+    }
+}
+
+// Moves each order to the route that takes it most cheaply if that costs
+// less than it saves where it is, round after round until nothing moves
+uint32_t SampleFleetPlanner::rebalance(std::vector<Work>& routes, uint32_t capacity, uint32_t rounds) const {
+    uint32_t moved = 0;
+    for (uint32_t round = 0; round < rounds; round++) {
+        uint32_t movedThisRound = 0;
+        for (size_t from = 0; from < routes.size(); from++) {
+            std::vector<uint32_t> current(routes[from].orders);
+            for (uint32_t order : current) {
+                double gain = removalGain(routes[from], order);
+                size_t best = routes.size();
+                size_t bestPickupAt = NO_GAP;
+                size_t bestDropoffAt = 0;
+                double bestCost = gain - SAMPLE_MIN_GAIN;
+                for (size_t to = 0; to < routes.size(); to++) {
+                    if (to == from || routes[to].orders.size() >= capacity ||
+                        orderCost(routes[to].depot, order) == std::numeric_limits<double>::max()) {
+                        continue;
+                    }
+                    size_t pickupAt = NO_GAP;
+                    size_t dropoffAt = 0;
+                    double cost = insertionCost(routes[to], order, pickupAt, dropoffAt);
+                    if (cost < bestCost) {
+                        best = to;
+                        bestCost = cost;
+                        bestPickupAt = pickupAt;
+                        bestDropoffAt = dropoffAt;
+                    }
+                }
+                if (best != routes.size()) {
+                    removeOrder(routes[from], order);
+                    insertOrder(routes[best], order, bestPickupAt, bestDropoffAt);
+                    routes[from].changed = true;
+                    routes[best].changed = true;
+                    movedThisRound++;
+                }
+            }
+        }
+        moved += movedThisRound;
+        if (movedThisRound == 0) {
+            break;
+        }
+    }
+    return moved;
+}
+
+SampleFleetPlanner::Plan SampleFleetPlanner::plan(const Options& options, SampleThreadPool* pool) {
+    if (options.truckCount == 0) {
+        throw std::invalid_argument("SampleFleetPlanner: no trucks");
+    }
+    SAMPLE_STATS_SPAN(span, "fleet_partition");
+    if (realLegs.empty()) {
+        computeLegs(pool);
+    }
+    uint32_t capacity = options.capacity;
+    if (capacity == 0) {
+        capacity = static_cast<uint32_t>((orders.size() * 5 + options.truckCount * 4 - 1) / (options.truckCount * 4));
+        capacity = std::max<uint32_t>(capacity, 1);
+    }
+
+    // 1. Partition: trucks to depots in turn, orders to depots, then to trucks
+    std::vector<Work> routes(options.truckCount);
+    std::vector<uint32_t> truckDepots;
+    for (uint32_t truck = 0; truck < options.truckCount; truck++) {
+        routes[truck].depot = static_cast<uint32_t>(truck % depots.size());
+        routes[truck].changed = false;
+        truckDepots.push_back(routes[truck].depot);
+    }
+    Plan plan;
+    std::vector<uint32_t> depotOf = assignDepots(truckDepots, capacity, plan.unserved);
+    for (uint32_t depot = 0; depot < depots.size(); depot++) {
+        std::vector<uint32_t> depotOrders;
+        for (uint32_t order = 0; order < orders.size(); order++) {
+            if (depotOf[order] == depot) depotOrders.push_back(order);
+        }
+        std::vector<uint32_t> trucks;
+        for (uint32_t truck = 0; truck < options.truckCount; truck++) {
+            if (routes[truck].depot == depot) trucks.push_back(truck);
+        }
+        clusterDepot(depotOrders, trucks, capacity, routes);
+    }
+
+    // 2. Solve every route, in parallel
+    SAMPLE_STATS_NEXT(span, "fleet_solve");
+    solveRoutes(routes, false, options, pool);
+
+    // 3. Rebalance, then solve the routes that changed again
+    SAMPLE_STATS_NEXT(span, "fleet_rebalance");
+    plan.movedOrders = rebalance(routes, capacity, options.rebalanceRounds);
+    solveRoutes(routes, true, options, pool);
+    SAMPLE_STATS_END(span);
+
+    plan.distance = 0.0;
+    plan.profit = 0.0;
+    for (const Work& work : routes) {
+        Route route;
+        route.depot = depots[work.depot];
+        route.orders = work.orders;
+        for (uint32_t place : work.stops) {
+            route.stops.push_back(places[place]);
+        }
+        route.distance = routeLength(work, realLegs);
+        route.profit = 0.0;
+        for (uint32_t order : work.orders) {
+            route.profit += orders[order].profit;
+        }
+        if (route.distance == std::numeric_limits<double>::max() ||
+            plan.distance == std::numeric_limits<double>::max()) {
+            plan.distance = std::numeric_limits<double>::max();
+        } else {
+            plan.distance += route.distance;
+        }
+        plan.profit += route.profit;
+        plan.routes.push_back(route);
+    }
+    return plan;
+}
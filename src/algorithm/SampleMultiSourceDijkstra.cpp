@@ -0,0 +1,257 @@
+// SampleMultiSourceDijkstra.cpp
+#include "algorithm/SampleMultiSourceDijkstra.h"
+#include <limits>
+#include <algorithm>
+#include <bitset>
+#include <stdexcept>
+
+// The vector kernels are compiled per function with target attributes and
+// picked at run time, so the rest of the build needs no -mavx flags
+#if SAMPLE_SIMD && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SAMPLE_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+typedef SampleMultiSourceDijkstra::Improvement Improvement;
+
+static const double UNREACHED = std::numeric_limits<double>::max();
+static const unsigned SCALAR_LANES = 4;
+
+// A scan relaxes the arcs [begin, end) of a vertex whose distance row is
+// rowU in every lane, writes one Improvement per target row that got
+// smaller and returns how many there are. An unreached lane of rowU adds up
+// to max() or infinity and never improves anything.
+typedef size_t (*ScanFunction)(const double* rowU, const uint32_t* targets, const double* weights,
+                               uint32_t begin, uint32_t end, double* distance, Improvement* out);
+
+static size_t scanScalar(const double* rowU, const uint32_t* targets, const double* weights,
+                         uint32_t begin, uint32_t end, double* distance, Improvement* out) {
+    size_t count = 0;
+    for (uint32_t arc = begin; arc < end; arc++) {
+        double* rowV = distance + size_t(targets[arc]) * SCALAR_LANES;
+        double weight = weights[arc];
+        double key = UNREACHED;
+        uint32_t improved = 0;
+        uint32_t newLanes = 0;
+        for (unsigned lane = 0; lane < SCALAR_LANES; lane++) {
+            double candidate = rowU[lane] + weight;
+            if (candidate < rowV[lane]) {
+                if (rowV[lane] == UNREACHED) newLanes |= 1u << lane;
+                rowV[lane] = candidate;
+                key = std::min(key, candidate);
+                improved |= 1u << lane;
+            }
+        }
+        if (improved != 0) {
+            Improvement& entry = out[count++];
+            entry.vertex = targets[arc];
+            entry.newLanes = newLanes;
+            entry.key = key;
+        }
+    }
+    return count;
+}
+
+#ifdef SAMPLE_SIMD_X86
+__attribute__((target("avx2")))
+static size_t scanAvx2(const double* rowU, const uint32_t* targets, const double* weights,
+                       uint32_t begin, uint32_t end, double* distance, Improvement* out) {
+    const __m256d du = _mm256_loadu_pd(rowU);
+    const __m256d unreached = _mm256_set1_pd(UNREACHED);
+    size_t count = 0;
+    for (uint32_t arc = begin; arc < end; arc++) {
+        double* rowV = distance + size_t(targets[arc]) * 4;
+        __m256d dv = _mm256_loadu_pd(rowV);
+        __m256d candidate = _mm256_add_pd(du, _mm256_set1_pd(weights[arc]));
+        __m256d less = _mm256_cmp_pd(candidate, dv, _CMP_LT_OQ);
+        int improved = _mm256_movemask_pd(less);
+        if (improved == 0) continue;
+
+        _mm256_storeu_pd(rowV, _mm256_min_pd(candidate, dv));
+        int newLanes = _mm256_movemask_pd(_mm256_cmp_pd(dv, unreached, _CMP_EQ_OQ)) & improved;
+        // Smallest improved lane: the others are masked to max()
+        __m256d keys = _mm256_blendv_pd(unreached, candidate, less);
+        __m128d half = _mm_min_pd(_mm256_castpd256_pd128(keys), _mm256_extractf128_pd(keys, 1));
+        half = _mm_min_sd(half, _mm_unpackhi_pd(half, half));
+
+        Improvement& entry = out[count++];
+        entry.vertex = targets[arc];
+        entry.newLanes = static_cast<uint32_t>(newLanes);
+        entry.key = _mm_cvtsd_f64(half);
+    }
+    return count;
+}
+
+__attribute__((target("avx512f")))
+static size_t scanAvx512(const double* rowU, const uint32_t* targets, const double* weights,
+                         uint32_t begin, uint32_t end, double* distance, Improvement* out) {
+    const __m512d du = _mm512_loadu_pd(rowU);
+    const __m512d unreached = _mm512_set1_pd(UNREACHED);
+    size_t count = 0;
+    for (uint32_t arc = begin; arc < end; arc++) {
+        double* rowV = distance + size_t(targets[arc]) * 8;
+        __m512d dv = _mm512_loadu_pd(rowV);
+        __m512d candidate = _mm512_add_pd(du, _mm512_set1_pd(weights[arc]));
+        __mmask8 improved = _mm512_cmp_pd_mask(candidate, dv, _CMP_LT_OQ);
+        if (improved == 0) continue;
+
+        _mm512_mask_storeu_pd(rowV, improved, candidate);
+        __mmask8 newLanes = _mm512_mask_cmp_pd_mask(improved, dv, unreached, _CMP_EQ_OQ);
+
+        Improvement& entry = out[count++];
+        entry.vertex = targets[arc];
+        entry.newLanes = newLanes;
+        // Smallest improved lane: the others are masked to max()
+        alignas(64) double keys[8];
+        _mm512_store_pd(keys, _mm512_mask_blend_pd(improved, unreached, candidate));
+        entry.key = std::min(std::min(std::min(keys[0], keys[1]), std::min(keys[2], keys[3])),
+                             std::min(std::min(keys[4], keys[5]), std::min(keys[6], keys[7])));
+    }
+    return count;
+}
+#endif
+
+const unsigned SampleMultiSourceDijkstra::MAX_LANES;
+
+SampleMultiSourceDijkstra::SampleMultiSourceDijkstra(uint32_t vertexCount) {
+    this->kernel = detectKernel();
+    this->laneCount = getLaneCount(kernel);
+    this->vertexCount = 0;
+    resize(vertexCount);
+}
+
+SampleMultiSourceDijkstra::SampleMultiSourceDijkstra(uint32_t vertexCount, SampleLaneKernel kernel) {
+    if (!isSupported(kernel)) {
+        throw std::invalid_argument(std::string("Lane kernel not supported here: ") + getKernelName(kernel));
+    }
+    this->kernel = kernel;
+    this->laneCount = getLaneCount(kernel);
+    this->vertexCount = 0;
+    resize(vertexCount);
+}
+
+void SampleMultiSourceDijkstra::resize(uint32_t vertexCount) {
+    if (vertexCount == this->vertexCount && !distance.empty()) {
+        clear();
+        return;
+    }
+    this->vertexCount = vertexCount;
+    distance.assign(size_t(vertexCount) * laneCount, UNREACHED);
+    isReached.assign(vertexCount, 0);
+    reached.clear();
+    queue.reset(vertexCount);
+}
+
+void SampleMultiSourceDijkstra::clear() {
+    // Only rows reached by the last run hold distances
+    for (uint32_t v : reached) {
+        std::fill(distance.begin() + size_t(v) * laneCount, distance.begin() + size_t(v + 1) * laneCount, UNREACHED);
+        isReached[v] = 0;
+    }
+    reached.clear();
+    queue.reset(vertexCount);
+}
+
+void SampleMultiSourceDijkstra::run(const SampleCSRGraph* graph, const uint32_t* sources, unsigned sourceCount,
+                                    const std::vector<char>& isTarget, uint32_t targetCount) {
+    if (sourceCount > laneCount) {
+        throw std::invalid_argument("More sources than lanes");
+    }
+    resize(graph->getVertexCount());
+    reachedTargets.clear();
+
+    ScanFunction scan = scanScalar;
+#ifdef SAMPLE_SIMD_X86
+    if (kernel == SampleLaneKernel::Avx2) scan = scanAvx2;
+    if (kernel == SampleLaneKernel::Avx512) scan = scanAvx512;
+#endif
+
+    // (target, lane) pairs still at max(); early exit needs all of them
+    uint32_t unreachedPairs = targetCount * sourceCount;
+    for (unsigned lane = 0; lane < sourceCount; lane++) {
+        uint32_t source = sources[lane];
+        if (!isReached[source]) {
+            isReached[source] = 1;
+            reached.push_back(source);
+            if (targetCount > 0 && isTarget[source]) reachedTargets.push_back(source);
+        }
+        double& d = distance[size_t(source) * laneCount + lane];
+        if (d == UNREACHED && targetCount > 0 && isTarget[source]) unreachedPairs--;
+        d = 0.0;
+        queue.push(source, 0.0);
+    }
+
+    const uint32_t* offsets = graph->getOffsets();
+    const uint32_t* targets = graph->getTargets();
+    const double* weights = graph->getWeights();
+    // Upper bound on the largest target distance; it only shrinks, so it
+    // is recomputed only when the queue key catches up with it
+    double bound = 0.0;
+    while (!queue.empty()) {
+        if (targetCount > 0 && unreachedPairs == 0 && queue.topKey() >= bound) {
+            bound = 0.0;
+            for (uint32_t target : reachedTargets) {
+                for (unsigned lane = 0; lane < sourceCount; lane++) {
+                    bound = std::max(bound, getDistance(lane, target));
+                }
+            }
+            if (queue.topKey() >= bound) break; // no queued key can lower a target
+        }
+
+        uint32_t u = queue.pop();
+        uint32_t begin = offsets[u];
+        uint32_t end = offsets[u + 1];
+        if (improvements.size() < end - begin) {
+            improvements.resize(end - begin);
+        }
+        size_t count = scan(&distance[size_t(u) * laneCount], targets, weights, begin, end,
+                            distance.data(), improvements.data());
+
+        for (size_t i = 0; i < count; i++) {
+            const Improvement& entry = improvements[i];
+            uint32_t v = entry.vertex;
+            if (!isReached[v]) {
+                isReached[v] = 1;
+                reached.push_back(v);
+                if (targetCount > 0 && isTarget[v]) reachedTargets.push_back(v);
+            }
+            if (targetCount > 0 && entry.newLanes != 0 && isTarget[v]) {
+                unreachedPairs -= static_cast<uint32_t>(std::bitset<32>(entry.newLanes).count());
+            }
+            queue.push(v, entry.key);
+        }
+    }
+}
+
+SampleLaneKernel SampleMultiSourceDijkstra::detectKernel() {
+    if (isSupported(SampleLaneKernel::Avx512)) return SampleLaneKernel::Avx512;
+    if (isSupported(SampleLaneKernel::Avx2)) return SampleLaneKernel::Avx2;
+    return SampleLaneKernel::Scalar;
+}
+
+bool SampleMultiSourceDijkstra::isSupported(SampleLaneKernel kernel) {
+    switch (kernel) {
+#ifdef SAMPLE_SIMD_X86
+    case SampleLaneKernel::Avx512:
+        return __builtin_cpu_supports("avx512f");
+    case SampleLaneKernel::Avx2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    case SampleLaneKernel::Scalar:
+        return true;
+    default:
+        return false;
+    }
+}
+
+unsigned SampleMultiSourceDijkstra::getLaneCount(SampleLaneKernel kernel) {
+    return kernel == SampleLaneKernel::Avx512 ? 8 : kernel == SampleLaneKernel::Avx2 ? 4 : SCALAR_LANES;
+}
+
+const char* SampleMultiSourceDijkstra::getKernelName(SampleLaneKernel kernel) {
+    switch (kernel) {
+    case SampleLaneKernel::Avx512: return "avx512";
+    case SampleLaneKernel::Avx2: return "avx2";
+    default: return "scalar";
+    }
+}
@@ -0,0 +1,68 @@
+// SampleQueryBatch.cpp
+#include "algorithm/SampleQueryBatch.h"
+#include "algorithm/SampleDijkstra.h"
+#include "algorithm/SampleQueryContext.h"
+#include <limits>
+
+SampleQueryBatch::SampleQueryBatch(const SampleCSRGraph* graph, bool withPaths) {
+    this->graph = graph;
+    this->withPaths = withPaths;
+}
+
+size_t SampleQueryBatch::submit(uint32_t source, const std::vector<uint32_t>& targets) {
+    Job job;
+    job.source = source;
+    job.targets = targets;
+    jobs.push_back(job);
+    return jobs.size() - 1;
+}
+
+void SampleQueryBatch::run(SampleThreadPool* pool) {
+    uint32_t n = graph->getVertexCount();
+    unsigned workerCount = pool != nullptr ? pool->getThreadCount() : 1;
+    std::vector<SampleQueryContext> contexts(workerCount, SampleQueryContext(n));
+    // Target markers per worker, set for one job and cleared after it
+    std::vector<std::vector<char> > markers(workerCount, std::vector<char>(n, 0));
+
+    // Each job is answered by exactly one search and written by one worker
+    std::function<void(size_t, unsigned)> runJob = [&](size_t index, unsigned worker) {
+        Job& job = jobs[index];
+        if (job.targets.empty()) return;
+        std::vector<char>& isTarget = markers[worker];
+        uint32_t targetCount = 0;
+        for (uint32_t target : job.targets) {
+            if (!isTarget[target]) {
+                isTarget[target] = 1;
+                targetCount++;
+            }
+        }
+        
+        SampleQueryContext& context = contexts[worker];
+        SampleDijkstra::runOneToMany(graph, job.source, isTarget, targetCount, context);
+        job.distances.resize(job.targets.size());
+        if (withPaths) {
+            job.paths.resize(job.targets.size());
+        }
+        for (size_t i = 0; i < job.targets.size(); i++) {
+            job.distances[i] = context.getDistance(job.targets[i]);
+            if (withPaths) {
+                job.paths[i] = context.getPath(job.targets[i]);
+            }
+            isTarget[job.targets[i]] = 0;
+        }
+    };
+
+    if (pool != nullptr) {
+        pool->run(jobs.size(), runJob);
+    } else {
+        for (size_t index = 0; index < jobs.size(); index++) {
+            runJob(index, 0);
+        }
+    }
+}
+
+const std::vector<uint32_t>& SampleQueryBatch::getPath(size_t job, size_t target) const {
+    static const std::vector<uint32_t> noPath;
+    const Job& entry = jobs[job];
+    return target < entry.paths.size() ? entry.paths[target] : noPath;
+}
@@ -0,0 +1,52 @@
+// SampleQueryContext.cpp
+#include "algorithm/SampleQueryContext.h"
+#include <algorithm>
+
+const uint32_t SampleQueryContext::NO_VERTEX;
+SampleHeapType SampleQueryContext::defaultHeapType = static_cast<SampleHeapType>(SAMPLE_DEFAULT_HEAP);
+
+SampleQueryContext::SampleQueryContext(uint32_t vertexCount) {
+    this->generation = 1;
+    this->source = NO_VERTEX;
+    this->heapType = defaultHeapType;
+    reset(vertexCount);
+}
+
+void SampleQueryContext::reset(uint32_t vertexCount) {
+    touched.clear();
+    source = NO_VERTEX;
+
+    if (vertexCount != stamp.size()) {
+        // Graph size changed, start over with fresh arrays
+        distance.assign(vertexCount, std::numeric_limits<double>::max());
+        parent.assign(vertexCount, NO_VERTEX);
+        stamp.assign(vertexCount, 0);
+        settled.assign(vertexCount, 0);
+        generation = 1;
+        return;
+    }
+
+    generation++;
+    if (generation == 0) {
+        // Stamps wrapped around, clear them once so old entries cannot match
+        std::fill(stamp.begin(), stamp.end(), 0);
+        generation = 1;
+    }
+}
+
+std::vector<uint32_t> SampleQueryContext::getPath(uint32_t target) const {
+    std::vector<uint32_t> path;
+    if (getDistance(target) == std::numeric_limits<double>::max()) {
+        return path; // Return empty path if target is unreachable
+    }
+
+    for (uint32_t at = target; at != NO_VERTEX; at = getParent(at)) {
+        path.push_back(at);
+    }
+    std::reverse(path.begin(), path.end());
+
+    if (path[0] != source) {
+        path.clear();
+    }
+    return path;
+}
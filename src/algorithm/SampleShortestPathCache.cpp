@@ -0,0 +1,96 @@
+// SampleShortestPathCache.cpp
+#include "algorithm/SampleShortestPathCache.h"
+#include <algorithm>
+#include <limits>
+
+const uint32_t SampleShortestPathCache::NO_VERTEX;
+const size_t SampleShortestPathCache::DEFAULT_MAX_BYTES;
+
+std::vector<uint32_t> SampleShortestPathCache::Tree::getPath(uint32_t target) const {
+    std::vector<uint32_t> path;
+    if (target >= distance.size() || distance[target] == std::numeric_limits<double>::max()) {
+        return path;
+    }
+    for (uint32_t at = target; at != NO_VERTEX; at = parent[at]) {
+        path.push_back(at);
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+SampleShortestPathCache::SampleShortestPathCache(size_t maxBytes) {
+    this->maxBytes = maxBytes;
+    this->bytes = 0;
+    this->version = 0;
+    this->hits = 0;
+    this->misses = 0;
+    this->evictions = 0;
+    this->invalidations = 0;
+}
+
+void SampleShortestPathCache::validate(unsigned long graphVersion) {
+    if (graphVersion != version) {
+        if (!trees.empty()) {
+            invalidations++;
+        }
+        clear();
+        version = graphVersion;
+    }
+}
+
+const SampleShortestPathCache::Tree* SampleShortestPathCache::find(uint32_t source) {
+    auto it = index.find(source);
+    if (it == index.end()) {
+        misses++;
+        return nullptr;
+    }
+    hits++;
+    trees.splice(trees.begin(), trees, it->second); // Now the most recently used
+    return &trees.front();
+}
+
+const SampleShortestPathCache::Tree& SampleShortestPathCache::insert(const SampleQueryContext& context,
+                                                                      uint32_t vertexCount) {
+    uint32_t source = context.getSource();
+    auto it = index.find(source);
+    if (it != index.end()) {
+        bytes -= treeBytes(static_cast<uint32_t>(it->second->distance.size()));
+        trees.erase(it->second);
+        index.erase(it);
+    }
+
+    trees.push_front(Tree());
+    Tree& tree = trees.front();
+    tree.source = source;
+    tree.distance.assign(vertexCount, std::numeric_limits<double>::max());
+    tree.parent.assign(vertexCount, NO_VERTEX);
+    for (uint32_t v : context.getTouched()) {
+        tree.distance[v] = context.getDistance(v);
+        tree.parent[v] = context.getParent(v);
+    }
+    index[source] = trees.begin();
+    bytes += treeBytes(vertexCount);
+    evict();
+    return tree;
+}
+
+void SampleShortestPathCache::evict() {
+    while (bytes > maxBytes && trees.size() > 1) {
+        const Tree& oldest = trees.back();
+        bytes -= treeBytes(static_cast<uint32_t>(oldest.distance.size()));
+        index.erase(oldest.source);
+        trees.pop_back();
+        evictions++;
+    }
+}
+
+void SampleShortestPathCache::clear() {
+    trees.clear();
+    index.clear();
+    bytes = 0;
+}
+
+void SampleShortestPathCache::setMaxBytes(size_t maxBytes) {
+    this->maxBytes = maxBytes;
+    evict();
+}
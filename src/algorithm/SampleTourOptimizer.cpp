@@ -0,0 +1,331 @@
+// SampleTourOptimizer.cpp
+#include "algorithm/SampleTourOptimizer.h"
+#include "util/SampleMath.h"
+#include <algorithm>
+#include <random>
+#include <limits>
+#include <stdexcept>
+#include <cmath>
+
+namespace {
+
+const uint32_t CLOCK_STRIDE = 16;   // stops examined between looks at the clock
+const uint32_t KICK_MOVES = 3;      // random relocations per kick
+const uint32_t KICK_TRIES = 64;     // attempts at finding a feasible one
+
+} // namespace
+
+SampleTourOptimizer::SampleTourOptimizer(uint32_t stopCount, const std::vector<double>& legs,
+                                         const std::vector<uint32_t>& pickupOf)
+    : stopCount(stopCount), realLegs(legs), legs(legs), pickupOf(pickupOf) {
+    size_t side = static_cast<size_t>(stopCount) + 1;
+    if (legs.size() != side * side) {
+        throw std::invalid_argument("SampleTourOptimizer: the leg matrix must be (stops + 1) squared");
+    }
+    if (pickupOf.size() != side || pickupOf[0] != 0) {
+        throw std::invalid_argument("SampleTourOptimizer: one pickup entry per stop, none for the depot");
+    }
+
+    // An unreachable leg costs more than a whole tour of reachable ones, so
+    // the search gets rid of it whenever some order can
+    samplePenalizeUnreachable(this->legs, side);
+
+    dropoffsOf.resize(side);
+    for (uint32_t stop = 1; stop <= stopCount; stop++) {
+        uint32_t pickup = pickupOf[stop];
+        if (pickup > stopCount || pickup == stop) {
+            throw std::invalid_argument("SampleTourOptimizer: bad pickup for a stop");
+        }
+        if (pickup != 0) {
+            dropoffsOf[pickup].push_back(stop);
+        }
+    }
+}
+
+double SampleTourOptimizer::realLength(const std::vector<uint32_t>& order) const {
+    double length = 0.0;
+    uint32_t from = 0;
+    for (size_t i = 0; i <= order.size(); i++) {
+        uint32_t to = i < order.size() ? order[i] : 0;
+        double step = realLegs[from * (stopCount + 1) + to];
+        if (!sampleIsReachable(step)) {
+            return std::numeric_limits<double>::max();
+        }
+        length += step;
+        from = to;
+    }
+    return length;
+}
+
+// The count nearest stops by leg from a, kept sorted while scanning a's
+// row of the matrix, which reads it in order and sorts nothing big
+void SampleTourOptimizer::buildNeighbours(uint32_t count) {
+    count = std::min(count, stopCount > 0 ? stopCount - 1 : 0);
+    neighbours.assign(stopCount + 1, std::vector<uint32_t>());
+    std::vector<std::pair<double, uint32_t> > nearest;
+    for (uint32_t a = 1; a <= stopCount; a++) {
+        nearest.clear();
+        for (uint32_t b = 1; b <= stopCount && count > 0; b++) {
+            std::pair<double, uint32_t> candidate(leg(a, b), b);
+            if (b == a || (nearest.size() == count && !(candidate < nearest.back()))) {
+                continue;
+            }
+            if (nearest.size() == count) {
+                nearest.pop_back();
+            }
+            nearest.insert(std::upper_bound(nearest.begin(), nearest.end(), candidate), candidate);
+        }
+        for (const auto& neighbour : nearest) {
+            neighbours[a].push_back(neighbour.second);
+        }
+    }
+}
+
+// Positions, prefix sums and the dropoff suffix minimum after a move; O(n),
+// which every array-based tour pays for applying a move anyway
+void SampleTourOptimizer::refresh() {
+    uint32_t end = stopCount + 1;
+    position.resize(end + 1);
+    forward.assign(end + 1, 0.0);
+    backward.assign(end + 1, 0.0);
+    for (uint32_t p = 0; p <= end; p++) {
+        position[tour[p]] = p;
+        if (p > 0) {
+            forward[p] = forward[p - 1] + leg(tour[p - 1], tour[p]);
+            backward[p] = backward[p - 1] + leg(tour[p], tour[p - 1]);
+        }
+    }
+    position[0] = 0;
+
+    firstDropoff.assign(end + 1, end + 1);
+    for (uint32_t p = stopCount; p >= 1; p--) {
+        uint32_t first = firstDropoff[p + 1];
+        for (uint32_t dropoff : dropoffsOf[tour[p]]) {
+            first = std::min(first, position[dropoff]);
+        }
+        firstDropoff[p] = first;
+    }
+}
+
+void SampleTourOptimizer::activate(uint32_t stop) {
+    if (stop != 0 && !queued[stop]) {
+        queued[stop] = 1;
+        active.push_back(stop);
+    }
+}
+
+// Reverses tour[i..j] so that a and b become adjacent: a -> b if a comes
+// first, b -> a otherwise
+bool SampleTourOptimizer::tryTwoOpt(uint32_t a, uint32_t b) {
+    uint32_t pa = position[a];
+    uint32_t pb = position[b];
+    uint32_t i = pa < pb ? pa + 1 : pb;
+    uint32_t j = pa < pb ? pb : pa - 1;
+    if (i >= j || firstDropoff[i] <= j) {
+        return false; // Already adjacent, or a pickup and its dropoff inside
+    }
+    double gain = leg(tour[i - 1], tour[i]) + leg(tour[j], tour[j + 1]) + (forward[j] - forward[i])
+                - leg(tour[i - 1], tour[j]) - leg(tour[i], tour[j + 1]) - (backward[j] - backward[i]);
+    if (gain <= SAMPLE_MIN_GAIN) {
+        return false;
+    }
+    activate(tour[i - 1]);
+    activate(tour[i]);
+    activate(tour[j]);
+    activate(tour[j + 1]);
+    std::reverse(tour.begin() + i, tour.begin() + j + 1);
+    refresh();
+    result.twoOptMoves++;
+    return true;
+}
+
+// Moving tour[first..last] between tour[after] and tour[after + 1] jumps
+// the stops in between; none of them may be a pickup of a moved dropoff
+// (moving back) or a dropoff of a moved pickup (moving on), and reversing
+// the run must not reverse a pair inside it
+bool SampleTourOptimizer::canMove(uint32_t first, uint32_t last, uint32_t after, bool reversed) const {
+    for (uint32_t p = first; p <= last; p++) {
+        uint32_t stop = tour[p];
+        if (pickupOf[stop] != 0) {
+            uint32_t pickup = position[pickupOf[stop]];
+            if (pickup >= first && pickup <= last) {
+                if (reversed) return false;
+            } else if (after < first && pickup > after) {
+                return false;
+            }
+        }
+        for (uint32_t dropoff : dropoffsOf[stop]) {
+            uint32_t at = position[dropoff];
+            if (at >= first && at <= last) {
+                if (reversed) return false;
+            } else if (after > last && at <= after) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+double SampleTourOptimizer::moveGain(uint32_t first, uint32_t last, uint32_t after, bool reversed) const {
+    uint32_t head = reversed ? tour[last] : tour[first];
+    uint32_t tail = reversed ? tour[first] : tour[last];
+    double gain = leg(tour[first - 1], tour[first]) + leg(tour[last], tour[last + 1]) + leg(tour[after], tour[after + 1])
+                - leg(tour[first - 1], tour[last + 1]) - leg(tour[after], head) - leg(tail, tour[after + 1]);
+    if (reversed) {
+        gain += (forward[last] - forward[first]) - (backward[last] - backward[first]);
+    }
+    return gain;
+}
+
+void SampleTourOptimizer::applyMove(uint32_t first, uint32_t last, uint32_t after, bool reversed) {
+    activate(tour[first - 1]);
+    activate(tour[first]);
+    activate(tour[last]);
+    activate(tour[last + 1]);
+    activate(tour[after]);
+    activate(tour[after + 1]);
+    uint32_t length = last - first + 1;
+    if (after > last) {
+        std::rotate(tour.begin() + first, tour.begin() + last + 1, tour.begin() + after + 1);
+        first = after + 1 - length;
+    } else {
+        std::rotate(tour.begin() + after + 1, tour.begin() + first, tour.begin() + last + 1);
+        first = after + 1;
+    }
+    if (reversed) {
+        std::reverse(tour.begin() + first, tour.begin() + first + length);
+    }
+    refresh();
+}
+
+bool SampleTourOptimizer::tryMove(uint32_t first, uint32_t last, uint32_t after, bool reversed) {
+    if (first < 1 || last > stopCount || (after + 1 >= first && after <= last)) {
+        return false; // Off the tour, or back where it is
+    }
+    if (moveGain(first, last, after, reversed) <= SAMPLE_MIN_GAIN || !canMove(first, last, after, reversed)) {
+        return false;
+    }
+    applyMove(first, last, after, reversed);
+    if (first == last) {
+        result.relocateMoves++;
+    } else {
+        result.orOptMoves++;
+    }
+    return true;
+}
+
+// First improving move that puts a next to one of its neighbours
+bool SampleTourOptimizer::improveStop(uint32_t a, uint32_t maxSegment) {
+    for (uint32_t b : neighbours[a]) {
+        if (tryTwoOpt(a, b)) {
+            return true;
+        }
+        uint32_t pa = position[a];
+        uint32_t pb = position[b];
+        for (uint32_t length = 1; length <= maxSegment; length++) {
+            uint32_t end = pa + length - 1;                     // run starting at a
+            uint32_t start = length <= pa ? pa + 1 - length : 0; // run ending at a, 0 if none
+            bool reversible = length > 1;
+            // b -> a: a heads the run, placed after b
+            if (tryMove(pa, end, pb, false) || (reversible && tryMove(start, pa, pb, true))) {
+                return true;
+            }
+            // a -> b: a ends the run, placed before b
+            if (tryMove(start, pa, pb - 1, false) || (reversible && tryMove(pa, end, pb - 1, true))) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool SampleTourOptimizer::descend(uint32_t maxSegment, bool limited, Clock::time_point deadline) {
+    uint32_t examined = 0;
+    while (!active.empty()) {
+        if (limited && ++examined % CLOCK_STRIDE == 0 && Clock::now() >= deadline) {
+            return false;
+        }
+        uint32_t a = active.front();
+        active.pop_front();
+        queued[a] = 0;
+        if (improveStop(a, maxSegment)) {
+            activate(a);
+        }
+    }
+    return true;
+}
+
+SampleTourOptimizer::Result SampleTourOptimizer::optimize(const std::vector<uint32_t>& initial, const Options& options) {
+    Clock::time_point start = Clock::now();
+    bool limited = options.budgetSeconds > 0;
+    Clock::time_point deadline = start + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(limited ? options.budgetSeconds : 0.0));
+
+    std::vector<char> seen(stopCount + 1, 0);
+    if (initial.size() != stopCount) {
+        throw std::invalid_argument("SampleTourOptimizer: the initial order must visit every stop once");
+    }
+    for (uint32_t stop : initial) {
+        if (stop < 1 || stop > stopCount || seen[stop]) {
+            throw std::invalid_argument("SampleTourOptimizer: the initial order must visit every stop once");
+        }
+        seen[stop] = 1;
+    }
+
+    tour.assign(1, 0);
+    tour.insert(tour.end(), initial.begin(), initial.end());
+    tour.push_back(0);
+    refresh();
+    for (uint32_t stop = 1; stop <= stopCount; stop++) {
+        if (pickupOf[stop] != 0 && position[pickupOf[stop]] > position[stop]) {
+            throw std::invalid_argument("SampleTourOptimizer: the initial order visits a dropoff before its pickup");
+        }
+    }
+
+    result = Result();
+    result.initialLength = realLength(initial);
+    buildNeighbours(options.neighbourCount);
+    uint32_t maxSegment = std::max<uint32_t>(options.maxSegment, 1);
+    queued.assign(stopCount + 1, 0);
+    active.clear();
+    for (uint32_t stop : initial) {
+        activate(stop);
+    }
+    result.localOptimum = descend(maxSegment, limited, deadline);
+
+    // Iterated local search: kick the best tour, descend, keep it if better
+    std::vector<uint32_t> best(tour);
+    double bestLength = forward[stopCount + 1];
+    std::mt19937 rng(options.seed);
+    while (limited && result.localOptimum && stopCount >= 3 && Clock::now() < deadline) {
+        for (uint32_t kick = 0; kick < KICK_MOVES; kick++) {
+            for (uint32_t attempt = 0; attempt < KICK_TRIES; attempt++) {
+                uint32_t first = std::uniform_int_distribution<uint32_t>(1, stopCount)(rng);
+                uint32_t length = std::uniform_int_distribution<uint32_t>(
+                    1, std::min(maxSegment, stopCount + 1 - first))(rng);
+                uint32_t last = first + length - 1;
+                uint32_t after = std::uniform_int_distribution<uint32_t>(0, stopCount)(rng);
+                if ((after + 1 < first || after > last) && canMove(first, last, after, false)) {
+                    applyMove(first, last, after, false);
+                    break;
+                }
+            }
+        }
+        result.kicks++;
+        descend(maxSegment, limited, deadline);
+        if (forward[stopCount + 1] < bestLength - SAMPLE_MIN_GAIN) {
+            best = tour;
+            bestLength = forward[stopCount + 1];
+        } else {
+            tour = best;
+            refresh();
+            active.clear();
+            queued.assign(stopCount + 1, 0);
+        }
+    }
+
+    result.order.assign(best.begin() + 1, best.end() - 1);
+    result.length = realLength(result.order);
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return result;
+}
@@ -0,0 +1,89 @@
+// SampleCSRGraph.cpp
+#include "graph/SampleCSRGraph.h"
+#include "graph/SampleEdge.h"
+
+SampleCSRGraph::SampleCSRGraph(const std::vector<SampleVertex*>& vertices, bool undirected) {
+    this->vertices = vertices;
+    this->undirected = undirected;
+
+    // First pass: count the arcs leaving each vertex
+    size_t n = vertices.size();
+    offsets.assign(n + 1, 0);
+    for (size_t u = 0; u < n; u++) {
+        for (SampleEdge* edge : vertices[u]->getNeighbors()) {
+            // A directed graph only owns the edges that start at the vertex
+            if (undirected || edge->getVertexF() == vertices[u]) {
+                offsets[u + 1]++;
+            }
+        }
+    }
+    for (size_t u = 0; u < n; u++) {
+        offsets[u + 1] += offsets[u];
+    }
+
+    // Second pass: fill the target and weight arrays.
+    // An undirected edge sits in the neighbour list of both endpoints, so each
+    // endpoint emits the arc pointing at the other one.
+    targets.resize(offsets[n]);
+    weights.resize(offsets[n]);
+    for (size_t u = 0; u < n; u++) {
+        uint32_t arc = offsets[u];
+        for (SampleEdge* edge : vertices[u]->getNeighbors()) {
+            SampleVertex* other;
+            if (edge->getVertexF() == vertices[u]) {
+                other = edge->getVertexT();
+            } else if (undirected) {
+                other = edge->getVertexF();
+            } else {
+                continue;
+            }
+            targets[arc] = other->getId();
+            weights[arc] = edge->getWeight();
+            arc++;
+        }
+    }
+
+    this->vertexCount = static_cast<uint32_t>(n);
+    this->arcCount = offsets[n];
+    this->offsetData = offsets.data();
+    this->targetData = targets.data();
+    this->weightData = weights.data();
+}
+
+SampleCSRGraph::SampleCSRGraph(const std::vector<SampleVertex*>& vertices,
+                               const std::vector<std::vector<SampleEdge*> >& outgoing) {
+    this->vertices = vertices;
+    this->undirected = false;
+
+    size_t n = vertices.size();
+    offsets.assign(n + 1, 0);
+    for (size_t u = 0; u < n; u++) {
+        offsets[u + 1] = offsets[u] + static_cast<uint32_t>(outgoing[u].size());
+    }
+    targets.resize(offsets[n]);
+    weights.resize(offsets[n]);
+    for (size_t u = 0; u < n; u++) {
+        uint32_t arc = offsets[u];
+        for (SampleEdge* edge : outgoing[u]) {
+            targets[arc] = edge->getVertexT()->getId();
+            weights[arc] = edge->getWeight();
+            arc++;
+        }
+    }
+
+    this->vertexCount = static_cast<uint32_t>(n);
+    this->arcCount = offsets[n];
+    this->offsetData = offsets.data();
+    this->targetData = targets.data();
+    this->weightData = weights.data();
+}
+
+SampleCSRGraph::SampleCSRGraph(uint32_t vertexCount, uint32_t arcCount, const uint32_t* offsets,
+                               const uint32_t* targets, const double* weights, bool undirected) {
+    this->undirected = undirected;
+    this->vertexCount = vertexCount;
+    this->arcCount = arcCount;
+    this->offsetData = offsets;
+    this->targetData = targets;
+    this->weightData = weights;
+}
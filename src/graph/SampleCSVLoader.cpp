@@ -0,0 +1,133 @@
+// SampleCSVLoader.cpp
+#include "graph/SampleCSVLoader.h"
+#include "util/SampleMappedFile.h"
+#include "util/SampleCSVScanner.h"
+#include "util/SampleStats.h"
+#include <stdexcept>
+#include <sstream>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+namespace {
+
+struct EdgeRow {
+    uint32_t from;
+    uint32_t to;
+    double distance;
+};
+
+std::runtime_error lineError(const std::string& file, size_t line, const std::string& message) {
+    std::ostringstream text;
+    text << file << ":" << line << ": " << message;
+    return std::runtime_error(text.str());
+}
+
+std::string quote(const SampleCSVField& field) {
+    return "'" + field.toString() + "'";
+}
+
+} // namespace
+
+SamplePositiveGraph* SampleCSVLoader::loadPositiveGraph(const std::string& verticesFile, const std::string& distancesFile) {
+    SAMPLE_STATS_SPAN(span, "csv_load");
+    SampleMappedFile vertexData(verticesFile);
+    SampleMappedFile distanceData(distancesFile);
+    SAMPLE_STATS_LOCAL(parsedRows);
+
+    // First pass: row counts, so nothing is regrown while parsing
+    size_t vertexRows = SampleCSVScanner::countLines(vertexData.begin(), vertexData.end());
+    size_t distanceRows = SampleCSVScanner::countLines(distanceData.begin(), distanceData.end());
+
+    SamplePositiveGraph* graph = new SamplePositiveGraph();
+    graph->reserve(vertexRows, distanceRows);
+
+    try {
+        const size_t VERTEX_FIELDS = 6;
+        SampleCSVField fields[VERTEX_FIELDS];
+        SampleCSVScanner vertexScanner(vertexData.begin(), vertexData.end());
+        vertexScanner.nextLine(); // Skip header line
+        while (vertexScanner.nextLine()) {
+            if (vertexScanner.isBlankLine()) continue;
+            SAMPLE_STATS_INC(parsedRows);
+            size_t line = vertexScanner.getLineNumber();
+            size_t count = vertexScanner.splitFields(fields, VERTEX_FIELDS);
+            if (count != VERTEX_FIELDS) {
+                std::ostringstream message;
+                message << "expected " << VERTEX_FIELDS << " fields (name,latitude,longitude,mapRow,mapCol,type), found " << count;
+                throw lineError(verticesFile, line, message.str());
+            }
+            if (fields[0].length() == 0) {
+                throw lineError(verticesFile, line, "empty vertex name");
+            }
+            double latitude, longitude;
+            int mapRow, mapCol;
+            if (!SampleCSVScanner::parseDouble(fields[1].begin, fields[1].end, latitude)) {
+                throw lineError(verticesFile, line, "bad latitude " + quote(fields[1]));
+            }
+            if (!SampleCSVScanner::parseDouble(fields[2].begin, fields[2].end, longitude)) {
+                throw lineError(verticesFile, line, "bad longitude " + quote(fields[2]));
+            }
+            if (!SampleCSVScanner::parseInt(fields[3].begin, fields[3].end, mapRow)) {
+                throw lineError(verticesFile, line, "bad mapRow " + quote(fields[3]));
+            }
+            if (!SampleCSVScanner::parseInt(fields[4].begin, fields[4].end, mapCol)) {
+                throw lineError(verticesFile, line, "bad mapCol " + quote(fields[4]));
+            }
+
+            SampleVertex* vertex = graph->createVertex(fields[0].toString());
+            vertex->setLatitude(latitude);
+            vertex->setLongitude(longitude);
+            vertex->setMapRow(mapRow);
+            vertex->setMapCol(mapCol);
+            vertex->setVertexType(sampleParseVertexType(fields[5].begin, fields[5].end));
+        }
+
+        // Distances: parse every row first to learn the vertex degrees
+        const size_t DISTANCE_FIELDS = 3;
+        std::vector<EdgeRow> rows;
+        rows.reserve(distanceRows);
+        std::vector<uint32_t> degree(graph->getVertexList().size(), 0);
+        SampleCSVScanner distanceScanner(distanceData.begin(), distanceData.end());
+        distanceScanner.nextLine(); // Skip header line
+        while (distanceScanner.nextLine()) {
+            if (distanceScanner.isBlankLine()) continue;
+            SAMPLE_STATS_INC(parsedRows);
+            size_t line = distanceScanner.getLineNumber();
+            size_t count = distanceScanner.splitFields(fields, DISTANCE_FIELDS);
+            if (count != DISTANCE_FIELDS) {
+                std::ostringstream message;
+                message << "expected " << DISTANCE_FIELDS << " fields (from,to,distance), found " << count;
+                throw lineError(distancesFile, line, message.str());
+            }
+            EdgeRow row;
+            if (!SampleCSVScanner::parseDouble(fields[2].begin, fields[2].end, row.distance)) {
+                throw lineError(distancesFile, line, "bad distance " + quote(fields[2]));
+            }
+            row.from = graph->findVertexId(fields[0].begin, fields[0].end);
+            row.to = graph->findVertexId(fields[1].begin, fields[1].end);
+            if (row.from == SamplePositiveGraph::NO_VERTEX || row.to == SamplePositiveGraph::NO_VERTEX) continue; // Unknown place
+            degree[row.from]++;
+            degree[row.to]++;
+            rows.push_back(row);
+        }
+
+        const std::vector<SampleVertex*>& vertexList = graph->getVertexList();
+        for (size_t id = 0; id < vertexList.size(); id++) {
+            vertexList[id]->reserveNeighbors(degree[id]);
+        }
+        for (const EdgeRow& row : rows) {
+            graph->addEdge(row.from, row.to, row.distance);
+        }
+    } catch (...) {
+        delete graph;
+        throw;
+    }
+    
+    SAMPLE_STATS_ADD(CSVBytes, vertexData.getSize() + distanceData.getSize());
+    SAMPLE_STATS_ADD(CSVRows, parsedRows);
+    SAMPLE_STATS_ARG(span, "bytes", static_cast<double>(vertexData.getSize() + distanceData.getSize()));
+    SAMPLE_STATS_ARG(span, "rows", static_cast<double>(parsedRows));
+    SAMPLE_STATS_ARG(span, "rows_per_second", parsedRows / std::max(span.getSeconds(), 1e-9));
+    return graph;
+}
@@ -0,0 +1,190 @@
+// SampleGraphGenerator.cpp
+#include "graph/SampleGraphGenerator.h"
+#include "graph/SampleCSRGraph.h"
+#include "graph/SampleVertex.h"
+#include "util/SampleMath.h"
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+
+static const double KM_PER_DEGREE = 111.32; // latitude degree, and longitude at the equator
+static const double GEOMETRIC_DEGREE = 6.0; // mean neighbours per point of a geometric map
+
+static double roundTo(double value, double scale) {
+    return std::round(value * scale) / scale;
+}
+
+SampleGraphGenerator::Options::Options() {
+    layout = SampleMapLayout::Grid;
+    vertexCount = 1000;
+    pickupShare = 0.02;
+    dropoffShare = 0.02;
+    garageShare = 0.0;
+    spacingKm = 0.2;
+    originLatitude = 34.0;
+    originLongitude = -118.3;
+    seed = 42;
+}
+
+SamplePositiveGraph* SampleGraphGenerator::generate(const Options& options) {
+    uint32_t n = options.vertexCount;
+    std::mt19937 rng(options.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::uniform_real_distribution<double> detour(1.0, 1.25);
+
+    // Positions in km from the origin
+    std::vector<double> x(n), y(n);
+    uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(n))));
+    double width = options.spacingKm * side;
+    for (uint32_t i = 0; i < n; i++) {
+        if (options.layout == SampleMapLayout::Grid) {
+            x[i] = ((i % side) + 0.3 * (unit(rng) - 0.5)) * options.spacingKm;
+            y[i] = ((i / side) + 0.3 * (unit(rng) - 0.5)) * options.spacingKm;
+        } else {
+            x[i] = unit(rng) * width;
+            y[i] = unit(rng) * width;
+        }
+    }
+
+    // Roles: a random subset of the places, garages first
+    uint32_t garages = std::max<uint32_t>(1, static_cast<uint32_t>(options.garageShare * n));
+    uint32_t pickups = static_cast<uint32_t>(options.pickupShare * n);
+    uint32_t dropoffs = static_cast<uint32_t>(options.dropoffShare * n);
+    garages = std::min(garages, n);
+    pickups = std::min(pickups, n - garages);
+    dropoffs = std::min(dropoffs, n - garages - pickups);
+    std::vector<uint32_t> order(n);
+    for (uint32_t i = 0; i < n; i++) order[i] = i;
+    std::shuffle(order.begin(), order.end(), rng);
+    std::vector<SampleVertexType> types(n, SampleVertexType::Normal);
+    std::vector<uint32_t> garageNumber(n, 0);
+    for (uint32_t k = 0; k < garages + pickups + dropoffs; k++) {
+        if (k < garages) {
+            types[order[k]] = SampleVertexType::Garage;
+            garageNumber[order[k]] = k + 1;
+        } else {
+            types[order[k]] = k < garages + pickups ? SampleVertexType::Pickup : SampleVertexType::Dropoff;
+        }
+    }
+
+    SamplePositiveGraph* graph = new SamplePositiveGraph();
+    graph->reserve(n, options.layout == SampleMapLayout::Grid ? 2 * size_t(n) : size_t(GEOMETRIC_DEGREE / 2 * n) + n);
+    double kmPerLongitude = KM_PER_DEGREE * std::cos(options.originLatitude * SAMPLE_PI / 180.0);
+    for (uint32_t i = 0; i < n; i++) {
+        std::string name;
+        switch (types[i]) {
+        case SampleVertexType::Garage:
+            name = garageNumber[i] == 1 ? "Garage" : "Garage" + std::to_string(garageNumber[i]);
+            break;
+        case SampleVertexType::Pickup: name = "P" + std::to_string(i); break;
+        case SampleVertexType::Dropoff: name = "D" + std::to_string(i); break;
+        default: name = "V" + std::to_string(i); break;
+        }
+        SampleVertex* vertex = graph->createVertex(name);
+        vertex->setVertexType(types[i]);
+        vertex->setLatitude(roundTo(options.originLatitude + y[i] / KM_PER_DEGREE, 1e6));
+        vertex->setLongitude(roundTo(options.originLongitude + x[i] / kmPerLongitude, 1e6));
+        vertex->setMapRow(static_cast<int>(y[i] / options.spacingKm));
+        vertex->setMapCol(static_cast<int>(x[i] / options.spacingKm));
+    }
+
+    auto addRoad = [&](uint32_t u, uint32_t v) {
+        double length = std::sqrt((x[u] - x[v]) * (x[u] - x[v]) + (y[u] - y[v]) * (y[u] - y[v]));
+        graph->addEdge(u, v, std::max(0.001, roundTo(length * detour(rng), 1e3)));
+    };
+
+    if (options.layout == SampleMapLayout::Grid) {
+        // Streets to the east and north, 3% of blocks missing, 5% diagonals
+        for (uint32_t i = 0; i < n; i++) {
+            bool east = i % side + 1 < side && i + 1 < n;
+            bool north = i + side < n;
+            if (east && unit(rng) >= 0.03) addRoad(i, i + 1);
+            if (north && unit(rng) >= 0.03) addRoad(i, i + side);
+            if (east && i + side + 1 < n && unit(rng) < 0.05) addRoad(i, i + side + 1);
+        }
+    } else {
+        // Join points closer than the radius that gives GEOMETRIC_DEGREE
+        // neighbours on average, found through a bucket grid of that size
+        double radius = std::sqrt(GEOMETRIC_DEGREE * width * width / (n * SAMPLE_PI));
+        uint32_t cells = std::max<uint32_t>(1, static_cast<uint32_t>(width / radius));
+        auto cellOf = [&](double coordinate) {
+            return std::min(cells - 1, static_cast<uint32_t>(coordinate / width * cells));
+        };
+        std::vector<std::vector<uint32_t> > buckets(size_t(cells) * cells);
+        for (uint32_t i = 0; i < n; i++) {
+            buckets[size_t(cellOf(y[i])) * cells + cellOf(x[i])].push_back(i);
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            uint32_t row = cellOf(y[i]);
+            uint32_t col = cellOf(x[i]);
+            for (uint32_t r = row > 0 ? row - 1 : 0; r <= std::min(row + 1, cells - 1); r++) {
+                for (uint32_t c = col > 0 ? col - 1 : 0; c <= std::min(col + 1, cells - 1); c++) {
+                    for (uint32_t j : buckets[size_t(r) * cells + c]) {
+                        double dx = x[i] - x[j];
+                        double dy = y[i] - y[j];
+                        if (j > i && dx * dx + dy * dy <= radius * radius) addRoad(i, j);
+                    }
+                }
+            }
+        }
+    }
+    return graph;
+}
+
+void SampleGraphGenerator::writeCSV(SamplePositiveGraph* graph, const std::string& verticesFile,
+                                    const std::string& distancesFile) {
+    char line[256];
+    std::ofstream vertices(verticesFile.c_str(), std::ios::binary | std::ios::trunc);
+    if (!vertices) {
+        throw std::runtime_error("Cannot write " + verticesFile);
+    }
+    vertices << "name,latitude,longitude,mapRow,mapCol,type\n";
+    for (SampleVertex* vertex : graph->getVertexList()) {
+        int length = std::snprintf(line, sizeof(line), ",%.6f,%.6f,%d,%d,%s\n", vertex->getLatitude(),
+                                   vertex->getLongitude(), vertex->getMapRow(), vertex->getMapCol(),
+                                   sampleVertexTypeName(vertex->getVertexType()));
+        vertices << vertex->getName();
+        vertices.write(line, length);
+    }
+    if (!vertices.flush()) {
+        throw std::runtime_error("Cannot write " + verticesFile);
+    }
+
+    std::ofstream distances(distancesFile.c_str(), std::ios::binary | std::ios::trunc);
+    if (!distances) {
+        throw std::runtime_error("Cannot write " + distancesFile);
+    }
+    distances << "from,to,distance\n";
+    const SampleCSRGraph* csr = graph->freeze();
+    for (uint32_t u = 0; u < csr->getVertexCount(); u++) {
+        for (uint32_t arc = csr->getArcBegin(u); arc < csr->getArcEnd(u); arc++) {
+            uint32_t v = csr->getArcTarget(arc);
+            if (v < u) continue; // each road once; the loader adds both directions
+            int length = std::snprintf(line, sizeof(line), ",%.3f\n", csr->getArcWeight(arc));
+            distances << csr->getVertex(u)->getName() << ',' << csr->getVertex(v)->getName();
+            distances.write(line, length);
+        }
+    }
+    if (!distances.flush()) {
+        throw std::runtime_error("Cannot write " + distancesFile);
+    }
+}
+
+bool SampleGraphGenerator::parseLayout(const std::string& text, SampleMapLayout& layout) {
+    if (text == "grid") {
+        layout = SampleMapLayout::Grid;
+    } else if (text == "geometric") {
+        layout = SampleMapLayout::Geometric;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* SampleGraphGenerator::layoutName(SampleMapLayout layout) {
+    return layout == SampleMapLayout::Geometric ? "geometric" : "grid";
+}
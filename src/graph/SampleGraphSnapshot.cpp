@@ -0,0 +1,394 @@
+// SampleGraphSnapshot.cpp
+#include "graph/SampleGraphSnapshot.h"
+#include "algorithm/SampleDistanceMatrix.h"
+#include "util/SampleChecksum.h"
+#include <stdexcept>
+#include <sstream>
+#include <fstream>
+#include <vector>
+#include <map>
+#include <limits>
+#include <cstring>
+#include <cstdio>
+#include <sys/stat.h>
+
+static const char MAGIC[8] = { 'S', 'M', 'P', 'L', 'S', 'N', 'A', 'P' };
+static const uint32_t ENDIAN_MARKER = 0x01020304u;
+
+// Fingerprint of a CSV file the snapshot was built from
+struct SourceStamp {
+    uint64_t size;
+    int64_t modified;
+    uint64_t checksum;
+};
+
+// Every field is 8 bytes wide or paired, so the layout has no padding
+struct SampleGraphSnapshot::Header {
+    char magic[8];
+    uint32_t formatVersion;
+    uint32_t endianMarker;
+    uint64_t fileSize;
+    uint64_t payloadChecksum; // over all bytes after the header
+    uint64_t vertexCount;
+    uint64_t arcCount;
+    uint64_t pickupCount;     // 0 when there is no matrix
+    uint64_t dropoffCount;
+    uint64_t nameSlotCount;   // power of two
+    uint64_t vertexOffset;
+    uint64_t stringOffset;
+    uint64_t stringSize;
+    uint64_t nameSlotOffset;
+    uint64_t csrOffsetsOffset;
+    uint64_t targetsOffset;
+    uint64_t weightsOffset;
+    uint64_t matrixIndexOffset;
+    uint64_t pickupsOffset;
+    uint64_t dropoffsOffset;
+    uint64_t matrixOffset;
+    SourceStamp sources[2];   // vertices file, distances file
+};
+
+struct SampleGraphSnapshot::VertexRecord {
+    double latitude;
+    double longitude;
+    int32_t mapRow;
+    int32_t mapCol;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t typeOffset;
+    uint32_t typeLength;
+};
+
+const uint32_t SampleGraphSnapshot::FORMAT_VERSION;
+const uint32_t SampleGraphSnapshot::NO_VERTEX;
+
+static bool statFile(const std::string& path, uint64_t& size, int64_t& modified) {
+    struct stat info;
+    if (::stat(path.c_str(), &info) != 0) return false;
+    size = static_cast<uint64_t>(info.st_size);
+    modified = static_cast<int64_t>(info.st_mtime);
+    return true;
+}
+
+static SourceStamp stampFile(const std::string& path) {
+    SourceStamp stamp;
+    if (!statFile(path, stamp.size, stamp.modified)) {
+        throw std::runtime_error("Unable to stat " + path);
+    }
+    SampleMappedFile source(path);
+    stamp.checksum = sampleChecksum(source.begin(), source.getSize());
+    return stamp;
+}
+
+SampleGraphSnapshot::SampleGraphSnapshot(const std::string& path, bool verifyChecksum) : file(path) {
+    this->graph = nullptr;
+    const char* base = file.begin();
+    size_t size = file.getSize();
+    if (size < sizeof(Header) || std::memcmp(base, MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error(path + ": not a graph snapshot");
+    }
+    header = reinterpret_cast<const Header*>(base);
+    if (header->endianMarker != ENDIAN_MARKER) {
+        throw std::runtime_error(path + ": snapshot was written on a machine with another byte order");
+    }
+    if (header->formatVersion != FORMAT_VERSION) {
+        std::ostringstream message;
+        message << path << ": snapshot format version " << header->formatVersion
+                << ", expected " << FORMAT_VERSION;
+        throw std::runtime_error(message.str());
+    }
+    if (header->fileSize != size) {
+        throw std::runtime_error(path + ": snapshot is truncated");
+    }
+    if (header->vertexCount >= NO_VERTEX || header->arcCount > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error(path + ": snapshot is too large");
+    }
+
+    // Every section has to lie inside the file at 8-byte alignment
+    uint64_t n = header->vertexCount;
+    uint64_t m = header->arcCount;
+    struct Section { uint64_t offset; uint64_t bytes; };
+    Section sections[] = {
+        { header->vertexOffset, n * sizeof(VertexRecord) },
+        { header->stringOffset, header->stringSize },
+        { header->nameSlotOffset, header->nameSlotCount * sizeof(uint32_t) },
+        { header->csrOffsetsOffset, (n + 1) * sizeof(uint32_t) },
+        { header->targetsOffset, m * sizeof(uint32_t) },
+        { header->weightsOffset, m * sizeof(double) },
+        { header->matrixIndexOffset, n * sizeof(uint32_t) },
+        { header->pickupsOffset, header->pickupCount * sizeof(uint32_t) },
+        { header->dropoffsOffset, header->dropoffCount * sizeof(uint32_t) },
+        { header->matrixOffset, header->pickupCount * header->dropoffCount * sizeof(double) },
+    };
+    for (const Section& section : sections) {
+        if (section.offset % 8 != 0 || section.offset > size || section.bytes > size - section.offset) {
+            throw std::runtime_error(path + ": snapshot section out of bounds");
+        }
+    }
+    if (header->nameSlotCount == 0 || (header->nameSlotCount & (header->nameSlotCount - 1)) != 0) {
+        throw std::runtime_error(path + ": snapshot name table is malformed");
+    }
+
+    if (verifyChecksum &&
+        sampleChecksum(base + sizeof(Header), size - sizeof(Header)) != header->payloadChecksum) {
+        throw std::runtime_error(path + ": snapshot checksum mismatch");
+    }
+
+    vertexRecords = reinterpret_cast<const VertexRecord*>(base + header->vertexOffset);
+    strings = base + header->stringOffset;
+    nameSlots = reinterpret_cast<const uint32_t*>(base + header->nameSlotOffset);
+    matrixIndex = reinterpret_cast<const uint32_t*>(base + header->matrixIndexOffset);
+    pickups = reinterpret_cast<const uint32_t*>(base + header->pickupsOffset);
+    dropoffs = reinterpret_cast<const uint32_t*>(base + header->dropoffsOffset);
+    matrix = reinterpret_cast<const double*>(base + header->matrixOffset);
+    graph = new SampleCSRGraph(static_cast<uint32_t>(n), static_cast<uint32_t>(m),
+                               reinterpret_cast<const uint32_t*>(base + header->csrOffsetsOffset),
+                               reinterpret_cast<const uint32_t*>(base + header->targetsOffset),
+                               reinterpret_cast<const double*>(base + header->weightsOffset), true);
+}
+
+SampleGraphSnapshot::~SampleGraphSnapshot() {
+    delete graph;
+}
+
+uint32_t SampleGraphSnapshot::getVertexCount() const {
+    return static_cast<uint32_t>(header->vertexCount);
+}
+
+std::string SampleGraphSnapshot::getName(uint32_t id) const {
+    return std::string(strings + vertexRecords[id].nameOffset, vertexRecords[id].nameLength);
+}
+
+std::string SampleGraphSnapshot::getType(uint32_t id) const {
+    return std::string(strings + vertexRecords[id].typeOffset, vertexRecords[id].typeLength);
+}
+
+SampleVertexType SampleGraphSnapshot::getVertexType(uint32_t id) const {
+    const char* type = strings + vertexRecords[id].typeOffset;
+    return sampleParseVertexType(type, type + vertexRecords[id].typeLength);
+}
+
+double SampleGraphSnapshot::getLatitude(uint32_t id) const { return vertexRecords[id].latitude; }
+double SampleGraphSnapshot::getLongitude(uint32_t id) const { return vertexRecords[id].longitude; }
+int SampleGraphSnapshot::getMapRow(uint32_t id) const { return vertexRecords[id].mapRow; }
+int SampleGraphSnapshot::getMapCol(uint32_t id) const { return vertexRecords[id].mapCol; }
+
+uint32_t SampleGraphSnapshot::findVertex(const std::string& name) const {
+    const char* begin = name.data();
+    const char* end = begin + name.size();
+    uint64_t mask = header->nameSlotCount - 1;
+    for (uint64_t slot = sampleNameHash(begin, end) & mask; ; slot = (slot + 1) & mask) {
+        uint32_t id = nameSlots[slot];
+        if (id == NO_VERTEX) return NO_VERTEX;
+        const VertexRecord& record = vertexRecords[id];
+        if (record.nameLength == name.size() && std::memcmp(strings + record.nameOffset, begin, name.size()) == 0) {
+            return id;
+        }
+    }
+}
+
+bool SampleGraphSnapshot::hasMatrix() const {
+    return header->pickupCount > 0 && header->dropoffCount > 0;
+}
+
+uint32_t SampleGraphSnapshot::getPickupCount() const {
+    return static_cast<uint32_t>(header->pickupCount);
+}
+
+uint32_t SampleGraphSnapshot::getDropoffCount() const {
+    return static_cast<uint32_t>(header->dropoffCount);
+}
+
+double SampleGraphSnapshot::getMatrixDistance(uint32_t pickupId, uint32_t dropoffId) const {
+    if (!hasMatrix() || pickupId >= header->vertexCount || dropoffId >= header->vertexCount) {
+        return std::numeric_limits<double>::max();
+    }
+    uint32_t row = matrixIndex[pickupId];
+    uint32_t column = matrixIndex[dropoffId];
+    if (row >= header->pickupCount || pickups[row] != pickupId ||
+        column >= header->dropoffCount || dropoffs[column] != dropoffId) {
+        return std::numeric_limits<double>::max();
+    }
+    return matrix[static_cast<size_t>(row) * header->dropoffCount + column];
+}
+
+bool SampleGraphSnapshot::isStale(const std::string& verticesFile, const std::string& distancesFile) const {
+    const std::string* paths[2] = { &verticesFile, &distancesFile };
+    for (int i = 0; i < 2; i++) {
+        const SourceStamp& stamp = header->sources[i];
+        uint64_t size;
+        int64_t modified;
+        if (!statFile(*paths[i], size, modified)) continue;
+        if (size != stamp.size) return true;
+        if (modified == stamp.modified) continue;
+        SampleMappedFile source(*paths[i]);
+        if (sampleChecksum(source.begin(), source.getSize()) != stamp.checksum) return true;
+    }
+    return false;
+}
+
+SamplePositiveGraph* SampleGraphSnapshot::toPositiveGraph() const {
+    uint32_t n = getVertexCount();
+    SamplePositiveGraph* positiveGraph = new SamplePositiveGraph();
+    positiveGraph->reserve(n, graph->getArcCount() / 2);
+    for (uint32_t id = 0; id < n; id++) {
+        SampleVertex* vertex = positiveGraph->createVertex(getName(id));
+        vertex->setLatitude(getLatitude(id));
+        vertex->setLongitude(getLongitude(id));
+        vertex->setMapRow(getMapRow(id));
+        vertex->setMapCol(getMapCol(id));
+        vertex->setVertexType(getVertexType(id));
+        vertex->reserveNeighbors(graph->getArcEnd(id) - graph->getArcBegin(id));
+    }
+
+    // Each undirected edge is stored as one arc per endpoint; a self-loop
+    // as two arcs at the same vertex
+    const std::vector<SampleVertex*>& vertices = positiveGraph->getVertexList();
+    for (uint32_t u = 0; u < n; u++) {
+        bool skipLoop = false;
+        for (uint32_t arc = graph->getArcBegin(u); arc < graph->getArcEnd(u); arc++) {
+            uint32_t v = graph->getArcTarget(arc);
+            if (v == u) {
+                skipLoop = !skipLoop;
+                if (!skipLoop) continue;
+            } else if (v < u) {
+                continue;
+            }
+            positiveGraph->addEdge(vertices[u], vertices[v], graph->getArcWeight(arc));
+        }
+    }
+    return positiveGraph;
+}
+
+// Appends a section at the next 8-byte boundary and returns its offset
+static uint64_t appendSection(std::vector<char>& out, const void* data, size_t bytes) {
+    while (out.size() % 8 != 0) out.push_back(0);
+    uint64_t offset = out.size();
+    if (bytes > 0) {
+        const char* begin = static_cast<const char*>(data);
+        out.insert(out.end(), begin, begin + bytes);
+    }
+    return offset;
+}
+
+void SampleGraphSnapshot::write(const std::string& path, SamplePositiveGraph* positiveGraph,
+                                const std::string& verticesFile, const std::string& distancesFile,
+                                bool withMatrix, SampleThreadPool* pool) {
+    const SampleCSRGraph* csr = positiveGraph->freeze();
+    uint32_t n = csr->getVertexCount();
+    uint32_t m = csr->getArcCount();
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.formatVersion = FORMAT_VERSION;
+    header.endianMarker = ENDIAN_MARKER;
+    header.vertexCount = n;
+    header.arcCount = m;
+    header.sources[0] = stampFile(verticesFile);
+    header.sources[1] = stampFile(distancesFile);
+
+    // Names in id order, types once each
+    std::string stringPool;
+    std::map<std::string, uint32_t> typeOffsets;
+    std::vector<VertexRecord> records(n);
+    for (uint32_t id = 0; id < n; id++) {
+        SampleVertex* vertex = csr->getVertex(id);
+        VertexRecord& record = records[id];
+        std::memset(&record, 0, sizeof(record));
+        record.latitude = vertex->getLatitude();
+        record.longitude = vertex->getLongitude();
+        record.mapRow = vertex->getMapRow();
+        record.mapCol = vertex->getMapCol();
+        const std::string& name = vertex->getName();
+        record.nameOffset = static_cast<uint32_t>(stringPool.size());
+        record.nameLength = static_cast<uint32_t>(name.size());
+        stringPool += name;
+        std::string type = sampleVertexTypeName(vertex->getVertexType());
+        auto found = typeOffsets.find(type);
+        if (found == typeOffsets.end()) {
+            found = typeOffsets.insert(std::make_pair(type, static_cast<uint32_t>(stringPool.size()))).first;
+            stringPool += type;
+        }
+        record.typeOffset = found->second;
+        record.typeLength = static_cast<uint32_t>(type.size());
+    }
+    if (stringPool.size() > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("Too many name bytes for a snapshot");
+    }
+
+    uint64_t slotCount = 16;
+    while (slotCount < 2 * static_cast<uint64_t>(n)) slotCount *= 2;
+    std::vector<uint32_t> slots(slotCount, NO_VERTEX);
+    for (uint32_t id = 0; id < n; id++) {
+        const char* begin = stringPool.data() + records[id].nameOffset;
+        uint64_t slot = sampleNameHash(begin, begin + records[id].nameLength) & (slotCount - 1);
+        while (slots[slot] != NO_VERTEX) slot = (slot + 1) & (slotCount - 1);
+        slots[slot] = id;
+    }
+    header.nameSlotCount = slotCount;
+
+    std::vector<uint32_t> pickupIds, dropoffIds;
+    std::vector<uint32_t> index(n, NO_VERTEX);
+    std::vector<double> distances;
+    if (withMatrix) {
+        for (uint32_t id = 0; id < n; id++) {
+            SampleVertexType type = csr->getVertex(id)->getVertexType();
+            if (type == SampleVertexType::Pickup) {
+                index[id] = static_cast<uint32_t>(pickupIds.size());
+                pickupIds.push_back(id);
+            } else if (type == SampleVertexType::Dropoff) {
+                index[id] = static_cast<uint32_t>(dropoffIds.size());
+                dropoffIds.push_back(id);
+            }
+        }
+        if (!pickupIds.empty() && !dropoffIds.empty()) {
+            SampleDistanceMatrix distanceMatrix(pickupIds, dropoffIds);
+            distanceMatrix.compute(csr, pool);
+            distances.resize(pickupIds.size() * dropoffIds.size());
+            for (size_t row = 0; row < pickupIds.size(); row++) {
+                for (size_t column = 0; column < dropoffIds.size(); column++) {
+                    distances[row * dropoffIds.size() + column] = distanceMatrix.getDistance(row, column);
+                }
+            }
+            header.pickupCount = pickupIds.size();
+            header.dropoffCount = dropoffIds.size();
+        }
+    }
+
+    std::vector<char> out(sizeof(Header), 0);
+    header.vertexOffset = appendSection(out, records.data(), records.size() * sizeof(VertexRecord));
+    header.stringOffset = appendSection(out, stringPool.data(), stringPool.size());
+    header.stringSize = stringPool.size();
+    header.nameSlotOffset = appendSection(out, slots.data(), slots.size() * sizeof(uint32_t));
+    header.csrOffsetsOffset = appendSection(out, csr->getOffsets(), (static_cast<size_t>(n) + 1) * sizeof(uint32_t));
+    header.targetsOffset = appendSection(out, csr->getTargets(), static_cast<size_t>(m) * sizeof(uint32_t));
+    header.weightsOffset = appendSection(out, csr->getWeights(), static_cast<size_t>(m) * sizeof(double));
+    header.matrixIndexOffset = appendSection(out, index.data(), index.size() * sizeof(uint32_t));
+    header.pickupsOffset = appendSection(out, pickupIds.data(), static_cast<size_t>(header.pickupCount) * sizeof(uint32_t));
+    header.dropoffsOffset = appendSection(out, dropoffIds.data(), static_cast<size_t>(header.dropoffCount) * sizeof(uint32_t));
+    header.matrixOffset = appendSection(out, distances.data(), distances.size() * sizeof(double));
+    while (out.size() % 8 != 0) out.push_back(0);
+    header.fileSize = out.size();
+    header.payloadChecksum = sampleChecksum(out.data() + sizeof(Header), out.size() - sizeof(Header));
+    std::memcpy(out.data(), &header, sizeof(Header));
+
+    // Write next to the target and rename, so readers never see half a file
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream stream(temporary.c_str(), std::ios::binary | std::ios::trunc);
+        if (!stream.is_open()) {
+            throw std::runtime_error("Unable to create " + temporary);
+        }
+        stream.write(out.data(), static_cast<std::streamsize>(out.size()));
+        if (!stream) {
+            throw std::runtime_error("Unable to write " + temporary);
+        }
+    }
+#if defined(_WIN32)
+    std::remove(path.c_str()); // rename() does not replace files there
+#endif
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("Unable to rename " + temporary + " to " + path);
+    }
+}
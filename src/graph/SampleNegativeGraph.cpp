@@ -2,39 +2,45 @@
 
 #include "graph/SampleEdge.h"
 #include "graph/SampleNegativeGraph.h"
-SampleNegativeGraph::SampleNegativeGraph() {
+const uint32_t SampleNegativeGraph::NO_VERTEX;
+
+SampleNegativeGraph::SampleNegativeGraph(SamplePositiveGraph* base) {
+    this->base = base;
+    this->version = 0;
+    this->frozen = nullptr;
+    this->frozenVersion = 0;
 }
 
 SampleNegativeGraph::~SampleNegativeGraph() {
-    // Clean up all vertices and edges
-    for (auto& pair : vertices) {
-        SampleVertex* vertex = pair.second;
-        // Clean up all edges for this vertex
-        for (SampleEdge* edge : vertex->getNeighbors()) {
-            delete edge;
-        }
-        delete vertex;
-    }
+    delete frozen;
+    // The edges are plain data in the arena; the vertices belong to the base
 }
 
-void SampleNegativeGraph::addVertex(SampleVertex* vertex) {
-    vertices[vertex->getName()] = vertex;
+void SampleNegativeGraph::addEdge(uint32_t fromId, uint32_t toId, double weight) {
+    if (fromId >= outgoing.size()) {
+        outgoing.resize(base->getVertexList().size());
+    }
+    SampleEdge* edge = arena.create<SampleEdge>(base->getVertex(fromId), base->getVertex(toId), weight);
+    outgoing[fromId].push_back(edge);
+    version++;
 }
 
 void SampleNegativeGraph::addEdge(const std::string& fromName, const std::string& toName, double weight) {
-    SampleVertex* from = getVertexByName(fromName);
-    SampleVertex* to = getVertexByName(toName);
+    uint32_t fromId = base->findVertexId(fromName);
+    uint32_t toId = base->findVertexId(toName);
     
-    if (from != nullptr && to != nullptr) {
-        SampleEdge* edge = new SampleEdge(from, to, weight);
-        from->addNeighbor(edge);
+    if (fromId != NO_VERTEX && toId != NO_VERTEX) {
+        addEdge(fromId, toId, weight);
     }
 }
 
-SampleVertex* SampleNegativeGraph::getVertexByName(const std::string& name) const {
-    auto it = vertices.find(name);
-    if (it != vertices.end()) {
-        return it->second;
+const SampleCSRGraph* SampleNegativeGraph::freeze() {
+    const std::vector<SampleVertex*>& vertexList = base->getVertexList();
+    if (frozen == nullptr || frozenVersion != version || frozen->getVertexCount() != vertexList.size()) {
+        delete frozen;
+        outgoing.resize(vertexList.size());
+        frozen = new SampleCSRGraph(vertexList, outgoing);
+        frozenVersion = version;
     }
-    return nullptr;
+    return frozen;
 }
@@ -2,35 +2,79 @@
 
 #include "graph/SampleEdge.h"
 #include "graph/SamplePositiveGraph.h"
+const uint32_t SamplePositiveGraph::NO_VERTEX;
+
 SamplePositiveGraph::SamplePositiveGraph() {
+    this->version = 0;
+    this->frozen = nullptr;
+    this->frozenVersion = 0;
 }
 
 SamplePositiveGraph::~SamplePositiveGraph() {
-    // Clean up all vertices and edges
-    for (auto& pair : vertices) {
-        SampleVertex* vertex = pair.second;
-        // Clean up all edges for this vertex
-        for (SampleEdge* edge : vertex->getNeighbors()) {
-            delete edge;
+    delete frozen;
+    // Edges are plain data in the arena and need no destructor; vertices
+    // own their name and neighbour list. The arena then frees every chunk.
+    for (size_t id = 0; id < vertexList.size(); id++) {
+        if (inArena[id]) {
+            vertexList[id]->~SampleVertex();
+        } else {
+            delete vertexList[id];
         }
-        delete vertex;
     }
 }
 
 void SamplePositiveGraph::addVertex(SampleVertex* vertex) {
+    insertVertex(vertex, false);
+}
+
+SampleVertex* SamplePositiveGraph::createVertex(const std::string& name) {
+    SampleVertex* vertex = arena.create<SampleVertex>(name);
+    insertVertex(vertex, true);
+    return vertex;
+}
+
+void SamplePositiveGraph::insertVertex(SampleVertex* vertex, bool allocatedInArena) {
+    // A new name gets the next id; replacing a vertex keeps its id
+    vertex->setId(names.intern(vertex->getName()));
+    if (vertex->getId() == vertexList.size()) {
+        vertexList.push_back(nullptr);
+        inArena.push_back(false);
+    }
+    vertexList[vertex->getId()] = vertex;
+    inArena[vertex->getId()] = allocatedInArena;
     vertices[vertex->getName()] = vertex;
+    version++;
+}
+
+void SamplePositiveGraph::reserve(size_t vertexCount, size_t edgeCount) {
+    vertices.reserve(vertexCount);
+    vertexList.reserve(vertexCount);
+    inArena.reserve(vertexCount);
+    names.reserve(vertexCount);
+    arena.reserve(vertexCount * sizeof(SampleVertex) + edgeCount * sizeof(SampleEdge));
 }
 
 void SamplePositiveGraph::addEdge(SampleVertex* from, SampleVertex* to, double weight) {
-    SampleEdge* edge = new SampleEdge(from, to, weight);
+    SampleEdge* edge = arena.create<SampleEdge>(from, to, weight);
     from->addNeighbor(edge);
     to->addNeighbor(edge); // For undirected graph
+    version++;
+}
+
+void SamplePositiveGraph::addEdge(uint32_t fromId, uint32_t toId, double weight) {
+    addEdge(vertexList[fromId], vertexList[toId], weight);
 }
 
 SampleVertex* SamplePositiveGraph::getVertexByName(const std::string& name) const {
-    auto it = vertices.find(name);
-    if (it != vertices.end()) {
-        return it->second;
+    uint32_t id = names.find(name);
+    return id != NO_VERTEX ? vertexList[id] : nullptr;
+}
+
+const SampleCSRGraph* SamplePositiveGraph::freeze() {
+    if (frozen == nullptr || frozenVersion != version) {
+        delete frozen;
+        frozen = new SampleCSRGraph(vertexList, true);
+        frozenVersion = version;
     }
-    return nullptr;
-}
\ No newline at end of file
+    return frozen;
+}
@@ -3,14 +3,19 @@
 
 SampleVertex::SampleVertex(const std::string& name) {
     this->name = name;
+    this->id = 0;
+    this->latitude = 0.0;
+    this->longitude = 0.0;
+    this->mapRow = 0;
+    this->mapCol = 0;
     this->distance = std::numeric_limits<double>::max();
     this->status = 0;
     this->parent = nullptr;
-    this->type = "normal";
+    this->type = SampleVertexType::Normal;
 }
 
 SampleVertex::~SampleVertex() {
-    // The edges will be deleted by the graph
+    // The edges live in the graph's arena
 }
 
 void SampleVertex::addNeighbor(SampleEdge* edge) {
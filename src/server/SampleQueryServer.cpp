@@ -0,0 +1,658 @@
+// SampleQueryServer.cpp
+#include "server/SampleQueryServer.h"
+#include "graph/SamplePositiveGraph.h"
+#include "graph/SampleNegativeGraph.h"
+#include "graph/SampleCSRGraph.h"
+#include "graph/SampleCSVLoader.h"
+#include "graph/SampleGraphSnapshot.h"
+#include "graph/SampleVertex.h"
+#include "algorithm/SampleAStar.h"
+#include "algorithm/SampleContractionHierarchy.h"
+#include "algorithm/SampleBellmanFord.h"
+#include "algorithm/SampleDistanceMatrix.h"
+#include "algorithm/SampleDeliveryPlanner.h"
+#include <sstream>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <cmath>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+static const int POLL_MILLIS = 200;                  // how often blocked loops look for shutdown
+static const size_t MAX_LINE_BYTES = 64 << 20;      // longest request line accepted
+static const double TRAVEL_COST_PER_UNIT = 0.1;     // as main() charges
+static const uint32_t MAX_CYCLE_ARCS = 8;           // per truck cycle, as main() ranks them
+static const uint32_t HIERARCHY_MAX_VERTICES = 20000; // larger maps search with A* instead
+
+static volatile std::sig_atomic_t signalled = 0;
+
+static void onSignal(int) {
+    signalled = 1;
+}
+
+// Everything a request reads, built once per load and never changed after.
+// The vertex objects are the exception: a snapshot model builds them once,
+// for the first request that walks them.
+struct SampleQueryServer::Model {
+    std::unique_ptr<SampleGraphSnapshot> snapshot; // null when read from the CSV files
+    const SampleCSRGraph* roadGraph; // the snapshot's mapped arrays, or roads frozen
+    std::unique_ptr<SampleAStar> aStar; // point-to-point searches on roadGraph
+    std::unique_ptr<SampleContractionHierarchy> hierarchy; // the same, faster; null on large maps
+    uint32_t garage; // NO_VERTEX if the map has none
+    uint32_t pickups;
+    uint32_t dropoffs;
+    unsigned long version;
+    std::vector<FileStamp> stamps; // of the map files, taken before reading them
+
+    mutable std::once_flag objectsBuilt;
+    mutable std::unique_ptr<SamplePositiveGraph> roads;
+    mutable std::unique_ptr<SampleNegativeGraph> profits; // overlay on roads, so declared after it
+    mutable const SampleCSRGraph* profitGraph;
+
+    // Builds roads (from the snapshot) and profits unless done already;
+    // requests block until the first caller has finished
+    void buildObjects(SampleThreadPool* buildPool) const {
+        std::call_once(objectsBuilt, [&]() {
+            if (!roads) {
+                roads.reset(snapshot->toPositiveGraph());
+            }
+            profits.reset(SampleDeliveryPlanner::createNegativeGraph(roads.get(), snapshot.get(), buildPool));
+            profitGraph = profits->freeze();
+        });
+    }
+
+    uint32_t findVertex(const std::string& name) const {
+        return snapshot ? snapshot->findVertex(name) : roads->findVertexId(name);
+    }
+    std::string getName(uint32_t id) const {
+        return snapshot ? snapshot->getName(id) : roads->getVertex(id)->getName();
+    }
+    SampleVertexType getVertexType(uint32_t id) const {
+        return snapshot ? snapshot->getVertexType(id) : roads->getVertex(id)->getVertexType();
+    }
+
+    // Shortest road distance, max() if unreachable; fills path when given
+    double findShortestPath(uint32_t from, uint32_t to, Workspace& workspace, std::vector<uint32_t>* path) const {
+        if (hierarchy) {
+            return hierarchy->findShortestPath(from, to, workspace.context, workspace.backward, path);
+        }
+        double distance = aStar->findShortestPath(from, to, workspace.context);
+        if (path != nullptr) {
+            *path = distance != std::numeric_limits<double>::max() ? workspace.context.getPath(to)
+                                                                   : std::vector<uint32_t>();
+        }
+        return distance;
+    }
+};
+
+// One client: a socket, or the stdin/stdout pair. Shared by its reader and
+// its pending requests, so it lives until the last answer is written.
+struct SampleQueryServer::Connection {
+    int inputFd;
+    int outputFd;
+    bool ownsFd;
+    std::mutex writeLock;
+    bool broken; // guarded by writeLock
+
+    Connection(int inputFd, int outputFd, bool ownsFd)
+        : inputFd(inputFd), outputFd(outputFd), ownsFd(ownsFd), broken(false) {}
+    ~Connection() {
+        if (ownsFd) ::close(inputFd);
+    }
+};
+
+SampleQueryServer::SampleQueryServer(const std::string& verticesFile, const std::string& distancesFile,
+                                     SampleThreadPool& pool, double watchSeconds)
+    : verticesFile(verticesFile), distancesFile(distancesFile), pool(pool), nextVersion(1),
+      openReaders(0), stopping(false), served(0), watchSeconds(watchSeconds), reloading(false) {
+    start();
+}
+
+SampleQueryServer::SampleQueryServer(const std::string& snapshotFile, const std::string& verticesFile,
+                                     const std::string& distancesFile, SampleThreadPool& pool, double watchSeconds)
+    : snapshotFile(snapshotFile), verticesFile(verticesFile), distancesFile(distancesFile), pool(pool),
+      nextVersion(1), openReaders(0), stopping(false), served(0), watchSeconds(watchSeconds), reloading(false) {
+    start();
+}
+
+void SampleQueryServer::start() {
+    for (unsigned i = 0; i < pool.getThreadCount(); i++) {
+        workspaces.push_back(std::unique_ptr<Workspace>(new Workspace()));
+    }
+    // Nothing runs on the pool yet, so the first build may use it
+    std::lock_guard<std::mutex> lock(reloadLock);
+    std::atomic_store(&model, buildModel(&pool));
+    nextWatch = std::chrono::steady_clock::now();
+}
+
+SampleQueryServer::~SampleQueryServer() {
+    stop();
+    std::unique_lock<std::mutex> lock(queueLock);
+    queueReady.wait(lock, [&] { return openReaders == 0; });
+    lock.unlock();
+    if (reloadThread.joinable()) {
+        reloadThread.join();
+    }
+}
+
+std::vector<SampleQueryServer::FileStamp> SampleQueryServer::stampFiles() const {
+    const std::string* paths[3] = { &verticesFile, &distancesFile, &snapshotFile };
+    std::vector<FileStamp> stamps;
+    for (int i = 0; i < (snapshotFile.empty() ? 2 : 3); i++) {
+        struct stat info;
+        FileStamp stamp = { -1, -1 }; // missing
+        if (::stat(paths[i]->c_str(), &info) == 0) {
+            stamp.size = static_cast<int64_t>(info.st_size);
+            stamp.modified = static_cast<int64_t>(info.st_mtime);
+        }
+        stamps.push_back(stamp);
+    }
+    return stamps;
+}
+
+std::shared_ptr<const SampleQueryServer::Model> SampleQueryServer::buildModel(SampleThreadPool* buildPool) {
+    std::shared_ptr<Model> next(new Model());
+    next->stamps = stampFiles();
+    if (!snapshotFile.empty()) {
+        try {
+            next->snapshot.reset(new SampleGraphSnapshot(snapshotFile));
+            if (next->snapshot->isStale(verticesFile, distancesFile)) {
+                std::cerr << "Snapshot " << snapshotFile << " is stale (CSV files changed), reading the CSV files instead"
+                          << std::endl;
+                next->snapshot.reset();
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Cannot use snapshot: " << e.what() << std::endl;
+        }
+    }
+    if (next->snapshot) {
+        next->roadGraph = next->snapshot->getGraph(); // The objects wait for the first plan request
+        std::vector<double> latitudes(next->roadGraph->getVertexCount());
+        std::vector<double> longitudes(latitudes.size());
+        for (uint32_t id = 0; id < latitudes.size(); id++) {
+            latitudes[id] = next->snapshot->getLatitude(id);
+            longitudes[id] = next->snapshot->getLongitude(id);
+        }
+        next->aStar.reset(new SampleAStar(next->roadGraph, latitudes, longitudes, 0));
+    } else {
+        next->roads.reset(SampleCSVLoader::loadPositiveGraph(verticesFile, distancesFile));
+        next->roadGraph = next->roads->freeze();
+        next->aStar.reset(new SampleAStar(next->roadGraph, 0));
+        next->buildObjects(buildPool);
+    }
+    if (next->roadGraph->getVertexCount() <= HIERARCHY_MAX_VERTICES && next->roadGraph->isUndirected()) {
+        next->hierarchy.reset(new SampleContractionHierarchy(next->roadGraph));
+    }
+
+    next->garage = next->findVertex("Garage");
+    next->pickups = 0;
+    next->dropoffs = 0;
+    for (uint32_t id = 0; id < next->roadGraph->getVertexCount(); id++) {
+        SampleVertexType type = next->getVertexType(id);
+        if (type == SampleVertexType::Garage && next->garage == SamplePositiveGraph::NO_VERTEX) {
+            next->garage = id;
+        }
+        next->pickups += type == SampleVertexType::Pickup;
+        next->dropoffs += type == SampleVertexType::Dropoff;
+    }
+    next->version = nextVersion++;
+    return next;
+}
+
+unsigned long SampleQueryServer::reload() {
+    std::lock_guard<std::mutex> lock(reloadLock);
+    // Requests keep the pool busy, so the new model is built on this thread
+    std::shared_ptr<const Model> next = buildModel(nullptr);
+    std::atomic_store(&model, next);
+    return next->version;
+}
+
+void SampleQueryServer::watchFiles() {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (watchSeconds <= 0 || now < nextWatch || reloading.load()) return;
+    nextWatch = now + std::chrono::microseconds(static_cast<int64_t>(watchSeconds * 1e6));
+
+    std::vector<FileStamp> current = stampFiles();
+    if (current == std::atomic_load(&model)->stamps || current == failedStamps) {
+        pendingStamps.clear();
+        return;
+    }
+    if (current != pendingStamps) {
+        pendingStamps = current; // Changed; reload once it stops changing
+        return;
+    }
+    pendingStamps.clear();
+    if (reloadThread.joinable()) {
+        reloadThread.join();
+    }
+    reloading = true;
+    reloadThread = std::thread([this, current]() {
+        try {
+            unsigned long version = reload();
+            std::cerr << "Map files changed, loaded version " << version << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "Map files changed but cannot be loaded, keeping the current map: " << e.what() << std::endl;
+            failedStamps = current; // read by the dispatcher once reloading is false again
+        }
+        reloading = false;
+    });
+}
+
+void SampleQueryServer::stop() {
+    std::lock_guard<std::mutex> lock(queueLock);
+    stopping = true;
+    queueReady.notify_all();
+}
+
+void SampleQueryServer::startReader(const std::shared_ptr<Connection>& connection) {
+    {
+        std::lock_guard<std::mutex> lock(queueLock);
+        openReaders++;
+    }
+    std::thread(&SampleQueryServer::readLoop, this, connection).detach();
+}
+
+void SampleQueryServer::readLoop(std::shared_ptr<Connection> connection) {
+    std::string buffer;
+    std::vector<Pending> lines;
+    char chunk[1 << 16];
+    bool atEnd = false;
+    while (!atEnd) {
+        {
+            std::lock_guard<std::mutex> lock(queueLock);
+            if (stopping) break;
+        }
+        struct pollfd ready = { connection->inputFd, POLLIN, 0 };
+        int status = ::poll(&ready, 1, POLL_MILLIS);
+        if (status == 0 || (status < 0 && errno == EINTR)) continue;
+        ssize_t got = status < 0 ? -1 : ::read(connection->inputFd, chunk, sizeof(chunk));
+        if (got < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+        if (got <= 0) {
+            atEnd = true; // The last line may lack its newline
+            buffer += '\n';
+        } else {
+            buffer.append(chunk, static_cast<size_t>(got));
+        }
+
+        size_t start = 0;
+        size_t newline;
+        while ((newline = buffer.find('\n', start)) != std::string::npos) {
+            size_t end = newline;
+            if (end > start && buffer[end - 1] == '\r') end--;
+            if (buffer.find_first_not_of(" \t", start) < end) {
+                Pending pending = { connection, buffer.substr(start, end - start) };
+                lines.push_back(pending);
+            }
+            start = newline + 1;
+        }
+        buffer.erase(0, start);
+        if (buffer.size() > MAX_LINE_BYTES) {
+            reply(*connection, "{\"id\":null,\"ok\":false,\"error\":\"request line too long\"}");
+            atEnd = true;
+        }
+        if (!lines.empty()) {
+            std::lock_guard<std::mutex> lock(queueLock);
+            queue.insert(queue.end(), lines.begin(), lines.end());
+            queueReady.notify_all();
+            lines.clear();
+        }
+    }
+    std::lock_guard<std::mutex> lock(queueLock);
+    openReaders--;
+    queueReady.notify_all();
+}
+
+void SampleQueryServer::reply(Connection& connection, const std::string& line) {
+    std::string data = line + '\n';
+    std::lock_guard<std::mutex> lock(connection.writeLock);
+    size_t done = 0;
+    while (!connection.broken && done < data.size()) {
+        ssize_t wrote = ::write(connection.outputFd, data.data() + done, data.size() - done);
+        if (wrote < 0 && errno == EINTR) continue;
+        if (wrote <= 0) {
+            connection.broken = true; // Client went away; drop its remaining answers
+        } else {
+            done += static_cast<size_t>(wrote);
+        }
+    }
+}
+
+void SampleQueryServer::dispatchLoop(bool untilInputEnds) {
+    while (true) {
+        std::vector<Pending> batch;
+        {
+            std::unique_lock<std::mutex> lock(queueLock);
+            queueReady.wait_for(lock, std::chrono::milliseconds(POLL_MILLIS), [&] {
+                return !queue.empty() || stopping || signalled || (untilInputEnds && openReaders == 0);
+            });
+            if (signalled) stopping = true;
+            if (queue.empty() && (stopping || (untilInputEnds && openReaders == 0))) break;
+            batch.swap(queue);
+        }
+        watchFiles();
+
+        // Each request is a task of its own, so a slow one only holds up
+        // its worker while this loop goes back to the queue
+        for (const Pending& pending : batch) {
+            pool.post([this, pending](unsigned worker) {
+                reply(*pending.connection, handle(pending.line, *workspaces[worker]));
+            });
+        }
+    }
+    // Answer the requests already taken before returning
+    pool.wait();
+}
+
+void SampleQueryServer::serveStream(int inputFd, int outputFd) {
+    std::signal(SIGPIPE, SIG_IGN);
+    {
+        std::lock_guard<std::mutex> lock(queueLock);
+        stopping = false;
+    }
+    startReader(std::shared_ptr<Connection>(new Connection(inputFd, outputFd, false)));
+    dispatchLoop(true);
+    stop();
+    std::unique_lock<std::mutex> lock(queueLock);
+    queueReady.wait(lock, [&] { return openReaders == 0; });
+}
+
+void SampleQueryServer::serveSocket(const std::string& path) {
+    struct sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Bad socket path " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size());
+
+    // A socket left behind by an earlier run is replaced; any other file is not
+    struct stat info;
+    if (::stat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+        ::unlink(path.c_str());
+    }
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        throw std::runtime_error("Cannot create socket: " + std::string(std::strerror(errno)));
+    }
+    if (::bind(listener, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listener, SOMAXCONN) != 0) {
+        std::string reason = std::strerror(errno);
+        ::close(listener);
+        throw std::runtime_error("Cannot listen on " + path + ": " + reason);
+    }
+
+    std::signal(SIGPIPE, SIG_IGN);
+    signalled = 0;
+    void (*previousInterrupt)(int) = std::signal(SIGINT, onSignal);
+    void (*previousTerminate)(int) = std::signal(SIGTERM, onSignal);
+    {
+        std::lock_guard<std::mutex> lock(queueLock);
+        stopping = false;
+    }
+
+    std::thread acceptor([&]() {
+        while (true) {
+            {
+                std::lock_guard<std::mutex> lock(queueLock);
+                if (stopping) return;
+            }
+            struct pollfd ready = { listener, POLLIN, 0 };
+            if (::poll(&ready, 1, POLL_MILLIS) <= 0) continue;
+            int client = ::accept(listener, nullptr, nullptr);
+            if (client >= 0) {
+                startReader(std::shared_ptr<Connection>(new Connection(client, client, true)));
+            }
+        }
+    });
+    dispatchLoop(false);
+    stop();
+    acceptor.join();
+    ::close(listener);
+    ::unlink(path.c_str());
+    {
+        std::unique_lock<std::mutex> lock(queueLock);
+        queueReady.wait(lock, [&] { return openReaders == 0; });
+    }
+    std::signal(SIGINT, previousInterrupt);
+    std::signal(SIGTERM, previousTerminate);
+}
+
+std::string SampleQueryServer::handle(const std::string& line) {
+    Workspace workspace;
+    return handle(line, workspace);
+}
+
+std::string SampleQueryServer::handle(const std::string& line, Workspace& workspace) {
+    served++;
+    std::ostringstream out;
+    const SampleJSONValue* id = nullptr;
+    SampleJSONValue request;
+    try {
+        request = SampleJSONValue::parse(line);
+        id = request.find("id");
+        if (!request.isObject()) {
+            throw std::invalid_argument("a request is a JSON object");
+        }
+        // The model stays alive for this request even if a reload swaps it out
+        std::shared_ptr<const Model> current = std::atomic_load(&model);
+        std::ostringstream body;
+        answer(request, *current, workspace, body);
+        out << "{\"id\":";
+        if (id != nullptr) id->write(out); else out << "null";
+        out << ",\"ok\":true" << body.str() << "}";
+    } catch (const std::exception& e) {
+        out.str("");
+        out << "{\"id\":";
+        if (id != nullptr) id->write(out); else out << "null";
+        out << ",\"ok\":false,\"error\":";
+        SampleJSONValue::writeString(out, e.what());
+        out << "}";
+    }
+    return out.str();
+}
+
+// Vertex id of a place given by name or id. Map is the server's Model,
+// private to it, so these helpers take it as a template parameter.
+template <typename Map>
+static uint32_t placeOf(const Map& map, const SampleJSONValue* place, const char* field) {
+    if (place == nullptr) {
+        throw std::invalid_argument(std::string("missing \"") + field + "\"");
+    }
+    uint32_t n = map.roadGraph->getVertexCount();
+    if (place->isString()) {
+        uint32_t id = map.findVertex(place->getString());
+        if (id == SamplePositiveGraph::NO_VERTEX) {
+            throw std::invalid_argument("unknown place '" + place->getString() + "'");
+        }
+        return id;
+    }
+    if (place->isNumber() && place->getNumber() >= 0 && place->getNumber() < n &&
+        place->getNumber() == std::floor(place->getNumber())) {
+        return static_cast<uint32_t>(place->getNumber());
+    }
+    throw std::invalid_argument(std::string("\"") + field + "\" must be a place name or vertex id");
+}
+
+template <typename Map>
+static std::vector<uint32_t> placesOf(const Map& map, const SampleJSONValue* places, const char* field) {
+    if (places == nullptr || !places->isArray()) {
+        throw std::invalid_argument(std::string("\"") + field + "\" must be an array of places");
+    }
+    std::vector<uint32_t> ids;
+    for (const SampleJSONValue& place : places->getItems()) {
+        ids.push_back(placeOf(map, &place, field));
+    }
+    return ids;
+}
+
+// Distance as JSON, null when unreachable
+static void writeDistance(std::ostream& out, double distance) {
+    if (distance == std::numeric_limits<double>::max()) {
+        out << "null";
+    } else {
+        SampleJSONValue::writeNumber(out, distance);
+    }
+}
+
+template <typename Map>
+static void writeNames(std::ostream& out, const Map& map, const std::vector<uint32_t>& ids) {
+    out << '[';
+    for (size_t i = 0; i < ids.size(); i++) {
+        if (i > 0) out << ',';
+        SampleJSONValue::writeString(out, map.getName(ids[i]));
+    }
+    out << ']';
+}
+
+// Stops of a closed route with its legs driven on the shortest paths, the
+// travel cost and what is left of profit after it
+template <typename Map, typename Workspace>
+static void writeRoute(std::ostream& out, const Map& map, const std::vector<uint32_t>& stops,
+                       const std::vector<uint32_t>& tour, double profit, Workspace& workspace) {
+    double total = 0.0;
+    std::ostringstream legs;
+    for (size_t i = 0; i + 1 < tour.size(); i++) {
+        double leg = map.findShortestPath(tour[i], tour[i + 1], workspace, nullptr);
+        if (leg == std::numeric_limits<double>::max() || total == std::numeric_limits<double>::max()) {
+            total = std::numeric_limits<double>::max();
+        } else {
+            total += leg;
+        }
+        legs << (i > 0 ? "," : "") << "{\"from\":";
+        SampleJSONValue::writeString(legs, map.getName(tour[i]));
+        legs << ",\"to\":";
+        SampleJSONValue::writeString(legs, map.getName(tour[i + 1]));
+        legs << ",\"distance\":";
+        writeDistance(legs, leg);
+        legs << "}";
+    }
+    out << "{\"stops\":";
+    writeNames(out, map, stops);
+    out << ",\"profit\":";
+    SampleJSONValue::writeNumber(out, profit);
+    out << ",\"distance\":";
+    writeDistance(out, total);
+    if (total != std::numeric_limits<double>::max()) {
+        out << ",\"travel_cost\":";
+        SampleJSONValue::writeNumber(out, total * TRAVEL_COST_PER_UNIT);
+        out << ",\"final_profit\":";
+        SampleJSONValue::writeNumber(out, profit - total * TRAVEL_COST_PER_UNIT);
+    }
+    out << ",\"legs\":[" << legs.str() << "]}";
+}
+
+void SampleQueryServer::answer(const SampleJSONValue& request, const Model& current, Workspace& workspace,
+                               std::ostream& out) {
+    const SampleJSONValue* op = request.find("op");
+    if (op == nullptr || !op->isString()) {
+        throw std::invalid_argument("missing \"op\"");
+    }
+    const std::string& name = op->getString();
+
+    if (name == "distance" || name == "path") {
+        uint32_t from = placeOf(current, request.find("from"), "from");
+        uint32_t to = placeOf(current, request.find("to"), "to");
+        std::vector<uint32_t> path;
+        double distance = current.findShortestPath(from, to, workspace, name == "path" ? &path : nullptr);
+        out << ",\"distance\":";
+        writeDistance(out, distance);
+        if (name == "path") {
+            out << ",\"path\":";
+            writeNames(out, current, path);
+        }
+    } else if (name == "matrix") {
+        SampleDistanceMatrix matrix(placesOf(current, request.find("sources"), "sources"),
+                                    placesOf(current, request.find("targets"), "targets"));
+        matrix.compute(current.roadGraph); // The pool is busy with the batch this request is part of
+        out << ",\"distances\":[";
+        for (size_t row = 0; row < matrix.getSources().size(); row++) {
+            out << (row > 0 ? ",[" : "[");
+            for (size_t column = 0; column < matrix.getTargets().size(); column++) {
+                if (column > 0) out << ',';
+                writeDistance(out, matrix.getDistance(row, column));
+            }
+            out << ']';
+        }
+        out << ']';
+    } else if (name == "plan") {
+        if (current.garage == SamplePositiveGraph::NO_VERTEX) {
+            throw std::runtime_error("the map has no garage");
+        }
+        current.buildObjects(nullptr); // The pool is busy with the batch this request is part of
+        SampleBellmanFord search(current.profitGraph);
+        const SampleJSONValue* trucks = request.find("trucks");
+        if (trucks != nullptr) {
+            // The most profitable disjoint cycles through the garage, one per truck
+            if (!trucks->isNumber() || trucks->getNumber() < 1 || trucks->getNumber() > 1000) {
+                throw std::invalid_argument("\"trucks\" must be a number from 1 to 1000");
+            }
+            std::vector<SampleBellmanFord::RankedCycle> cycles = search.findTopCycles(
+                current.profitGraph->getVertex(current.garage), static_cast<size_t>(trucks->getNumber()),
+                MAX_CYCLE_ARCS, true);
+            out << ",\"routes\":[";
+            for (size_t i = 0; i < cycles.size(); i++) {
+                std::vector<uint32_t> stops;
+                for (SampleVertex* vertex : cycles[i].vertices) stops.push_back(vertex->getId());
+                std::vector<uint32_t> tour(stops);
+                tour.push_back(stops[0]);
+                if (i > 0) out << ',';
+                writeRoute(out, current, stops, tour, -cycles[i].weight, workspace);
+            }
+            out << ']';
+        } else {
+            // The profitable cycle main() plans, driven from and back to the garage
+            std::vector<SampleVertex*> cycle = search.findNegativeCycleSPFA();
+            std::vector<uint32_t> stops;
+            double weight = SampleDeliveryPlanner::cycleWeight(current.profitGraph, cycle);
+            for (SampleVertex* vertex : cycle) {
+                stops.push_back(vertex->getId());
+            }
+            const SampleJSONValue* budget = request.find("budget_ms");
+            if (budget != nullptr && !cycle.empty()) {
+                // Visit the same stops in a shorter order found within the budget
+                if (!budget->isNumber() || budget->getNumber() < 0 || budget->getNumber() > 60000) {
+                    throw std::invalid_argument("\"budget_ms\" must be a number from 0 to 60000");
+                }
+                SampleTourOptimizer::Options options;
+                options.budgetSeconds = budget->getNumber() / 1000.0;
+                SampleDeliveryPlanner::ImprovedTour improved = SampleDeliveryPlanner::improveTour(
+                    current.roadGraph, current.roads->getVertex(current.garage), cycle, options);
+                stops = SampleDeliveryPlanner::vertexIds(improved.stops);
+            }
+            std::vector<uint32_t> tour(1, current.garage);
+            tour.insert(tour.end(), stops.begin(), stops.end());
+            tour.push_back(current.garage);
+            out << ",\"route\":";
+            writeRoute(out, current, stops, stops.empty() ? std::vector<uint32_t>() : tour, -weight, workspace);
+        }
+    } else if (name == "reload") {
+        unsigned long version = reload();
+        std::shared_ptr<const Model> next = std::atomic_load(&model);
+        out << ",\"version\":" << version << ",\"vertices\":" << next->roadGraph->getVertexCount();
+    } else if (name == "info") {
+        out << ",\"version\":" << current.version
+            << ",\"vertices\":" << current.roadGraph->getVertexCount()
+            << ",\"arcs\":" << current.roadGraph->getArcCount()
+            << ",\"pickups\":" << current.pickups
+            << ",\"dropoffs\":" << current.dropoffs
+            << ",\"threads\":" << pool.getThreadCount()
+            << ",\"requests\":" << served.load()
+            << ",\"shortcuts\":"; // of the contraction hierarchy, null without one
+        if (current.hierarchy) {
+            out << current.hierarchy->getShortcutCount();
+        } else {
+            out << "null";
+        }
+    } else if (name == "shutdown") {
+        stop();
+    } else {
+        throw std::invalid_argument("unknown op '" + name + "'");
+    }
+}
@@ -0,0 +1,36 @@
+// SampleArena.cpp
+#include "util/SampleArena.h"
+
+const size_t SampleArena::FIRST_CHUNK_SIZE;
+const size_t SampleArena::MAX_CHUNK_SIZE;
+
+SampleArena::SampleArena() {
+    this->cursor = nullptr;
+    this->limit = nullptr;
+    this->nextChunkSize = FIRST_CHUNK_SIZE;
+    this->bytesAllocated = 0;
+}
+
+SampleArena::~SampleArena() {
+    for (char* chunk : chunks) {
+        delete[] chunk;
+    }
+}
+
+void* SampleArena::allocateSlow(size_t size, size_t alignment) {
+    // A fresh chunk; requests larger than a chunk get one of their own.
+    // operator new[] memory is aligned for any fundamental type.
+    size_t chunkSize = nextChunkSize;
+    if (chunkSize < size + alignment) chunkSize = size + alignment;
+    char* chunk = new char[chunkSize];
+    chunks.push_back(chunk);
+    cursor = chunk;
+    limit = chunk + chunkSize;
+    nextChunkSize = chunkSize < MAX_CHUNK_SIZE ? chunkSize * 2 : MAX_CHUNK_SIZE;
+    return allocate(size, alignment);
+}
+
+void SampleArena::reserve(size_t bytes) {
+    if (cursor != nullptr && static_cast<size_t>(limit - cursor) >= bytes) return;
+    if (nextChunkSize < bytes) nextChunkSize = bytes;
+}
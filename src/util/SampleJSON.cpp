@@ -0,0 +1,291 @@
+// SampleJSON.cpp
+#include "util/SampleJSON.h"
+#include <stdexcept>
+#include <sstream>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+
+// Recursive descent over the text; nesting is limited so hostile input
+// cannot run the stack out
+class SampleJSONValue::Parser {
+private:
+    static const int MAX_DEPTH = 64;
+
+    const std::string& text;
+    size_t at;
+
+    std::runtime_error error(const std::string& message) const {
+        std::ostringstream out;
+        out << "JSON offset " << at << ": " << message;
+        return std::runtime_error(out.str());
+    }
+
+    void skipSpace() {
+        while (at < text.size() && (text[at] == ' ' || text[at] == '\t' || text[at] == '\n' || text[at] == '\r')) {
+            at++;
+        }
+    }
+
+    void expect(const char* word) {
+        for (const char* c = word; *c != '\0'; c++, at++) {
+            if (at >= text.size() || text[at] != *c) {
+                throw error(std::string("expected '") + word + "'");
+            }
+        }
+    }
+
+    unsigned parseHex4() {
+        unsigned code = 0;
+        for (int i = 0; i < 4; i++, at++) {
+            if (at >= text.size()) throw error("unterminated \\u escape");
+            char c = text[at];
+            code <<= 4;
+            if (c >= '0' && c <= '9') code |= c - '0';
+            else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+            else throw error("bad \\u escape");
+        }
+        return code;
+    }
+
+    static void appendUTF8(std::string& out, unsigned code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    std::string parseString() {
+        std::string out;
+        at++; // opening quote
+        while (true) {
+            if (at >= text.size()) throw error("unterminated string");
+            char c = text[at++];
+            if (c == '"') return out;
+            if (static_cast<unsigned char>(c) < 0x20) throw error("control character in string");
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (at >= text.size()) throw error("unterminated string");
+            char escaped = text[at++];
+            switch (escaped) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                unsigned code = parseHex4();
+                if (code >= 0xD800 && code < 0xDC00 && at + 1 < text.size() && text[at] == '\\' && text[at + 1] == 'u') {
+                    // Surrogate pair
+                    at += 2;
+                    unsigned low = parseHex4();
+                    if (low < 0xDC00 || low >= 0xE000) throw error("bad surrogate pair");
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendUTF8(out, code);
+                break;
+            }
+            default:
+                throw error("bad escape");
+            }
+        }
+    }
+
+    double parseNumber() {
+        size_t begin = at;
+        if (at < text.size() && text[at] == '-') at++;
+        while (at < text.size() && ((text[at] >= '0' && text[at] <= '9') || text[at] == '.' ||
+                                    text[at] == 'e' || text[at] == 'E' || text[at] == '+' || text[at] == '-')) {
+            at++;
+        }
+        std::string token = text.substr(begin, at - begin);
+        char* end = nullptr;
+        double value = std::strtod(token.c_str(), &end);
+        if (token.empty() || end != token.c_str() + token.size()) {
+            at = begin;
+            throw error("bad number");
+        }
+        return value;
+    }
+
+    void parseValue(SampleJSONValue& value, int depth) {
+        if (depth > MAX_DEPTH) throw error("nested too deeply");
+        skipSpace();
+        if (at >= text.size()) throw error("unexpected end");
+        char c = text[at];
+        if (c == '{') {
+            value.type = SampleJSONType::Object;
+            at++;
+            skipSpace();
+            if (at < text.size() && text[at] == '}') {
+                at++;
+                return;
+            }
+            while (true) {
+                skipSpace();
+                if (at >= text.size() || text[at] != '"') throw error("expected a member name");
+                std::string key = parseString();
+                skipSpace();
+                if (at >= text.size() || text[at] != ':') throw error("expected ':'");
+                at++;
+                value.members.push_back(std::make_pair(key, SampleJSONValue()));
+                parseValue(value.members.back().second, depth + 1);
+                skipSpace();
+                if (at < text.size() && text[at] == ',') {
+                    at++;
+                } else if (at < text.size() && text[at] == '}') {
+                    at++;
+                    return;
+                } else {
+                    throw error("expected ',' or '}'");
+                }
+            }
+        } else if (c == '[') {
+            value.type = SampleJSONType::Array;
+            at++;
+            skipSpace();
+            if (at < text.size() && text[at] == ']') {
+                at++;
+                return;
+            }
+            while (true) {
+                value.items.push_back(SampleJSONValue());
+                parseValue(value.items.back(), depth + 1);
+                skipSpace();
+                if (at < text.size() && text[at] == ',') {
+                    at++;
+                } else if (at < text.size() && text[at] == ']') {
+                    at++;
+                    return;
+                } else {
+                    throw error("expected ',' or ']'");
+                }
+            }
+        } else if (c == '"') {
+            value.type = SampleJSONType::String;
+            value.text = parseString();
+        } else if (c == 't') {
+            expect("true");
+            value.type = SampleJSONType::Bool;
+            value.boolean = true;
+        } else if (c == 'f') {
+            expect("false");
+            value.type = SampleJSONType::Bool;
+            value.boolean = false;
+        } else if (c == 'n') {
+            expect("null");
+        } else {
+            value.type = SampleJSONType::Number;
+            value.number = parseNumber();
+        }
+    }
+
+public:
+    Parser(const std::string& text) : text(text), at(0) {}
+
+    SampleJSONValue parse() {
+        SampleJSONValue value;
+        parseValue(value, 0);
+        skipSpace();
+        if (at != text.size()) throw error("trailing characters");
+        return value;
+    }
+};
+
+SampleJSONValue::SampleJSONValue() : type(SampleJSONType::Null), boolean(false), number(0.0) {}
+
+const SampleJSONValue* SampleJSONValue::find(const std::string& key) const {
+    for (const auto& member : members) {
+        if (member.first == key) return &member.second;
+    }
+    return nullptr;
+}
+
+SampleJSONValue SampleJSONValue::parse(const std::string& text) {
+    return Parser(text).parse();
+}
+
+void SampleJSONValue::write(std::ostream& out) const {
+    switch (type) {
+    case SampleJSONType::Bool:
+        out << (boolean ? "true" : "false");
+        break;
+    case SampleJSONType::Number:
+        writeNumber(out, number);
+        break;
+    case SampleJSONType::String:
+        writeString(out, text);
+        break;
+    case SampleJSONType::Array:
+        out << '[';
+        for (size_t i = 0; i < items.size(); i++) {
+            if (i > 0) out << ',';
+            items[i].write(out);
+        }
+        out << ']';
+        break;
+    case SampleJSONType::Object:
+        out << '{';
+        for (size_t i = 0; i < members.size(); i++) {
+            if (i > 0) out << ',';
+            writeString(out, members[i].first);
+            out << ':';
+            members[i].second.write(out);
+        }
+        out << '}';
+        break;
+    default:
+        out << "null";
+        break;
+    }
+}
+
+void SampleJSONValue::writeString(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (c == '\n') {
+            out << "\\n";
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+            out << escaped;
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+void SampleJSONValue::writeNumber(std::ostream& out, double value) {
+    if (!std::isfinite(value)) {
+        out << "null";
+        return;
+    }
+    // Fewest digits that round-trip: try 15 first, then 17
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.15g", value);
+    if (std::strtod(buffer, nullptr) != value) {
+        std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+    }
+    out << buffer;
+}
@@ -0,0 +1,70 @@
+// SampleMappedFile.cpp
+#include "util/SampleMappedFile.h"
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+SampleMappedFile::SampleMappedFile(const std::string& path) {
+    this->path = path;
+    this->data = "";
+    this->size = 0;
+    this->mapping = nullptr;
+
+#if defined(_WIN32)
+    std::ifstream stream(path.c_str(), std::ios::binary);
+    if (!stream.is_open()) {
+        throw std::runtime_error("Unable to open " + path);
+    }
+    stream.seekg(0, std::ios::end);
+    std::streamoff length = stream.tellg();
+    stream.seekg(0, std::ios::beg);
+    if (length > 0) {
+        buffer.resize(static_cast<size_t>(length));
+        stream.read(&buffer[0], length);
+        data = &buffer[0];
+        size = buffer.size();
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Unable to open " + path + ": " + std::strerror(errno));
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw std::runtime_error("Unable to stat " + path + ": " + std::strerror(error));
+    }
+    if (info.st_size > 0) {
+        void* base = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (base == MAP_FAILED) {
+            int error = errno;
+            ::close(fd);
+            throw std::runtime_error("Unable to map " + path + ": " + std::strerror(error));
+        }
+        // Parsing is one front-to-back scan
+        ::madvise(base, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+        mapping = base;
+        data = static_cast<const char*>(base);
+        size = static_cast<size_t>(info.st_size);
+    }
+    ::close(fd); // The mapping stays valid without the descriptor
+#endif
+}
+
+SampleMappedFile::~SampleMappedFile() {
+#if !defined(_WIN32)
+    if (mapping != nullptr) {
+        ::munmap(mapping, size);
+    }
+#endif
+}
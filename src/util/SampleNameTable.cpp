@@ -0,0 +1,32 @@
+// SampleNameTable.cpp
+#include "util/SampleNameTable.h"
+
+const uint32_t SampleNameTable::NO_NAME;
+
+SampleNameTable::SampleNameTable() : slots(16, NO_NAME), mask(15) {}
+
+void SampleNameTable::rehash(size_t slotCount) {
+    slots.assign(slotCount, NO_NAME);
+    mask = slotCount - 1;
+    for (uint32_t id = 0; id < names.size(); id++) {
+        const std::string& name = names[id];
+        slots[findSlot(name.data(), name.data() + name.size())] = id;
+    }
+}
+
+void SampleNameTable::reserve(size_t count) {
+    names.reserve(count);
+    size_t slotCount = slots.size();
+    while (slotCount < count * 2) slotCount *= 2;
+    if (slotCount != slots.size()) rehash(slotCount);
+}
+
+uint32_t SampleNameTable::intern(const char* begin, const char* end) {
+    size_t slot = findSlot(begin, end);
+    if (slots[slot] != NO_NAME) return slots[slot];
+    uint32_t id = static_cast<uint32_t>(names.size());
+    names.push_back(std::string(begin, end));
+    slots[slot] = id;
+    if (names.size() * 2 > slots.size()) rehash(slots.size() * 2);
+    return id;
+}
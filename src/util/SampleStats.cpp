@@ -0,0 +1,193 @@
+// SampleStats.cpp
+#include "util/SampleStats.h"
+#include "util/SampleJSON.h"
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+const size_t COUNTER_COUNT = static_cast<size_t>(SampleCounter::Count);
+
+const char* const COUNTER_NAMES[COUNTER_COUNT] = {
+    "dijkstra.searches",
+    "dijkstra.pushes",
+    "dijkstra.stale_pops",
+    "dijkstra.edges_scanned",
+    "dijkstra.settled",
+    "bellman_ford.rounds",
+    "bellman_ford.relaxations",
+    "bellman_ford.cycle_walk",
+    "csv.bytes",
+    "csv.rows"
+};
+
+std::atomic<bool> enabled(false);
+std::atomic<uint64_t> counters[COUNTER_COUNT];
+std::atomic<unsigned> threadsSeen(0);
+std::chrono::steady_clock::time_point epoch;
+std::mutex spanLock;
+std::vector<SampleStats::Span> spans; // guarded by spanLock
+
+void writeArgs(std::ostream& out, const SampleStats::Span& span) {
+    out << "{\"peak_rss_kb\": " << span.peakRssKb;
+    for (size_t i = 0; i < span.args.size(); i++) {
+        out << ", ";
+        SampleJSONValue::writeString(out, span.args[i].first);
+        out << ": " << span.args[i].second;
+    }
+    out << "}";
+}
+
+void writeCounters(std::ostream& out) {
+    out << "{";
+    for (size_t i = 0; i < COUNTER_COUNT; i++) {
+        out << (i == 0 ? "" : ", ") << '"' << COUNTER_NAMES[i] << "\": "
+            << counters[i].load(std::memory_order_relaxed);
+    }
+    out << "}";
+}
+
+} // namespace
+
+void SampleStats::enable() {
+    if (!enabled.load()) {
+        epoch = std::chrono::steady_clock::now();
+        enabled.store(true);
+    }
+}
+
+bool SampleStats::isEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void SampleStats::add(SampleCounter counter, uint64_t amount) {
+    if (enabled.load(std::memory_order_relaxed)) {
+        counters[static_cast<size_t>(counter)].fetch_add(amount, std::memory_order_relaxed);
+    }
+}
+
+uint64_t SampleStats::get(SampleCounter counter) {
+    return counters[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+}
+
+const char* SampleStats::getCounterName(SampleCounter counter) {
+    return COUNTER_NAMES[static_cast<size_t>(counter)];
+}
+
+void SampleStats::addSpan(const Span& span) {
+    if (enabled.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(spanLock);
+        spans.push_back(span);
+    }
+}
+
+uint64_t SampleStats::nowMicros() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - epoch).count());
+}
+
+unsigned SampleStats::getThreadNumber() {
+    static thread_local unsigned number = threadsSeen.fetch_add(1);
+    return number;
+}
+
+long SampleStats::getPeakRssKb() {
+#if defined(_WIN32)
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#if defined(__APPLE__)
+    return static_cast<long>(usage.ru_maxrss / 1024); // bytes there
+#else
+    return static_cast<long>(usage.ru_maxrss);
+#endif
+#endif
+}
+
+void SampleStats::writeJSON(std::ostream& out) {
+    std::lock_guard<std::mutex> lock(spanLock);
+    out << "{\n  \"compiled_in\": " << (SAMPLE_STATS ? "true" : "false") << ",\n  \"counters\": ";
+    writeCounters(out);
+    out << ",\n  \"spans\": [";
+    for (size_t i = 0; i < spans.size(); i++) {
+        const Span& span = spans[i];
+        out << (i == 0 ? "\n" : ",\n") << "    {\"name\": ";
+        SampleJSONValue::writeString(out, span.name);
+        out << ", \"thread\": " << span.thread << ", \"start_us\": " << span.startMicros
+            << ", \"duration_us\": " << span.durationMicros << ", \"args\": ";
+        writeArgs(out, span);
+        out << "}";
+    }
+    out << "\n  ]\n}" << std::endl;
+}
+
+void SampleStats::writeChromeTrace(std::ostream& out) {
+    std::lock_guard<std::mutex> lock(spanLock);
+    uint64_t end = 0;
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    for (size_t i = 0; i < spans.size(); i++) {
+        const Span& span = spans[i];
+        uint64_t spanEnd = span.startMicros + span.durationMicros;
+        end = std::max(end, spanEnd);
+        out << (i == 0 ? "\n" : ",\n") << "  {\"name\": ";
+        SampleJSONValue::writeString(out, span.name);
+        out << ", \"cat\": \"span\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << span.thread
+            << ", \"ts\": " << span.startMicros << ", \"dur\": " << span.durationMicros << ", \"args\": ";
+        writeArgs(out, span);
+        out << "},\n  {\"name\": \"peak_rss_kb\", \"ph\": \"C\", \"pid\": 1, \"ts\": " << spanEnd
+            << ", \"args\": {\"kb\": " << span.peakRssKb << "}}";
+    }
+    out << (spans.empty() ? "\n" : ",\n") << "  {\"name\": \"counters\", \"ph\": \"C\", \"pid\": 1, \"ts\": "
+        << end << ", \"args\": ";
+    writeCounters(out);
+    out << "}\n]}" << std::endl;
+}
+
+SampleStatsSpan::SampleStatsSpan(const char* name) : open(false) {
+    restart(name);
+}
+
+SampleStatsSpan::~SampleStatsSpan() {
+    finish();
+}
+
+void SampleStatsSpan::setArg(const char* name, double value) {
+    if (open) {
+        span.args.push_back(std::make_pair(std::string(name), value));
+    }
+}
+
+double SampleStatsSpan::getSeconds() const {
+    return open ? (SampleStats::nowMicros() - span.startMicros) / 1e6 : 0.0;
+}
+
+void SampleStatsSpan::restart(const char* name) {
+    finish();
+    if (!SampleStats::isEnabled()) {
+        return;
+    }
+    span.name = name;
+    span.thread = SampleStats::getThreadNumber();
+    span.startMicros = SampleStats::nowMicros();
+    span.args.clear();
+    open = true;
+}
+
+void SampleStatsSpan::finish() {
+    if (!open) {
+        return;
+    }
+    open = false;
+    span.durationMicros = SampleStats::nowMicros() - span.startMicros;
+    span.peakRssKb = SampleStats::getPeakRssKb();
+    SampleStats::addSpan(span);
+}
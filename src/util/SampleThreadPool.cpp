@@ -0,0 +1,143 @@
+// SampleThreadPool.cpp
+#include "util/SampleThreadPool.h"
+
+SampleThreadPool::SampleThreadPool(unsigned threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+    if (threadCount == 0) {
+        threadCount = 1; // hardware_concurrency() may not know
+    }
+    this->remaining = 0;
+    this->busyWorkers = 0;
+    this->jobId = 0;
+    this->stopping = false;
+    this->steals = 0;
+    this->postedRunning = 0;
+
+    for (unsigned i = 0; i < threadCount; i++) {
+        ranges.push_back(std::unique_ptr<WorkRange>(new WorkRange()));
+        ranges.back()->next = 0;
+        ranges.back()->end = 0;
+    }
+    for (unsigned i = 0; i < threadCount; i++) {
+        workers.push_back(std::thread(&SampleThreadPool::workerLoop, this, i));
+    }
+}
+
+SampleThreadPool::~SampleThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+bool SampleThreadPool::takeOwn(unsigned worker, size_t& index) {
+    WorkRange& range = *ranges[worker];
+    std::lock_guard<std::mutex> lock(range.lock);
+    if (range.next >= range.end) return false;
+    index = range.next++;
+    return true;
+}
+
+bool SampleThreadPool::steal(unsigned worker, size_t& index) {
+    unsigned count = getThreadCount();
+    for (unsigned offset = 1; offset < count; offset++) {
+        WorkRange& victim = *ranges[(worker + offset) % count];
+        size_t begin, end;
+        {
+            std::lock_guard<std::mutex> lock(victim.lock);
+            if (victim.next >= victim.end) continue;
+            // The back half, rounded down; a single index is taken whole
+            size_t left = victim.end - victim.next;
+            begin = victim.end - (left > 1 ? left / 2 : 1);
+            end = victim.end;
+            victim.end = begin;
+        }
+        steals++;
+        WorkRange& own = *ranges[worker];
+        std::lock_guard<std::mutex> lock(own.lock);
+        own.next = begin + 1;
+        own.end = end;
+        index = begin;
+        return true;
+    }
+    return false;
+}
+
+void SampleThreadPool::workerLoop(unsigned worker) {
+    unsigned long seenJob = 0;
+    while (true) {
+        std::unique_lock<std::mutex> lock(mutex);
+        wakeUp.wait(lock, [&] { return stopping || jobId != seenJob || !posted.empty(); });
+        if (jobId == seenJob) {
+            // No new job: a posted task, or stop once none are left
+            if (posted.empty()) return;
+            std::function<void(unsigned)> next = posted.front();
+            posted.pop_front();
+            postedRunning++;
+            lock.unlock();
+            next(worker);
+            lock.lock();
+            if (--postedRunning == 0 && posted.empty()) {
+                finished.notify_all();
+            }
+            continue;
+        }
+        seenJob = jobId;
+        busyWorkers++;
+        lock.unlock();
+
+        // Own block first, then steal until every block is empty
+        size_t index;
+        while (takeOwn(worker, index) || steal(worker, index)) {
+            task(index, worker);
+            remaining--;
+        }
+
+        lock.lock();
+        if (--busyWorkers == 0) {
+            finished.notify_all();
+        }
+    }
+}
+
+void SampleThreadPool::run(size_t count, const std::function<void(size_t, unsigned)>& task) {
+    if (count == 0) return;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    // A worker that woke late for the previous job may still be scanning it
+    finished.wait(lock, [&] { return busyWorkers == 0; });
+    this->task = task;
+    this->remaining = count;
+    unsigned workerCount = getThreadCount();
+    for (unsigned i = 0; i < workerCount; i++) {
+        WorkRange& range = *ranges[i];
+        std::lock_guard<std::mutex> rangeLock(range.lock);
+        range.next = count * i / workerCount;
+        range.end = count * (i + 1) / workerCount;
+    }
+    jobId++;
+    wakeUp.notify_all();
+
+    // Done once every task finished and no worker is still inside the job
+    finished.wait(lock, [&] { return remaining == 0 && busyWorkers == 0; });
+    this->task = nullptr;
+}
+
+void SampleThreadPool::post(const std::function<void(unsigned)>& task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        posted.push_back(task);
+    }
+    wakeUp.notify_one();
+}
+
+void SampleThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&] { return posted.empty() && postedRunning == 0; });
+}